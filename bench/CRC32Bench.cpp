@@ -0,0 +1,116 @@
+/* CRC32Bench.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/CRC32.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using mpegts::CRC32;
+
+namespace {
+
+	constexpr CRC32::Implementation IMPLEMENTATIONS[] = {
+		CRC32::Implementation::BYTEWISE,
+		CRC32::Implementation::SLICING_BY_8,
+		CRC32::Implementation::PCLMUL,
+		CRC32::Implementation::PMULL
+	};
+
+	/// Section sizes: small PAT, TS packet payload, max PSI and max private section
+	constexpr std::size_t SIZES[] = { 16, 184, 1024, 4096 };
+
+	constexpr std::size_t BYTES_PER_RUN = 256 * 1024 * 1024;
+
+	/// Check every implementation against the bytewise one
+	bool verify(const std::vector<unsigned char> &data) {
+		// MPEG-2 CRC32 check value of "123456789"
+		const unsigned char check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+		bool ok = true;
+		for (const CRC32::Implementation impl : IMPLEMENTATIONS) {
+			if (!CRC32::isSupported(impl)) {
+				continue;
+			}
+			if (CRC32::calculate(impl, check, sizeof(check)) != 0x0376E6E7) {
+				std::printf("%s: check value failed\n", CRC32::getImplementationName(impl));
+				ok = false;
+			}
+			for (std::size_t offset = 0; offset < 16; ++offset) {
+				for (std::size_t len = 0; len + offset <= data.size(); len += (len < 300) ? 1 : 61) {
+					const uint32_t ref = CRC32::calculate(CRC32::Implementation::BYTEWISE, &data[offset], len);
+					if (CRC32::calculate(impl, &data[offset], len) != ref) {
+						std::printf("%s: mismatch at offset %zu length %zu\n",
+							CRC32::getImplementationName(impl), offset, len);
+						ok = false;
+						break;
+					}
+				}
+			}
+		}
+		return ok;
+	}
+
+	void benchmark(const std::vector<unsigned char> &data) {
+		std::printf("%-14s", "Size (bytes)");
+		for (const std::size_t size : SIZES) {
+			std::printf("%12zu", size);
+		}
+		std::printf("   (MB/s)\n");
+		for (const CRC32::Implementation impl : IMPLEMENTATIONS) {
+			if (!CRC32::isSupported(impl)) {
+				continue;
+			}
+			std::printf("%-14s", CRC32::getImplementationName(impl));
+			for (const std::size_t size : SIZES) {
+				const std::size_t runs = BYTES_PER_RUN / size;
+				uint32_t sum = 0;
+				const auto start = std::chrono::steady_clock::now();
+				for (std::size_t i = 0; i < runs; ++i) {
+					sum += CRC32::calculate(impl, &data[i % 64], size);
+				}
+				const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+				const double mbs = (runs * size) / time.count() / (1024.0 * 1024.0);
+				// Use sum, so the loop can not be removed
+				std::printf("%12.0f", (sum == 1) ? mbs + 0.0001 : mbs);
+			}
+			std::printf("\n");
+		}
+	}
+
+}
+
+int main() {
+	std::vector<unsigned char> data(4096 + 64);
+	std::mt19937 rand(0x04C11DB7);
+	for (unsigned char &byte : data) {
+		byte = rand() & 0xFF;
+	}
+	std::printf("CRC32 selected implementation: %s\n",
+		CRC32::getImplementationName(CRC32::getImplementation()));
+	if (!verify(data)) {
+		std::printf("CRC32 verify FAILED\n");
+		return EXIT_FAILURE;
+	}
+	std::printf("CRC32 verify OK\n");
+	benchmark(data);
+	return EXIT_SUCCESS;
+}
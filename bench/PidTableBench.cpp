@@ -0,0 +1,94 @@
+/* PidTableBench.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/PidTable.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using mpegts::PidTable;
+
+namespace {
+
+	/// A transponder with some services, of which one is requested
+	constexpr int OPEN_PIDS[] = { 0, 1, 16, 17, 18, 20, 100, 101, 102, 1010, 1011, 4096, 5000 };
+
+	constexpr std::size_t PACKETS = 64 * 1024;
+	constexpr std::size_t RUNS = 400;
+
+	/// Like the reader thread, the TS packets of a small ring of PacketBuffers
+	/// are read as well, they should stay in L1 together with the PidTable
+	constexpr std::size_t TS_PACKET_SIZE = 188;
+	constexpr std::size_t RING_PACKETS = 7 * 16;
+
+}
+
+int main() {
+	PidTable *table = new PidTable;
+	for (const int pid : OPEN_PIDS) {
+		table->setPID(pid, true);
+		table->setPIDOpened(pid);
+	}
+
+	// Half of the packets are from PIDs that are not requested
+	std::mt19937 rand(8193);
+	std::vector<int> pids(PACKETS);
+	std::vector<uint8_t> ccs(PACKETS);
+	std::vector<uint8_t> cc(PidTable::MAX_PIDS, 0);
+	for (std::size_t i = 0; i < PACKETS; ++i) {
+		int pid;
+		if (rand() & 1) {
+			pid = OPEN_PIDS[rand() % (sizeof(OPEN_PIDS) / sizeof(OPEN_PIDS[0]))];
+		} else {
+			pid = 32 + (rand() % 8000);
+		}
+		pids[i] = pid;
+		ccs[i] = 0x10 | (cc[pid]++ & 0x0F);
+	}
+	std::vector<unsigned char> ts(RING_PACKETS * TS_PACKET_SIZE, 0x47);
+
+	std::printf("sizeof(PidTable): %zu bytes\n", sizeof(PidTable));
+
+	std::size_t opened = 0;
+	unsigned int sum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t run = 0; run < RUNS; ++run) {
+		for (std::size_t i = 0; i < PACKETS; ++i) {
+			const unsigned char *packet = &ts[(i % RING_PACKETS) * TS_PACKET_SIZE];
+			for (std::size_t j = 0; j < TS_PACKET_SIZE; j += 64) {
+				sum += packet[j];
+			}
+			const int pid = pids[i];
+			if (table->isPIDOpened(pid)) {
+				table->addPIDData(pid, ccs[i]);
+				++opened;
+			}
+		}
+	}
+	const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	std::printf("Lookups: %zu  Opened: %zu  CC Errors: %u  (%u)\n",
+		PACKETS * RUNS, opened, table->getTotalCCErrors(), sum & 0x1);
+	std::printf("Time per TS packet: %.2f ns\n", (time.count() * 1e9) / (PACKETS * RUNS));
+	delete table;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,962 @@
+/* StreamBench.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <Stream.h>
+#include <StringConverter.h>
+#include <TransportParamVector.h>
+#include <Unused.h>
+#include <base/Metrics.h>
+#include <input/Device.h>
+#include <mpegts/CRC32.h>
+#include <mpegts/Filter.h>
+#include <mpegts/PacketBuffer.h>
+#include <mpegts/PidTable.h>
+#include <output/StreamClient.h>
+#include <socket/SocketClient.h>
+#include <decrypt/descrambler/Descrambler.h>
+#ifdef LIBDVBCSA
+	#include <StreamManager.h>
+	#include <decrypt/dvbapi/Client.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+// Count every allocation of the complete process, so the allocations in the
+// hot path of the Stream show up while it is streaming
+namespace {
+
+	std::atomic<unsigned long> globalAllocations(0);
+	std::atomic<unsigned long> globalAllocatedBytes(0);
+
+	void *countedAllocation(const std::size_t size) {
+		globalAllocations.fetch_add(1, std::memory_order_relaxed);
+		globalAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		void *ptr = std::malloc(size == 0 ? 1 : size);
+		if (ptr == nullptr) {
+			throw std::bad_alloc();
+		}
+		return ptr;
+	}
+
+}
+
+void *operator new(const std::size_t size) {
+	return countedAllocation(size);
+}
+
+void *operator new[](const std::size_t size) {
+	return countedAllocation(size);
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+namespace {
+
+	using Clock = std::chrono::steady_clock;
+
+	constexpr std::size_t TS_PACKET_SIZE = mpegts::PacketBuffer::TS_PACKET_SIZE;
+
+	/// The synthetic transponder has one service, with the PCR on the video PID
+	constexpr int SDT_PID = 0x0011;
+	constexpr int PMT_PID = 0x0100;
+	constexpr int VIDEO_PID = 0x0101;
+	constexpr int AUDIO_PID = 0x0102;
+
+	/// One group is 40 ms of a service of about 20 Mbit/s, the loop has a
+	/// multiple of 16 groups so the Continuity Counters wrap at its end
+	constexpr std::size_t VIDEO_PACKETS_PER_GROUP = 512;
+	constexpr std::size_t AUDIO_PACKETS_PER_GROUP = 16;
+	constexpr std::size_t GROUPS = 32;
+
+	/// The control word used to descramble, the content does not matter,
+	/// DVB-CSA uses the first 8 bytes
+	constexpr unsigned char CONTROL_WORD[16] = {
+		0x11, 0x22, 0x33, 0x66, 0x44, 0x55, 0x66, 0xFF,
+		0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF
+	};
+
+	using Packet = std::array<unsigned char, TS_PACKET_SIZE>;
+
+	Packet makePacket(const int pid, const bool unitStart) {
+		Packet ts;
+		ts.fill(0xFF);
+		ts[0] = 0x47;
+		ts[1] = (unitStart ? 0x40 : 0x00) | ((pid >> 8) & 0x1F);
+		ts[2] = pid & 0xFF;
+		ts[3] = 0x10;
+		return ts;
+	}
+
+	/// Make a TS packet with one complete PSI section, @p section should
+	/// have the correct section_length and no CRC
+	Packet makePSIPacket(const int pid, const std::vector<unsigned char> &section) {
+		Packet ts = makePacket(pid, true);
+		ts[4] = 0x00;
+		std::memcpy(&ts[5], section.data(), section.size());
+		const uint32_t crc = mpegts::CRC32::calculate(section.data(), section.size());
+		unsigned char *ptr = &ts[5 + section.size()];
+		ptr[0] = (crc >> 24) & 0xFF;
+		ptr[1] = (crc >> 16) & 0xFF;
+		ptr[2] = (crc >>  8) & 0xFF;
+		ptr[3] = crc & 0xFF;
+		return ts;
+	}
+
+	/// Set the section_length of @p section, including the CRC
+	void setSectionLength(std::vector<unsigned char> &section) {
+		const std::size_t length = section.size() - 3 + 4;
+		section[1] = 0xB0 | ((length >> 8) & 0x0F);
+		section[2] = length & 0xFF;
+	}
+
+	std::vector<unsigned char> makePAT() {
+		std::vector<unsigned char> section = {
+			0x00, 0x00, 0x00, 0x00, 0x01, 0xC1, 0x00, 0x00,
+			0x00, 0x00, 0xE0, 0x10,
+			0x00, 0x01, static_cast<unsigned char>(0xE0 | (PMT_PID >> 8)), PMT_PID & 0xFF };
+		setSectionLength(section);
+		return section;
+	}
+
+	std::vector<unsigned char> makePMT() {
+		std::vector<unsigned char> section = {
+			0x02, 0x00, 0x00, 0x00, 0x01, 0xC1, 0x00, 0x00,
+			static_cast<unsigned char>(0xE0 | (VIDEO_PID >> 8)), VIDEO_PID & 0xFF, 0xF0, 0x00,
+			0x1B, static_cast<unsigned char>(0xE0 | (VIDEO_PID >> 8)), VIDEO_PID & 0xFF, 0xF0, 0x00,
+			0x04, static_cast<unsigned char>(0xE0 | (AUDIO_PID >> 8)), AUDIO_PID & 0xFF, 0xF0, 0x00 };
+		setSectionLength(section);
+		return section;
+	}
+
+	std::vector<unsigned char> makeSDT() {
+		const std::string provider("SatPI");
+		const std::string name("StreamBench");
+		std::vector<unsigned char> descriptor = { 0x48, 0x00, 0x01,
+			static_cast<unsigned char>(provider.size()) };
+		descriptor.insert(descriptor.end(), provider.begin(), provider.end());
+		descriptor.push_back(name.size());
+		descriptor.insert(descriptor.end(), name.begin(), name.end());
+		descriptor[1] = descriptor.size() - 2;
+		std::vector<unsigned char> section = {
+			0x42, 0x00, 0x00, 0x00, 0x01, 0xC1, 0x00, 0x00,
+			0x00, 0x01, 0xFF,
+			0x00, 0x01, 0xFC, 0x80, static_cast<unsigned char>(descriptor.size()) };
+		section.insert(section.end(), descriptor.begin(), descriptor.end());
+		setSectionLength(section);
+		return section;
+	}
+
+	/// Generate a looped transponder with PAT, PMT, SDT and a service with
+	/// PCR, video and audio. The payload is random, so it does not compress
+	/// in any cache, and optional marked as scrambled
+	std::vector<unsigned char> generateTransponder(const bool scrambled) {
+		std::vector<Packet> packets;
+		std::array<uint8_t, mpegts::PidTable::MAX_PIDS> cc{};
+		std::mt19937 rand(1316);
+		const auto add = [&](Packet ts) {
+			const int pid = ((ts[1] & 0x1F) << 8) | ts[2];
+			ts[3] |= cc[pid]++ & 0x0F;
+			packets.push_back(ts);
+		};
+		const auto addPayload = [&](const int pid, const bool unitStart, const uint64_t pcr) {
+			Packet ts = makePacket(pid, unitStart);
+			std::size_t begin = 4;
+			if (unitStart && pid == VIDEO_PID) {
+				// Adaptation field with the PCR, the extension is left 0
+				ts[3] = 0x30;
+				ts[4] = 7;
+				ts[5] = 0x10;
+				ts[6] = (pcr >> 25) & 0xFF;
+				ts[7] = (pcr >> 17) & 0xFF;
+				ts[8] = (pcr >>  9) & 0xFF;
+				ts[9] = (pcr >>  1) & 0xFF;
+				ts[10] = ((pcr & 0x01) << 7) | 0x7E;
+				ts[11] = 0x00;
+				begin = 12;
+			}
+			for (std::size_t i = begin; i < TS_PACKET_SIZE; ++i) {
+				ts[i] = rand() & 0xFF;
+			}
+			if (scrambled) {
+				ts[3] |= 0x80;
+			}
+			add(ts);
+		};
+		const Packet pat = makePSIPacket(0, makePAT());
+		const Packet pmt = makePSIPacket(PMT_PID, makePMT());
+		const Packet sdt = makePSIPacket(SDT_PID, makeSDT());
+		for (std::size_t group = 0; group < GROUPS; ++group) {
+			add(pat);
+			add(pmt);
+			add(sdt);
+			// 40 ms at 90 kHz
+			const uint64_t pcr = group * 3600;
+			for (std::size_t i = 0; i < VIDEO_PACKETS_PER_GROUP; ++i) {
+				addPayload(VIDEO_PID, i == 0, pcr);
+				if ((i % (VIDEO_PACKETS_PER_GROUP / AUDIO_PACKETS_PER_GROUP)) == 0) {
+					addPayload(AUDIO_PID, i == 0, pcr);
+				}
+			}
+		}
+		std::vector<unsigned char> data(packets.size() * TS_PACKET_SIZE);
+		for (std::size_t i = 0; i < packets.size(); ++i) {
+			std::memcpy(&data[i * TS_PACKET_SIZE], packets[i].data(), TS_PACKET_SIZE);
+		}
+		return data;
+	}
+
+	/// Read the complete TS file @p path, it should start with a SYNC byte
+	bool readTransponder(const std::string &path, std::vector<unsigned char> &data) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			std::fprintf(stderr, "Unable to open %s\n", path.c_str());
+			return false;
+		}
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		data.resize(data.size() - (data.size() % TS_PACKET_SIZE));
+		if (data.empty() || data[0] != 0x47) {
+			std::fprintf(stderr, "%s is not a TS file starting with a SYNC byte\n", path.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	/// The class @c BenchDevice replays a TS from memory in a loop, without
+	/// any throttling, so the Stream reads it as fast as it can. Like the
+	/// demux of a frontend only the opened PIDs are delivered
+	class BenchDevice :
+		public input::Device {
+		public:
+
+			/// @param key specifies the key to descramble with, or nullptr
+			/// @param batchSize specifies the amount of payloads descrambled together
+			BenchDevice(std::vector<unsigned char> &&data,
+					decrypt::descrambler::SpKey key, const std::size_t batchSize) :
+				Device(0),
+				_data(std::move(data)),
+				_offset(0),
+				_key(key),
+				_batch(batchSize + 1),
+				_allPIDs(false),
+				_packets(0),
+				_deliveredPackets(0),
+				_copyTime(0),
+				_filterTime(0),
+				_descrambleTime(0) {
+				for (std::atomic_bool &pid : _dmxPIDs) {
+					pid = false;
+				}
+			}
+
+			virtual ~BenchDevice() = default;
+
+		private:
+
+			virtual void doAddToXML(std::string &xml) const final {
+				ADD_XML_ELEMENT(xml, "frontendname", "StreamBench");
+			}
+
+			virtual void doFromXML(const std::string &UNUSED(xml)) final {}
+
+		public:
+
+			virtual void addDeliverySystemCount(
+					std::size_t &dvbs2,
+					std::size_t &UNUSED(dvbt),
+					std::size_t &UNUSED(dvbt2),
+					std::size_t &UNUSED(dvbc),
+					std::size_t &UNUSED(dvbc2)) final {
+				++dvbs2;
+			}
+
+			virtual bool isDataAvailable() final {
+				return true;
+			}
+
+			virtual bool readTSPackets(mpegts::PacketBuffer &buffer) final {
+				return readTSPackets(&buffer, 1) == 1;
+			}
+
+			virtual std::size_t readTSPackets(mpegts::PacketBuffer *buffers, const std::size_t count) final {
+				const Clock::time_point copyBegin = Clock::now();
+				// Never scan more then one loop, the requested PIDs might not be there
+				const std::size_t loopPackets = _data.size() / TS_PACKET_SIZE;
+				std::size_t scanned = 0;
+				std::size_t delivered = 0;
+				std::size_t filled = 0;
+				for (; filled < count && scanned < loopPackets; ++filled) {
+					mpegts::PacketBuffer &buffer = buffers[filled];
+					while (!buffer.full() && scanned < loopPackets) {
+						const unsigned char *ts = &_data[_offset];
+						const int pid = ((ts[1] & 0x1F) << 8) | ts[2];
+						if (_allPIDs || _dmxPIDs[pid].load(std::memory_order_relaxed)) {
+							std::memcpy(buffer.getWriteBufferPtr(), ts, TS_PACKET_SIZE);
+							buffer.addAmountOfBytesWritten(TS_PACKET_SIZE);
+							++delivered;
+						}
+						_offset += TS_PACKET_SIZE;
+						if (_offset == _data.size()) {
+							_offset = 0;
+						}
+						++scanned;
+					}
+					if (!buffer.full()) {
+						break;
+					}
+				}
+				const Clock::time_point filterBegin = Clock::now();
+				getFilter().filterData(_feID, buffers, filled, false);
+				const Clock::time_point descrambleBegin = Clock::now();
+				if (_key) {
+					descramble(buffers, filled);
+				}
+				const Clock::time_point end = Clock::now();
+
+				_packets.fetch_add(scanned, std::memory_order_relaxed);
+				_deliveredPackets.fetch_add(delivered, std::memory_order_relaxed);
+				addTime(_copyTime, filterBegin - copyBegin);
+				addTime(_filterTime, descrambleBegin - filterBegin);
+				addTime(_descrambleTime, end - descrambleBegin);
+				return filled;
+			}
+
+			virtual bool capableOf(const input::InputSystem UNUSED(system)) const final {
+				return true;
+			}
+
+			virtual bool capableToShare(const TransportParamVector &UNUSED(params)) const final {
+				return true;
+			}
+
+			virtual bool capableToTransform(const TransportParamVector &UNUSED(params)) const final {
+				return false;
+			}
+
+			virtual bool isLockedByOtherProcess() const final {
+				return false;
+			}
+
+			virtual bool monitorSignal(const bool UNUSED(showStatus)) final {
+				return true;
+			}
+
+			virtual bool hasDeviceFrequencyChanged() const final {
+				return false;
+			}
+
+			virtual void parseStreamString(const TransportParamVector &params) final {
+				const std::string pidsList = params.getParameter("pids");
+				if (!pidsList.empty()) {
+					_filter.parsePIDString(_feID, pidsList, true);
+				}
+				const std::string addpidsList = params.getParameter("addpids");
+				if (!addpidsList.empty()) {
+					_filter.parsePIDString(_feID, addpidsList, true);
+				}
+				const std::string delpidsList = params.getParameter("delpids");
+				if (!delpidsList.empty()) {
+					_filter.parsePIDString(_feID, delpidsList, false);
+				}
+			}
+
+			virtual bool update() final {
+				updatePIDFilters();
+				return true;
+			}
+
+			virtual bool teardown() final {
+				closeActivePIDFilters();
+				return true;
+			}
+
+			virtual std::string attributeDescribeString() const final {
+				return StringConverter::stringFormat("ver=1.5;tuner=@#1,240,1,15;uri=bench", _feID);
+			}
+
+			virtual mpegts::Filter &getFilter() final {
+				return _filter;
+			}
+
+			virtual void updatePIDFilters() final {
+				_filter.updatePIDFilters(_feID,
+					[&](const int pid) {
+						return setDMXPID(pid, true);
+					},
+					[&](const int pid) {
+						return setDMXPID(pid, false);
+					});
+			}
+
+			virtual void closeActivePIDFilters() final {
+				_filter.closeActivePIDFilters(_feID,
+					[&](const int pid) {
+						return setDMXPID(pid, false);
+					});
+			}
+
+			/// Get the amount of TS packets that went through the demux
+			unsigned long getPackets() const {
+				return _packets.load(std::memory_order_relaxed);
+			}
+
+			/// Get the amount of TS packets that were delivered by the demux
+			unsigned long getDeliveredPackets() const {
+				return _deliveredPackets.load(std::memory_order_relaxed);
+			}
+
+			/// Get the time in ns spend in the demux, filter and descrambler
+			void getTimes(unsigned long &copy, unsigned long &filter, unsigned long &descramble) const {
+				copy = _copyTime.load(std::memory_order_relaxed);
+				filter = _filterTime.load(std::memory_order_relaxed);
+				descramble = _descrambleTime.load(std::memory_order_relaxed);
+			}
+
+		private:
+
+			static void addTime(std::atomic<unsigned long> &total, const Clock::duration time) {
+				total.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+					std::memory_order_relaxed);
+			}
+
+			bool setDMXPID(const int pid, const bool open) {
+				if (pid == mpegts::PidTable::ALL_PIDS) {
+					_allPIDs = open;
+				} else {
+					_dmxPIDs[pid].store(open, std::memory_order_relaxed);
+				}
+				return true;
+			}
+
+			/// Descramble the scrambled payloads in batches, like the dvbapi
+			/// client does, all with the same control word
+			void descramble(mpegts::PacketBuffer *buffers, const std::size_t count) {
+				const std::size_t batchSize = _batch.size() - 1;
+				std::size_t batchCount = 0;
+				const auto decryptBatch = [&]() {
+					_key->descramble(_batch.data(), batchCount);
+					batchCount = 0;
+				};
+				for (std::size_t i = 0; i < count; ++i) {
+					const std::size_t size = buffers[i].getNumberOfCompletedPackets();
+					for (std::size_t j = 0; j < size; ++j) {
+						unsigned char *ts = buffers[i].getTSPacketPtr(j);
+						if ((ts[3] & 0x80) != 0x80) {
+							continue;
+						}
+						const std::size_t skip = (ts[3] & 0x20) ? (5 + ts[4]) : 4;
+						if (skip < TS_PACKET_SIZE) {
+							_batch[batchCount].data = ts + skip;
+							_batch[batchCount].len = TS_PACKET_SIZE - skip;
+							if (++batchCount == batchSize) {
+								decryptBatch();
+							}
+						}
+						// The scramble flags are cleared after the last batch
+						ts[3] &= 0x3F;
+					}
+				}
+				if (batchCount > 0) {
+					decryptBatch();
+				}
+			}
+
+			const std::vector<unsigned char> _data;
+			std::size_t _offset;
+			const decrypt::descrambler::SpKey _key;
+			std::vector<decrypt::descrambler::Payload> _batch;
+			mpegts::Filter _filter;
+			std::array<std::atomic_bool, mpegts::PidTable::ALL_PIDS> _dmxPIDs;
+			std::atomic_bool _allPIDs;
+			std::atomic<unsigned long> _packets;
+			std::atomic<unsigned long> _deliveredPackets;
+			std::atomic<unsigned long> _copyTime;
+			std::atomic<unsigned long> _filterTime;
+			std::atomic<unsigned long> _descrambleTime;
+	};
+
+	/// The class @c BenchSocketClient is the connection a request came in on,
+	/// normally it gets the file descriptor from accepting it
+	class BenchSocketClient :
+		public SocketClient {
+		public:
+
+			using SocketAttr::setFD;
+	};
+
+	/// The class @c Sink receives what a StreamClient sends over loopback
+	class Sink {
+		public:
+
+			Sink(const int fd, const bool datagram, const std::string &name) :
+				_fd(fd),
+				_datagram(datagram),
+				_name(name),
+				_running(true),
+				_bytes(0),
+				_thread(&Sink::run, this) {}
+
+			~Sink() {
+				_running = false;
+				_thread.join();
+				::close(_fd);
+			}
+
+			unsigned long getBytes() const {
+				return _bytes.load(std::memory_order_relaxed);
+			}
+
+		private:
+
+			void run() {
+				pthread_setname_np(pthread_self(), _name.c_str());
+				constexpr std::size_t DATAGRAMS = 64;
+				std::vector<unsigned char> buffer(DATAGRAMS * mpegts::PacketBuffer::MTU);
+				std::array<iovec, DATAGRAMS> iov;
+				std::array<mmsghdr, DATAGRAMS> msgs{};
+				for (std::size_t i = 0; i < DATAGRAMS; ++i) {
+					iov[i].iov_base = &buffer[i * mpegts::PacketBuffer::MTU];
+					iov[i].iov_len = mpegts::PacketBuffer::MTU;
+					msgs[i].msg_hdr.msg_iov = &iov[i];
+					msgs[i].msg_hdr.msg_iovlen = 1;
+				}
+				pollfd pfd;
+				pfd.fd = _fd;
+				pfd.events = POLLIN;
+				while (_running) {
+					if (::poll(&pfd, 1, 100) <= 0) {
+						continue;
+					}
+					if (_datagram) {
+						const int count = ::recvmmsg(_fd, msgs.data(), DATAGRAMS, MSG_DONTWAIT, nullptr);
+						for (int i = 0; i < count; ++i) {
+							_bytes.fetch_add(msgs[i].msg_len, std::memory_order_relaxed);
+						}
+					} else {
+						const ssize_t size = ::recv(_fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+						if (size == 0) {
+							break;
+						} else if (size > 0) {
+							_bytes.fetch_add(size, std::memory_order_relaxed);
+						}
+					}
+				}
+			}
+
+			const int _fd;
+			const bool _datagram;
+			const std::string _name;
+			std::atomic_bool _running;
+			std::atomic<unsigned long> _bytes;
+			std::thread _thread;
+	};
+
+	int makeLoopbackSocket(const int type, const int port) {
+		const int fd = ::socket(AF_INET, type, 0);
+		if (fd == -1) {
+			return -1;
+		}
+		const int bufferSize = 8 * 1024 * 1024;
+		::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons(port);
+		if (type == SOCK_DGRAM && ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+			::close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	int getLocalPort(const int fd) {
+		sockaddr_in addr{};
+		socklen_t len = sizeof(addr);
+		::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+		return ntohs(addr.sin_port);
+	}
+
+	/// Make a connected loopback TCP pair, @p server is the side the
+	/// StreamClient writes to
+	bool makeLoopbackConnection(int &server, int &client) {
+		const int listenFD = ::socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t len = sizeof(addr);
+		if (listenFD == -1 ||
+				::bind(listenFD, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 ||
+				::listen(listenFD, 1) == -1 ||
+				::getsockname(listenFD, reinterpret_cast<sockaddr *>(&addr), &len) == -1) {
+			return false;
+		}
+		client = makeLoopbackSocket(SOCK_STREAM, 0);
+		if (client == -1 || ::connect(client, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+			::close(listenFD);
+			return false;
+		}
+		server = ::accept(listenFD, nullptr, nullptr);
+		::close(listenFD);
+		return server != -1;
+	}
+
+	/// Get the CPU time in clock ticks of all the threads, by thread name
+	std::map<std::string, unsigned long> getThreadCPUTimes() {
+		std::map<std::string, unsigned long> times;
+		DIR *dir = ::opendir("/proc/self/task");
+		if (dir == nullptr) {
+			return times;
+		}
+		while (const dirent *entry = ::readdir(dir)) {
+			if (entry->d_name[0] == '.') {
+				continue;
+			}
+			std::ifstream file(std::string("/proc/self/task/") + entry->d_name + "/stat");
+			std::string line;
+			std::getline(file, line);
+			// The name is between braces and may have spaces
+			const std::string::size_type begin = line.find('(');
+			const std::string::size_type end = line.rfind(')');
+			if (begin == std::string::npos || end == std::string::npos) {
+				continue;
+			}
+			std::istringstream fields(line.substr(end + 2));
+			std::string field;
+			unsigned long ticks = 0;
+			// After the name: state is field 3, utime and stime are field 14 and 15
+			for (int i = 3; i <= 15 && (fields >> field); ++i) {
+				if (i >= 14) {
+					ticks += std::stoul(field);
+				}
+			}
+			times[line.substr(begin + 1, end - begin - 1)] += ticks;
+		}
+		::closedir(dir);
+		return times;
+	}
+
+	/// The state of the process at the begin and end of the measurement
+	struct Snapshot {
+		Clock::time_point time;
+		unsigned long packets;
+		unsigned long deliveredPackets;
+		unsigned long sinkBytes;
+		unsigned long copyTime;
+		unsigned long filterTime;
+		unsigned long descrambleTime;
+		unsigned long allocations;
+		unsigned long allocatedBytes;
+		std::map<std::string, unsigned long> threadTicks;
+	};
+
+	Snapshot takeSnapshot(const BenchDevice &device, const std::vector<std::unique_ptr<Sink>> &sinks) {
+		Snapshot snapshot;
+		snapshot.time = Clock::now();
+		snapshot.packets = device.getPackets();
+		snapshot.deliveredPackets = device.getDeliveredPackets();
+		snapshot.sinkBytes = 0;
+		for (const std::unique_ptr<Sink> &sink : sinks) {
+			snapshot.sinkBytes += sink->getBytes();
+		}
+		device.getTimes(snapshot.copyTime, snapshot.filterTime, snapshot.descrambleTime);
+		snapshot.threadTicks = getThreadCPUTimes();
+		snapshot.allocations = globalAllocations.load(std::memory_order_relaxed);
+		snapshot.allocatedBytes = globalAllocatedBytes.load(std::memory_order_relaxed);
+		return snapshot;
+	}
+
+	/// Make the XML of the Stream settings in @p list, like 'ringSize=500,udpGSO=true'
+	std::string makeSettingsXML(const std::string &list) {
+		std::string xml;
+		for (const std::string &setting : StringConverter::split(list, ",")) {
+			const StringVector nameValue = StringConverter::split(setting, "=");
+			if (nameValue.size() == 2) {
+				xml += StringConverter::stringFormat("<@#1><value>@#2</value></@#1>",
+					nameValue[0], nameValue[1]);
+			}
+		}
+		return xml;
+	}
+
+	/// Get the value of the metric that starts with @p name from @p text
+	std::string getMetricValue(const std::string &text, const std::string &name) {
+		const std::string::size_type begin = text.find("\n" + name);
+		if (begin == std::string::npos) {
+			return "-";
+		}
+		const std::string::size_type end = text.find('\n', begin + 1);
+		const std::string line = text.substr(begin + 1, end - begin - 1);
+		return line.substr(line.rfind(' ') + 1);
+	}
+
+	void printUsage(const char *name) {
+		std::printf("Usage: %s [options]\n", name);
+		std::printf("  -f file  Replay this TS file, looped from memory, instead of a synthetic transponder\n");
+		std::printf("  -o type  Output to 'http' (default) or 'rtp' loopback sinks\n");
+		std::printf("  -c num   Amount of StreamClients sharing the Stream (default 1)\n");
+		std::printf("  -p pids  The PIDs to request (default all)\n");
+		std::printf("  -w sec   Warm up time (default 1)\n");
+		std::printf("  -t sec   Measure time (default 5)\n");
+		std::printf("  -s list  Stream settings like the web interface, for example ringSize=500,sendBatch=32\n");
+		std::printf("  -k algo  Descramble the payload with 'csa' (build with LIBDVBCSA=yes) or 'cissa'\n");
+		std::printf("  -m       Print the metrics of the Stream at the end\n");
+	}
+
+}
+
+int main(int argc, char *argv[]) {
+	std::string filePath;
+	std::string output("http");
+	std::string pids("all");
+	std::string settings;
+	int clients = 1;
+	int warmUp = 1;
+	int measure = 5;
+	std::string algorithm;
+	bool printMetrics = false;
+	int opt;
+	while ((opt = ::getopt(argc, argv, "f:o:c:p:s:w:t:k:mh")) != -1) {
+		switch (opt) {
+			case 'f':
+				filePath = optarg;
+				break;
+			case 'o':
+				output = optarg;
+				break;
+			case 'c':
+				clients = std::max(1, std::atoi(optarg));
+				break;
+			case 'p':
+				pids = optarg;
+				break;
+			case 's':
+				settings = optarg;
+				break;
+			case 'w':
+				warmUp = std::max(0, std::atoi(optarg));
+				break;
+			case 't':
+				measure = std::max(1, std::atoi(optarg));
+				break;
+			case 'k':
+				algorithm = optarg;
+				break;
+			case 'm':
+				printMetrics = true;
+				break;
+			default:
+				printUsage(argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if (output != "http" && output != "rtp") {
+		printUsage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	const bool descramble = !algorithm.empty();
+	decrypt::descrambler::SpDescrambler descrambler;
+	decrypt::descrambler::SpKey key;
+	if (descramble) {
+		if (algorithm != "csa" && algorithm != "cissa") {
+			printUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		descrambler = decrypt::descrambler::Descrambler::makeSP((algorithm == "csa") ?
+			decrypt::descrambler::Descrambler::Algorithm::DVBCSA :
+			decrypt::descrambler::Descrambler::Algorithm::CISSA);
+		if (!descrambler) {
+			std::fprintf(stderr, "Descrambling with DVB-CSA needs a build with LIBDVBCSA=yes\n");
+			return EXIT_FAILURE;
+		}
+		key = descrambler->makeKey(CONTROL_WORD, descrambler->getKeyLength(), nullptr, -1);
+	}
+
+	std::vector<unsigned char> data;
+	if (filePath.empty()) {
+		data = generateTransponder(descramble);
+	} else if (!readTransponder(filePath, data)) {
+		return EXIT_FAILURE;
+	}
+	const std::size_t loopSize = data.size();
+	const std::shared_ptr<BenchDevice> device = std::make_shared<BenchDevice>(std::move(data), key,
+		descramble ? descrambler->getBatchSize() : 0);
+
+#ifdef LIBDVBCSA
+	// Not connected to OSCam, so the dvbapi client leaves the TS as it is
+	StreamManager streamManager;
+	const SpStream stream = Stream::makeSP(device,
+		std::make_shared<decrypt::dvbapi::Client>(streamManager));
+#else
+	const SpStream stream = Stream::makeSP(device, nullptr);
+#endif
+	if (!settings.empty()) {
+		stream->fromXML(makeSettingsXML(settings));
+	}
+
+	// Setup the StreamClients like the HTTP/RTSP server would do
+	std::vector<std::unique_ptr<BenchSocketClient>> socketClients;
+	std::vector<output::SpStreamClient> streamClients;
+	std::vector<std::unique_ptr<Sink>> sinks;
+	for (int i = 1; i <= clients; ++i) {
+		std::unique_ptr<BenchSocketClient> socketClient(new BenchSocketClient);
+		socketClient->setIPAddressOfSocket("127.0.0.1");
+		const std::string request = StringConverter::stringFormat("?msys=dvbs2&freq=11362&pol=h&sr=22000&pids=@#1", pids);
+		const std::string sinkName = StringConverter::stringFormat("Sink@#1", i);
+		if (output == "http") {
+			int server;
+			int client;
+			if (!makeLoopbackConnection(server, client)) {
+				std::fprintf(stderr, "Unable to make a loopback TCP connection\n");
+				return EXIT_FAILURE;
+			}
+			socketClient->setFD(server);
+			socketClient->addMessage(StringConverter::stringFormat(
+				"GET /@#1 HTTP/1.1\r\nUser-Agent: StreamBench\r\n\r\n", request));
+			sinks.emplace_back(new Sink(client, false, sinkName));
+		} else {
+			const int rtp = makeLoopbackSocket(SOCK_DGRAM, 0);
+			const int rtcp = makeLoopbackSocket(SOCK_DGRAM, 0);
+			if (rtp == -1 || rtcp == -1) {
+				std::fprintf(stderr, "Unable to make a loopback UDP socket\n");
+				return EXIT_FAILURE;
+			}
+			socketClient->addMessage(StringConverter::stringFormat(
+				"SETUP rtsp://127.0.0.1/@#1 RTSP/1.0\r\nCSeq: 1\r\nUser-Agent: StreamBench\r\n" \
+				"Transport: RTP/AVP;unicast;client_port=@#2-@#3\r\n\r\n",
+				request, getLocalPort(rtp), getLocalPort(rtcp)));
+			sinks.emplace_back(new Sink(rtp, true, sinkName));
+			// Nobody reads RTCP, the kernel just drops it when it is full
+			sinks.emplace_back(new Sink(rtcp, true, "RTCP"));
+		}
+		const std::string sessionID = StringConverter::stringFormat("@#1", 1000 + i);
+		const output::SpStreamClient streamClient = stream->findStreamClientFor(*socketClient, true, sessionID);
+		if (!streamClient) {
+			std::fprintf(stderr, "Stream did not accept StreamClient %d\n", i);
+			return EXIT_FAILURE;
+		}
+		streamClient->setSessionID(sessionID);
+		stream->processStreamingRequest(*socketClient, streamClient);
+		stream->update(streamClient);
+		socketClients.push_back(std::move(socketClient));
+		streamClients.push_back(streamClient);
+	}
+
+	std::printf("Source     : %s, %zu TS packets in the loop\n",
+		filePath.empty() ? "synthetic transponder" : filePath.c_str(), loopSize / TS_PACKET_SIZE);
+	std::printf("Output     : %d x %s with pids=%s%s%s\n", clients, output.c_str(), pids.c_str(),
+		descramble ? ", descrambled with " : "", descramble ? descrambler->getName().c_str() : "");
+
+	std::this_thread::sleep_for(std::chrono::seconds(warmUp));
+	const Snapshot begin = takeSnapshot(*device, sinks);
+	std::this_thread::sleep_for(std::chrono::seconds(measure));
+	const Snapshot end = takeSnapshot(*device, sinks);
+
+	const double seconds = std::chrono::duration<double>(end.time - begin.time).count();
+	const double packets = end.packets - begin.packets;
+	const double delivered = end.deliveredPackets - begin.deliveredPackets;
+	const double sinkBytes = end.sinkBytes - begin.sinkBytes;
+	std::printf("Input      : %9.1f Mbit/s  %12.0f packets/s\n",
+		(packets * TS_PACKET_SIZE * 8) / (seconds * 1e6), packets / seconds);
+	std::printf("Demux      : %9.1f Mbit/s  %12.0f packets/s\n",
+		(delivered * TS_PACKET_SIZE * 8) / (seconds * 1e6), delivered / seconds);
+	std::printf("Sinks      : %9.1f Mbit/s  (all StreamClients together, with RTP headers)\n",
+		(sinkBytes * 8) / (seconds * 1e6));
+
+	// The time spend in the device is measured by the Reader thread itself
+	const double ns = seconds * 1e9;
+	std::printf("Reader     : demux %.1f %%  filter %.1f %%  descramble %.1f %%  (of wall time)\n",
+		100.0 * (end.copyTime - begin.copyTime) / ns,
+		100.0 * (end.filterTime - begin.filterTime) / ns,
+		100.0 * (end.descrambleTime - begin.descrambleTime) / ns);
+
+	const double ticks = ::sysconf(_SC_CLK_TCK) * seconds;
+	std::printf("Thread CPU :");
+	for (const auto &[name, endTicks] : end.threadTicks) {
+		const auto it = begin.threadTicks.find(name);
+		const unsigned long used = endTicks - ((it == begin.threadTicks.end()) ? 0 : it->second);
+		if (used > 0) {
+			std::printf("  %s %.1f %%", name.c_str(), (100.0 * used) / ticks);
+		}
+	}
+	std::printf("\n");
+	rusage usage;
+	::getrusage(RUSAGE_SELF, &usage);
+	std::printf("Process    : user %ld.%03ld s  system %ld.%03ld s  (since start)\n",
+		usage.ru_utime.tv_sec, usage.ru_utime.tv_usec / 1000,
+		usage.ru_stime.tv_sec, usage.ru_stime.tv_usec / 1000);
+
+	const double allocations = end.allocations - begin.allocations;
+	std::printf("Allocations: %.0f (%.0f bytes), %.3f per 1000 TS packets\n",
+		allocations, static_cast<double>(end.allocatedBytes - begin.allocatedBytes),
+		(packets > 0) ? (allocations * 1000) / packets : 0.0);
+
+	base::Metrics metrics;
+	stream->addToMetrics(metrics);
+	const std::string metricsText = metrics.toText();
+	std::printf("Ring       : %s slots, %s max occupancy, %s overruns (since start)\n",
+		getMetricValue(metricsText, "satpi_stream_ring_slots").c_str(),
+		getMetricValue(metricsText, "satpi_stream_ring_max_occupancy").c_str(),
+		getMetricValue(metricsText, "satpi_stream_ring_overruns_total").c_str());
+	if (printMetrics) {
+		std::printf("\n%s", metricsText.c_str());
+	}
+
+	for (const output::SpStreamClient &streamClient : streamClients) {
+		stream->teardown(streamClient);
+	}
+	return EXIT_SUCCESS;
+}
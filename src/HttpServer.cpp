@@ -144,6 +144,10 @@ bool HttpServer::methodGet(SocketClient &client, bool headOnly) {
 				docType = Log::makeJSON();
 				docTypeSize = docType.size();
 				getHtmlBodyWithContent(htmlBody, HTML_OK, file, CONTENT_TYPE_JSON, docTypeSize, 0);
+			} else if (file == "metrics") {
+				docType = _streamManager.getMetrics();
+				docTypeSize = docType.size();
+				getHtmlBodyWithContent(htmlBody, HTML_OK, file, CONTENT_TYPE_METRICS, docTypeSize, 0);
 			} else if (file == "STOP") {
 				exitRequest = true;
 				getHtmlBodyWithContent(htmlBody, HTML_NO_RESPONSE, "", CONTENT_TYPE_HTML, 0, 0);
@@ -67,6 +67,7 @@ const std::string HttpcServer::HTML_SERVICE_UNAVAILABLE = "503 Service Unavailab
 
 //const std::string HttpcServer::CONTENT_TYPE_XML         = "application/xml; charset=UTF-8";
 const std::string HttpcServer::CONTENT_TYPE_JSON        = "application/json; charset=UTF-8";
+const std::string HttpcServer::CONTENT_TYPE_METRICS     = "text/plain; version=0.0.4; charset=UTF-8";
 const std::string HttpcServer::CONTENT_TYPE_JS          = "application/javascript; charset=UTF-8";
 const std::string HttpcServer::CONTENT_TYPE_XML         = "text/xml; charset=UTF-8";
 const std::string HttpcServer::CONTENT_TYPE_HTML        = "text/html; charset=UTF-8";
@@ -165,6 +166,7 @@ void HttpcServer::processStreamingRequest(SocketClient &client) {
 
 	const std::string method = client.getMethod();
 	std::string httpcReply;
+	output::SpStreamClient replyClient;
 	if (sessionID.empty() && method == "OPTIONS") {
 		static const char* RTSP_OPTIONS_OK =
 			"RTSP/1.0 200 OK\r\n" \
@@ -179,6 +181,7 @@ void HttpcServer::processStreamingRequest(SocketClient &client) {
 		const auto [stream, streamClient] = _streamManager.findStreamAndClientFor(client);
 		if (stream != nullptr) {
 			stream->processStreamingRequest(client, streamClient);
+			replyClient = streamClient;
 
 			// Check the Method
 			if (method == "GET") {
@@ -227,7 +230,9 @@ void HttpcServer::processStreamingRequest(SocketClient &client) {
 	}
 	const unsigned long time = sw.getIntervalMS();
 	SI_LOG_DEBUG("Send reply in @#1 ms\r\n@#2", time, httpcReply);
-	if (!client.sendData(httpcReply.data(), httpcReply.size(), MSG_NOSIGNAL)) {
+	const bool send = (replyClient != nullptr) ? replyClient->sendReply(client, httpcReply) :
+		client.sendData(httpcReply.data(), httpcReply.size(), MSG_NOSIGNAL);
+	if (!send) {
 		SI_LOG_ERROR("Send Streaming reply failed");
 	}
 }
@@ -54,6 +54,7 @@ class HttpcServer :
 		static const std::string CONTENT_TYPE_ICO;
 		static const std::string CONTENT_TYPE_JS;
 		static const std::string CONTENT_TYPE_JSON;
+		static const std::string CONTENT_TYPE_METRICS;
 		static const std::string CONTENT_TYPE_PNG;
 		static const std::string CONTENT_TYPE_XML;
 		static const std::string CONTENT_TYPE_TEXT;
@@ -21,6 +21,7 @@
 
 #include <Log.h>
 #include <Utils.h>
+#include <base/ThreadPlacement.h>
 #include <StringConverter.h>
 
 #include <chrono>
@@ -43,7 +44,7 @@ SatPI::SatPI(const SatPI::Params &params) :
 	//
 	_streamManager.enumerateDevices(_interface.getIPAddress(),
 		_properties.getAppDataPath(), params.dvbPath, params.numberOfChildPIPE,
-		params.enableUnsecureFrontends);
+		params.numberOfSimulatedFrontends, params.enableUnsecureFrontends);
 	//
 	std::string xml;
 	if (restoreXML(xml)) {
@@ -51,6 +52,7 @@ SatPI::SatPI(const SatPI::Params &params) :
 	} else {
 		saveXML();
 	}
+	applyThreadPlacement();
 
 	_httpServer.initialize(_properties.getHttpPort(), true);
 	_rtspServer.initialize(_properties.getRtspPort(), true);
@@ -91,6 +93,7 @@ void SatPI::doFromXML(const std::string &xml) {
 	if (findXMLElement(xml, "ssdp", element)) {
 		_ssdpServer.fromXML(element);
 	}
+	applyThreadPlacement();
 	saveXML();
 }
 
@@ -111,3 +114,10 @@ bool SatPI::saveXML() const {
 bool SatPI::exitApplication() const {
 	return _properties.exitApplication();
 }
+
+void SatPI::applyThreadPlacement() {
+	const base::SpThreadPlacement placement = _streamManager.getThreadPlacement();
+	placement->placeHousekeepingThread(_httpServer);
+	placement->placeHousekeepingThread(_rtspServer);
+	placement->placeHousekeepingThread(_ssdpServer);
+}
@@ -49,6 +49,7 @@ class SatPI :
 			unsigned int httpPort = 0;
 			unsigned int rtspPort = 0;
 			int numberOfChildPIPE = 0;
+			int numberOfSimulatedFrontends = 0;
 			bool enableUnsecureFrontends = false;
 			int ssdpTTL = 1;
 		};
@@ -85,6 +86,11 @@ class SatPI :
 
 		bool exitApplication() const;
 
+	private:
+
+		/// Place the server threads on the housekeeping CPUs
+		void applyThreadPlacement();
+
 		// =======================================================================
 		// -- Data members -------------------------------------------------------
 		// =======================================================================
@@ -22,11 +22,16 @@
 #include <Log.h>
 #include <StringConverter.h>
 #include <Utils.h>
+#include <base/Metrics.h>
+#include <base/ThreadPlacement.h>
 #include <output/StreamClient.h>
 #include <input/Device.h>
 #include <input/dvb/Frontend.h>
 #include <input/dvb/FrontendData.h>
 #include <input/dvb/delivery/DVBS.h>
+#include <mpegts/Filter.h>
+#include <mpegts/PacketBufferPool.h>
+#include <mpegts/PacketView.h>
 #include <output/StreamClientOutputHttp.h>
 #include <output/StreamClientOutputRtp.h>
 #include <output/StreamClientOutputRtpTcp.h>
@@ -40,6 +45,28 @@
 #include <thread>
 
 
+// =============================================================================
+// -- Static const data --------------------------------------------------------
+// =============================================================================
+
+static constexpr std::size_t DEFAULT_RING_SIZE = 100;
+static constexpr std::size_t MIN_RING_SIZE     = 10;
+static constexpr std::size_t MAX_RING_SIZE     = 2000;
+static constexpr std::size_t DEFAULT_SEND_BATCH = 8;
+static constexpr unsigned int MAX_COALESCE_SIZE = 64;
+static constexpr unsigned int DEFAULT_COALESCE_LATENCY = 10;
+static constexpr unsigned int MAX_COALESCE_LATENCY = 100;
+static constexpr unsigned int NULL_PACKET_TIMEOUT = 100;
+static constexpr unsigned int DEFAULT_OUTPUT_QUEUE_SIZE = 4096;
+static constexpr unsigned int MIN_OUTPUT_QUEUE_SIZE = 64;
+static constexpr unsigned int MAX_OUTPUT_QUEUE_SIZE = 65536;
+#ifdef LATENCY_HISTOGRAM
+/// Sample the hot path once every this amount of PacketBuffers
+static constexpr std::size_t LATENCY_SAMPLE_INTERVAL = 64;
+static constexpr const char *LATENCY_STAGE_NAME[] = {"read", "filter", "decrypt_submit", "send"};
+static constexpr const char *LATENCY_STAGE_XML[] = {"latencyRead", "latencyFilter", "latencyDecryptSubmit", "latencySend"};
+#endif
+
 // =============================================================================
 // -- Constructors and destructor ----------------------------------------------
 // =============================================================================
@@ -47,27 +74,41 @@
 Stream::Stream(input::SpDevice device, decrypt::dvbapi::SpClient decrypt) :
 	_enabled(true),
 	_streamInUse(false),
+	_streamClients(std::make_shared<const std::vector<output::SpStreamClient>>()),
 	_decrypt(decrypt),
 	_device(device),
 	_rtcpSignalUpdate(1),
 	_threadDeviceDataReader(
 		StringConverter::stringFormat("Reader@#1", _device->getFeID()),
 		std::bind(&Stream::threadExecuteDeviceDataReader, this)),
+	_threadStreamClientWriter(
+		StringConverter::stringFormat("Writer@#1", _device->getFeID()),
+		std::bind(&Stream::threadExecuteStreamClientWriter, this)),
 	_threadDeviceMonitor(
 		StringConverter::stringFormat("Monitor@#1", _device->getFeID()),
 		std::bind(&Stream::threadExecuteDeviceMonitor, this)),
-	_writeIndex(0),
-	_readIndex(0),
-	_sendInterval(100),
-	_signalLock(false) {
+	_ringSize(DEFAULT_RING_SIZE),
+	_sendBatch(DEFAULT_SEND_BATCH),
+	_udpGSO(false),
+	_httpZeroCopy(false),
+	_coalesceSize(0),
+	_coalesceLatency(DEFAULT_COALESCE_LATENCY),
+	_writerIdle(0),
+	_outputQueueSize(DEFAULT_OUTPUT_QUEUE_SIZE),
+	_outputQueueDisconnect(false),
+	_overrun(false),
+	_signalLock(false),
+	_bytesIn(0),
+	_deviceReads(0)
+#ifdef LATENCY_HISTOGRAM
+	, _readerSampleCount(0),
+	_writerSampleCount(0)
+#endif
+	{
 	ASSERT(device);
 #ifdef LIBDVBCSA
 	ASSERT(decrypt);
 #endif
-	// Initialize all TS packets
-	for (mpegts::PacketBuffer& buffer : _tsBuffer) {
-		buffer.initialize(0, 0);
-	}
 	std::array<unsigned char, 188> nullPacked{};
 	std::memset(nullPacked.data(), 0xFF, nullPacked.size());
 	nullPacked[0] = 0x47;
@@ -96,7 +137,36 @@ void Stream::doAddToXML(std::string &xml) const {
 	ADD_XML_CHECKBOX(xml, "enable", (_enabled ? "true" : "false"));
 	ADD_XML_ELEMENT(xml, "attached", _streamInUse ? "yes" : "no");
 	ADD_XML_NUMBER_INPUT(xml, "rtcpSignalUpdate", _rtcpSignalUpdate, 1, 5);
-	for (const output::SpStreamClient &client : _streamClientVector) {
+	ADD_XML_NUMBER_INPUT(xml, "ringSize", _ringSize, MIN_RING_SIZE, MAX_RING_SIZE);
+	ADD_XML_NUMBER_INPUT(xml, "sendBatch", _sendBatch.load(), 1, output::StreamClient::MAX_WRITE_BATCH);
+	ADD_XML_CHECKBOX(xml, "udpGSO", (_udpGSO ? "true" : "false"));
+	ADD_XML_CHECKBOX(xml, "httpZeroCopy", (_httpZeroCopy ? "true" : "false"));
+	ADD_XML_NUMBER_INPUT(xml, "coalesceSize", _coalesceSize.load(), 0, MAX_COALESCE_SIZE);
+	ADD_XML_NUMBER_INPUT(xml, "coalesceLatency", _coalesceLatency.load(), 1, MAX_COALESCE_LATENCY);
+	ADD_XML_NUMBER_INPUT(xml, "outputQueueSize", _outputQueueSize.load(), MIN_OUTPUT_QUEUE_SIZE, MAX_OUTPUT_QUEUE_SIZE);
+	ADD_XML_CHECKBOX(xml, "outputQueueDisconnect", (_outputQueueDisconnect ? "true" : "false"));
+	{
+		// Lock, because the ring can be released when streaming stops
+		base::MutexLock lock(_mutex);
+		ADD_XML_ELEMENT(xml, "ringOccupancy", _tsBuffer.getOccupancy());
+		ADD_XML_ELEMENT(xml, "ringMaxOccupancy", _tsBuffer.getMaxOccupancy());
+		ADD_XML_ELEMENT(xml, "ringOverruns", _tsBuffer.getOverruns());
+		ADD_XML_ELEMENT(xml, "ringPinned", _tsBuffer.getPinned());
+	}
+	ADD_XML_ELEMENT(xml, "readerPlacement", base::ThreadPlacement::getPlacementString(_threadDeviceDataReader));
+	ADD_XML_ELEMENT(xml, "writerPlacement", base::ThreadPlacement::getPlacementString(_threadStreamClientWriter));
+	ADD_XML_ELEMENT(xml, "monitorPlacement", base::ThreadPlacement::getPlacementString(_threadDeviceMonitor));
+#ifdef LATENCY_HISTOGRAM
+	for (std::size_t stage = 0; stage < LATENCY_STAGES; ++stage) {
+		// Show p50 / p99 / max in us
+		const base::LatencyHistogram &latency = _latency[stage];
+		ADD_XML_ELEMENT(xml, LATENCY_STAGE_XML[stage], StringConverter::stringFormat("@#1 / @#2 / @#3",
+			latency.getQuantile(0.5) / 1000.0, latency.getQuantile(0.99) / 1000.0, latency.getMax() / 1000.0));
+	}
+#endif
+	const StreamClientSnapshot clients = std::atomic_load(&_streamClients);
+	ADD_XML_ELEMENT(xml, "streamClients", clients->size());
+	for (const output::SpStreamClient &client : *clients) {
 		client->addToXML(xml);
 	}
 	_device->addToXML(xml);
@@ -110,6 +180,38 @@ void Stream::doFromXML(const std::string &xml) {
 	if (findXMLElement(xml, "rtcpSignalUpdate.value", element)) {
 		_rtcpSignalUpdate = std::stoi(element);
 	}
+	if (findXMLElement(xml, "ringSize.value", element)) {
+		// Will be used when streaming (re)starts
+		const std::size_t size = std::stoi(element);
+		_ringSize = std::clamp(size, MIN_RING_SIZE, MAX_RING_SIZE);
+	}
+	if (findXMLElement(xml, "udpGSO.value", element)) {
+		// Will be used for new RTP/UDP StreamClients
+		_udpGSO = (element == "true") ? true : false;
+	}
+	if (findXMLElement(xml, "httpZeroCopy.value", element)) {
+		// Will be used for new HTTP StreamClients
+		_httpZeroCopy = (element == "true") ? true : false;
+	}
+	if (findXMLElement(xml, "coalesceSize.value", element)) {
+		const unsigned int size = std::stoi(element);
+		_coalesceSize = std::min(size, MAX_COALESCE_SIZE);
+	}
+	if (findXMLElement(xml, "coalesceLatency.value", element)) {
+		const unsigned int latency = std::stoi(element);
+		_coalesceLatency = std::clamp(latency, 1u, MAX_COALESCE_LATENCY);
+	}
+	if (findXMLElement(xml, "outputQueueSize.value", element)) {
+		const unsigned int size = std::stoi(element);
+		_outputQueueSize = std::clamp(size, MIN_OUTPUT_QUEUE_SIZE, MAX_OUTPUT_QUEUE_SIZE);
+	}
+	if (findXMLElement(xml, "outputQueueDisconnect.value", element)) {
+		_outputQueueDisconnect = (element == "true") ? true : false;
+	}
+	if (findXMLElement(xml, "sendBatch.value", element)) {
+		const std::size_t batch = std::stoi(element);
+		_sendBatch = std::clamp(batch, std::size_t(1), output::StreamClient::MAX_WRITE_BATCH);
+	}
 	_device->fromXML(xml);
 }
 
@@ -135,6 +237,25 @@ input::dvb::SpFrontendDecryptInterface Stream::getFrontendDecryptInterface() {
 }
 #endif
 
+void Stream::setPacketBufferPool(mpegts::SpPacketBufferPool pool) {
+	base::MutexLock lock(_mutex);
+	_packetBufferPool = pool;
+}
+
+void Stream::setThreadPlacement(base::SpThreadPlacement placement) {
+	base::MutexLock lock(_mutex);
+	_threadPlacement = placement;
+	// Threads that are not running will use it when they are started
+	_threadPlacement->placeStreamThreads(_device->getFeIndex().getID(),
+		_threadDeviceDataReader, _threadStreamClientWriter);
+	_threadPlacement->placeHousekeepingThread(_threadDeviceMonitor);
+}
+
+bool Stream::isShareableFor(const TransportParamVector &params) const {
+	base::MutexLock lock(_mutex);
+	return _enabled && _streamInUse && _device->capableToShare(params);
+}
+
 void Stream::addDeliverySystemCount(
 		std::size_t &dvbs2,
 		std::size_t &dvbt,
@@ -149,22 +270,24 @@ void Stream::addDeliverySystemCount(
 void Stream::startStreaming(output::SpStreamClient streamClient) {
 	streamClient->startStreaming();
 
-	// set begin timestamp
-	_t1 = std::chrono::steady_clock::now();
-	_writeIndex = 0;
-	_readIndex = 0;
-	_tsBuffer[_writeIndex].reset();
+	if (!_packetBufferPool) {
+		_packetBufferPool = mpegts::PacketBufferPool::makeSP();
+	}
+	_tsBuffer.allocate(_packetBufferPool, _ringSize);
+	_overrun = false;
 
 	_threadDeviceMonitor.startThread();
+	_threadStreamClientWriter.startThread();
 	_threadDeviceDataReader.startThread();
 	_threadDeviceDataReader.setPriority(base::Thread::Priority::AboveNormal);
-	SI_LOG_DEBUG("Frontend: @#1, Start Reader and Monitor Thread", _device->getFeID());
+	SI_LOG_DEBUG("Frontend: @#1, Start Reader, Writer and Monitor Thread", _device->getFeID());
 }
 
 void Stream::pauseStreaming(output::SpStreamClient UNUSED(streamClient)) {
 	_threadDeviceDataReader.pauseThread();
+	_threadStreamClientWriter.pauseThread();
 	_threadDeviceMonitor.pauseThread();
-	SI_LOG_DEBUG("Frontend: @#1, Pause Reader and Monitor Thread", _device->getFeID());
+	SI_LOG_DEBUG("Frontend: @#1, Pause Reader, Writer and Monitor Thread", _device->getFeID());
 #ifdef LIBDVBCSA
 	// When LIBDVBCSA is defined _decrypt is created
 	_decrypt->stopDecrypt(_device->getFeIndex(), _device->getFeID());
@@ -172,26 +295,27 @@ void Stream::pauseStreaming(output::SpStreamClient UNUSED(streamClient)) {
 }
 
 void Stream::restartStreaming(output::SpStreamClient UNUSED(streamClient)) {
-	// set begin timestamp
-	_t1 = std::chrono::steady_clock::now();
-	_writeIndex = 0;
-	_readIndex = 0;
-	_tsBuffer[_writeIndex].reset();
+	_tsBuffer.reset();
+	_overrun = false;
 
+	_threadStreamClientWriter.restartThread();
 	_threadDeviceDataReader.restartThread();
 	_threadDeviceMonitor.restartThread();
-	SI_LOG_DEBUG("Frontend: @#1, Restart Reader and Monitor Thread", _device->getFeID());
+	SI_LOG_DEBUG("Frontend: @#1, Restart Reader, Writer and Monitor Thread", _device->getFeID());
 }
 
 void Stream::stopStreaming() {
 	_threadDeviceDataReader.stopThread();
+	_threadStreamClientWriter.stopThread();
 	_threadDeviceMonitor.stopThread();
-	SI_LOG_DEBUG("Frontend: @#1, Stop Reader and Monitor Thread", _device->getFeID());
+	SI_LOG_DEBUG("Frontend: @#1, Stop Reader, Writer and Monitor Thread", _device->getFeID());
 #ifdef LIBDVBCSA
 	// When LIBDVBCSA is defined _decrypt is created
 	_decrypt->stopDecrypt(_device->getFeIndex(), _device->getFeID());
 #endif
 	_device->teardown();
+	_tsBuffer.release();
+	_pidUnion.clear();
 	_streamInUse = false;
 }
 
@@ -213,22 +337,22 @@ void Stream::determineAndMakeStreamClientType(FeID feID, const SocketClient &cli
 				SI_LOG_INFO("Frontend: @#1, Setup Multicast (@#2) for StreamClient",
 					feID, multicast);
 				SI_LOG_DEBUG("Frontend: @#1, Found Streaming type: HTTP -> Multicast", feID);
-				_streamClientVector.push_back(output::StreamClientOutputRtp::makeSP(feID, true));
+				_streamClientVector.push_back(output::StreamClientOutputRtp::makeSP(feID, true, _udpGSO));
 			}
 		} else {
 			SI_LOG_DEBUG("Frontend: @#1, Found Streaming type: HTTP", feID);
-			_streamClientVector.push_back(output::StreamClientOutputHttp::makeSP(feID));
+			_streamClientVector.push_back(output::StreamClientOutputHttp::makeSP(feID, _httpZeroCopy));
 		}
 	} else {
 		const std::string transport = headers.getFieldParameter("Transport");
 		if (transport.find("unicast") != std::string::npos) {
 			if (transport.find("RTP/AVP") != std::string::npos) {
 				SI_LOG_DEBUG("Frontend: @#1, Found Streaming type: RTP/AVP", feID);
-				_streamClientVector.push_back(output::StreamClientOutputRtp::makeSP(feID, false));
+				_streamClientVector.push_back(output::StreamClientOutputRtp::makeSP(feID, false, _udpGSO));
 			}
 		} else if (transport.find("multicast") != std::string::npos) {
 			SI_LOG_DEBUG("Frontend: @#1, Found Streaming type: RTSP Multicast", feID);
-			_streamClientVector.push_back(output::StreamClientOutputRtp::makeSP(feID, true));
+			_streamClientVector.push_back(output::StreamClientOutputRtp::makeSP(feID, true, _udpGSO));
 		} else if (transport.find("RTP/AVP/TCP") != std::string::npos) {
 			SI_LOG_DEBUG("Frontend: @#1, Found Streaming type: RTP/AVP/TCP", feID);
 			_streamClientVector.push_back(output::StreamClientOutputRtpTcp::makeSP(feID));
@@ -236,6 +360,50 @@ void Stream::determineAndMakeStreamClientType(FeID feID, const SocketClient &cli
 	}
 }
 
+void Stream::publishStreamClients_L() {
+	std::atomic_store(&_streamClients, StreamClientSnapshot(
+		std::make_shared<const std::vector<output::SpStreamClient>>(_streamClientVector)));
+}
+
+void Stream::updateClientPIDs_L(output::StreamClient &streamClient,
+		const TransportParamVector &params) {
+	mpegts::PidMask &mask = streamClient.getPidMask();
+	const std::string userPids = _device->getFilter().getUserPids();
+	// A (re)tune or a new 'pids=' replaces all PIDs of this client
+	const std::string pidsList = params.getParameter("pids");
+	if (!pidsList.empty() || params.getDoubleParameter("freq") != -1.0) {
+		mask.clear();
+	}
+	if (!pidsList.empty()) {
+		mask.parsePIDString(pidsList, true, userPids);
+	}
+	const std::string addpidsList = params.getParameter("addpids");
+	if (!addpidsList.empty()) {
+		mask.parsePIDString(addpidsList, true, userPids);
+	}
+	const std::string delpidsList = params.getParameter("delpids");
+	if (!delpidsList.empty()) {
+		mask.parsePIDString(delpidsList, false, userPids);
+	}
+}
+
+void Stream::updatePIDUnion_L() {
+	mpegts::PidMask pidUnion;
+	for (const output::SpStreamClient &client : _streamClientVector) {
+		pidUnion.merge(client->getPidMask());
+	}
+	// Only touch the PIDs that changed, so PIDs opened by others (like OSCam)
+	// and PIDs that stay in use are not closed and reopened
+	mpegts::Filter &filter = _device->getFilter();
+	for (int pid = 0; pid < mpegts::PidMask::MAX_PIDS; ++pid) {
+		const bool used = pidUnion.isSetInMask(pid);
+		if (used != _pidUnion.isSetInMask(pid)) {
+			filter.setPID(pid, used);
+		}
+	}
+	_pidUnion.assign(pidUnion);
+}
+
 output::SpStreamClient Stream::findStreamClientFor(SocketClient &socketClient,
 		const bool newSession, const std::string sessionID) {
 	base::MutexLock lock(_mutex);
@@ -268,9 +436,9 @@ output::SpStreamClient Stream::findStreamClientFor(SocketClient &socketClient,
 		}
 	}
 
-	// @TODO[StreamClient] Make here StreamClients etc. (add sharing)
 	if (_streamClientVector.empty()) {
 		determineAndMakeStreamClientType(id, socketClient);
+		publishStreamClients_L();
 	}
 
 	// Try to find an empty or requested StreamClients
@@ -291,9 +459,17 @@ output::SpStreamClient Stream::findStreamClientFor(SocketClient &socketClient,
 		}
 	}
 
-	if (shareable) {
-		SI_LOG_INFO("Frontend: @#1, StreamClient with SessionID @#2 is Sharing...", id, sessionID);
-		// @TODO: Sharing of devices among StreamClients
+	// Share this tuned stream with a new StreamClient
+	if (newSession && _streamInUse && shareable) {
+		const std::size_t size = _streamClientVector.size();
+		determineAndMakeStreamClientType(id, socketClient);
+		if (_streamClientVector.size() > size) {
+			SI_LOG_INFO("Frontend: @#1, StreamClient with SessionID @#2 is Sharing...", id, sessionID);
+			output::SpStreamClient client = _streamClientVector.back();
+			client->setSocketClient(socketClient);
+			publishStreamClients_L();
+			return client;
+		}
 	}
 
 	if (msys != input::InputSystem::UNDEFINED) {
@@ -310,7 +486,9 @@ void Stream::checkForSessionTimeout() {
 	if (!_streamInUse) {
 		return;
 	}
-	for (const output::SpStreamClient &client : _streamClientVector) {
+	// Iterate over a copy, because teardown will remove the client
+	const std::vector<output::SpStreamClient> clients = _streamClientVector;
+	for (const output::SpStreamClient &client : clients) {
 		if (client->sessionTimeout() || !_enabled) {
 			if (_enabled) {
 				SI_LOG_INFO("Frontend: @#1, Watchdog kicked in for StreamClient with SessionID @#2",
@@ -324,6 +502,62 @@ void Stream::checkForSessionTimeout() {
 	}
 }
 
+void Stream::addToMetrics(base::Metrics &metrics) const {
+	using Type = base::Metrics::Type;
+	const std::string labels = base::Metrics::makeLabel("stream", _device->getFeID().getID());
+	const unsigned long bytesIn = _bytesIn.load(std::memory_order_relaxed);
+	metrics.add("satpi_stream_bytes_received_total", Type::COUNTER,
+		"TS bytes read from the device", labels, bytesIn);
+	metrics.add("satpi_stream_packets_received_total", Type::COUNTER,
+		"TS packets read from the device", labels, bytesIn / mpegts::PacketBuffer::TS_PACKET_SIZE);
+	metrics.add("satpi_stream_device_reads_total", Type::COUNTER,
+		"Read calls done on the device", labels, _deviceReads.load(std::memory_order_relaxed));
+	metrics.add("satpi_stream_cc_errors_total", Type::COUNTER,
+		"Continuity Counter errors of the opened PIDs", labels, _device->getFilter().getTotalCCErrors());
+	{
+		// Lock, because the ring can be released when streaming stops. The
+		// reader and writer threads do not take this lock
+		base::MutexLock lock(_mutex);
+		metrics.add("satpi_stream_ring_slots", Type::GAUGE,
+			"Slots of the ring buffer", labels, _tsBuffer.size());
+		metrics.add("satpi_stream_ring_occupancy", Type::GAUGE,
+			"Published slots of the ring buffer that are not yet written", labels, _tsBuffer.getOccupancy());
+		metrics.add("satpi_stream_ring_max_occupancy", Type::GAUGE,
+			"Highest occupancy of the ring buffer since streaming started", labels, _tsBuffer.getMaxOccupancy());
+		metrics.add("satpi_stream_ring_overruns_total", Type::COUNTER,
+			"Times the reader found the ring buffer full", labels, _tsBuffer.getOverruns());
+	}
+#ifdef LIBDVBCSA
+	const input::dvb::SpFrontendDecryptInterface frontend =
+		std::dynamic_pointer_cast<input::dvb::FrontendDecryptInterface>(_device);
+	if (frontend != nullptr) {
+		metrics.add("satpi_stream_decrypt_batches_total", Type::COUNTER,
+			"Decrypt batches handed to dvbcsa", labels, frontend->getDecryptedBatches());
+		metrics.add("satpi_stream_decrypt_packets_total", Type::COUNTER,
+			"TS packets decrypted in all batches", labels, frontend->getDecryptedPackets());
+	}
+#endif
+#ifdef LATENCY_HISTOGRAM
+	for (std::size_t stage = 0; stage < LATENCY_STAGES; ++stage) {
+		const base::LatencyHistogram &latency = _latency[stage];
+		const base::Metrics::QuantileVector quantiles = {
+			{0.5, latency.getQuantile(0.5) / 1e9},
+			{0.9, latency.getQuantile(0.9) / 1e9},
+			{0.99, latency.getQuantile(0.99) / 1e9},
+			{1.0, latency.getMax() / 1e9}
+		};
+		metrics.addSummary("satpi_stream_stage_latency_seconds",
+			"Sampled duration of a hot path stage (read, filter, decrypt, send) for one batch",
+			labels + "," + base::Metrics::makeLabel("stage", LATENCY_STAGE_NAME[stage]),
+			quantiles, latency.getSum() / 1e9, latency.getCount());
+	}
+#endif
+	const StreamClientSnapshot clients = std::atomic_load(&_streamClients);
+	for (const output::SpStreamClient &client : *clients) {
+		client->addToMetrics(metrics, labels);
+	}
+}
+
 bool Stream::update(output::SpStreamClient streamClient) {
 	base::MutexLock lock(_mutex);
 
@@ -338,8 +572,14 @@ bool Stream::update(output::SpStreamClient streamClient) {
 	const bool threadStopped = _threadDeviceDataReader.isStopped();
 	if (threadStopped) {
 		startStreaming(streamClient);
-	} else if (frequencyChanged) {
-		restartStreaming(streamClient);
+	} else {
+		if (frequencyChanged) {
+			restartStreaming(streamClient);
+		}
+		// Joining a shared stream that is already running
+		if (!streamClient->isStreaming()) {
+			streamClient->startStreaming();
+		}
 	}
 	return true;
 }
@@ -353,11 +593,16 @@ bool Stream::teardown(output::SpStreamClient streamClient) {
 	const auto s = std::find(_streamClientVector.begin(), _streamClientVector.end(), streamClient);
 	if (s != _streamClientVector.end()) {
 		_streamClientVector.erase(s);
+		publishStreamClients_L();
 	}
 
 	streamClient->teardown();
 	if (_streamClientVector.size() == 0) {
 		stopStreaming();
+	} else if (_streamInUse) {
+		// Still shared, so close the PIDs only this client was using
+		updatePIDUnion_L();
+		_device->updatePIDFilters();
 	}
 	return true;
 }
@@ -369,7 +614,20 @@ bool Stream::processStreamingRequest(const SocketClient &client, output::SpStrea
 		const std::string method = client.getMethod();
 		if (method == "SETUP" || method == "PLAY"  || method == "GET") {
 			const TransportParamVector params = client.getTransportParameters();
-			_device->parseStreamString(params);
+			if (_streamClientVector.size() > 1) {
+				// Shared stream, so do not retune or clear the PIDs of the
+				// other StreamClients, only update the PIDs of this one
+				if (params.getDoubleParameter("freq") != -1.0 && !_device->capableToShare(params)) {
+					SI_LOG_INFO("Frontend: @#1, Stream is shared, ignoring transponder change for SessionID @#2",
+						_device->getFeID(), streamClient->getSessionID());
+				}
+				updateClientPIDs_L(*streamClient, params);
+				updatePIDUnion_L();
+			} else {
+				_device->parseStreamString(params);
+				updateClientPIDs_L(*streamClient, params);
+				_pidUnion.assign(streamClient->getPidMask());
+			}
 		}
 	}
 
@@ -387,7 +645,8 @@ std::string Stream::getSDPMediaLevelString() const {
 	const std::string fmtp = _device->attributeDescribeString();
 	std::string mediaLevel;
 	if (fmtp.size() > 5) {
-		for (const output::SpStreamClient &client : _streamClientVector) {
+		const StreamClientSnapshot clients = std::atomic_load(&_streamClients);
+		for (const output::SpStreamClient &client : *clients) {
 			mediaLevel += client->getSDPMediaLevelString(_device->getStreamID(), fmtp);
 		}
 	}
@@ -395,64 +654,180 @@ std::string Stream::getSDPMediaLevelString() const {
 }
 
 bool Stream::threadExecuteDeviceDataReader() {
-	const size_t availableSize = (_writeIndex >= _readIndex) ?
-			((_tsBuffer.size() - _writeIndex) + _readIndex) : (_readIndex - _writeIndex);
-
-//	SI_LOG_DEBUG("Frontend: @#1, PacketBuffer MAX @#2 W @#3 R @#4  A @#5", _device->getFeID(), _tsBuffer.size(), write, read, availableSize);
-	if (_device->isDataAvailable() && availableSize >= 1) {
-		if (_device->readTSPackets(_tsBuffer[_writeIndex])) {
+	if (!_device->isDataAvailable()) {
 #ifdef LIBDVBCSA
-			// When LIBDVBCSA is defined _decrypt is created
-			_decrypt->decrypt(_device->getFeIndex(), _device->getFeID(), _tsBuffer[_writeIndex]);
+		// The last packets of a batch should not wait for new data
+		_decrypt->decryptExpiredBatch(_device->getFeIndex());
+		_tsBuffer.publish();
 #endif
-			// goto next, so inc write index
-			++_writeIndex;
-			_writeIndex %= _tsBuffer.size();
-			// reset next
-			_tsBuffer[_writeIndex].reset();
+		return true;
+	}
+	const std::size_t batch = _tsBuffer.prepareWriteSlots();
+	if (batch == 0) {
+		// Ring is full, so the writer is not keeping up. Count it once and
+		// give the writer some time instead of spinning on the device
+		if (!_overrun) {
+			_overrun = true;
+			_tsBuffer.addOverrun();
 		}
+#ifdef LIBDVBCSA
+		// A full ring can be waiting for the pending batch, so flush it when
+		// its deadline expired or OSCam is gone
+		_decrypt->decryptExpiredBatch(_device->getFeIndex());
+		_tsBuffer.publish();
+#endif
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return true;
+	}
+	_overrun = false;
+#ifdef LATENCY_HISTOGRAM
+	// The Filter is called from readTSPackets, so let it measure itself
+	const bool sample = _readerSampleCount >= LATENCY_SAMPLE_INTERVAL;
+	if (sample) {
+		_device->getFilter().measureNextFilterData();
+	}
+	const uint64_t readBegin = sample ? base::LatencyHistogram::now() : 0;
+#endif
+	const std::size_t filled = _device->readTSPackets(&_tsBuffer.getWriteSlot(), batch);
+#ifdef LATENCY_HISTOGRAM
+	const uint64_t readEnd = sample ? base::LatencyHistogram::now() : 0;
+#endif
+#ifdef LIBDVBCSA
+	// When LIBDVBCSA is defined _decrypt is created
+	for (std::size_t i = 0; i < filled; ++i) {
+		_decrypt->decrypt(_device->getFeIndex(), _device->getFeID(), _tsBuffer.getWriteSlot(i));
 	}
-	executeStreamClientWriter();
+	// Check the batch deadline on every pass, also when no buffer got full
+	_decrypt->decryptExpiredBatch(_device->getFeIndex());
+#endif
+#ifdef LATENCY_HISTOGRAM
+	if (sample && filled > 0) {
+		const uint64_t filterTime = _device->getFilter().getMeasuredFilterTime();
+		_latency[LATENCY_READ].record(readEnd - readBegin - filterTime);
+		_latency[LATENCY_FILTER].record(filterTime);
+#ifdef LIBDVBCSA
+		// With decrypt threads this is only handing the batches over, the
+		// descramble time itself is in the batch latency of the frontend
+		_latency[LATENCY_DECRYPT_SUBMIT].record(base::LatencyHistogram::now() - readEnd);
+#endif
+		_readerSampleCount = 0;
+	}
+	_readerSampleCount += filled;
+#endif
+	_deviceReads.fetch_add(1, std::memory_order_relaxed);
+	std::size_t bytes = 0;
+	for (std::size_t i = 0; i < filled; ++i) {
+		bytes += _tsBuffer.getWriteSlot(i).getCurrentBufferSize();
+	}
+	_bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+	_tsBuffer.advanceWrite(filled);
+	// Hand everything that is ready over to the writer, this includes
+	// older buffers that were waiting for decryption
+	_tsBuffer.publish();
 	return true;
 }
 
-void Stream::executeStreamClientWriter() {
-	// calculate interval
-	_t2 = std::chrono::steady_clock::now();
-	const unsigned long interval = std::chrono::duration_cast<std::chrono::microseconds>(_t2 - _t1).count();
-	const bool intervalExeeded = interval > _sendInterval;
-
-	const size_t availableSize = (_writeIndex >= _readIndex) ?
-			(_writeIndex - _readIndex) : ((_tsBuffer.size() - _readIndex) + _writeIndex);
-
-	if (availableSize > 0 || intervalExeeded) {
-		const size_t cnt = (availableSize > 4) ? 4 : 1;
-//		SI_LOG_DEBUG("Frontend: @#1, PacketBuffer MAX @#2 W @#3 R @#4 A @#5 C @#6", _device->getFeID(), _tsBuffer.size(), write, read, availableSize, cnt);
-		for (size_t i = 0; i < cnt; ++i) {
-			const bool readyToSend = _tsBuffer[_readIndex].isReadyToSend();
-			if (readyToSend) {
-				_t1 = _t2;
-				bool incrementReadIndex = false;
-				// Send the packet full or not, else send null packet
-				for (const output::SpStreamClient &client : _streamClientVector) {
-					if (client->writeData(_tsBuffer[_readIndex])) {
-						incrementReadIndex = true;
+bool Stream::threadExecuteStreamClientWriter() {
+	const StreamClientSnapshot clients = std::atomic_load(&_streamClients);
+	// The TCP outputs may coalesce the buffers into larger writes, but not
+	// more then half the ring, because coalesced buffers stay pinned
+	const std::size_t slotSize = mpegts::PacketBuffer::MTU_MAX_TS_PACKET_SIZE;
+	const std::size_t coalesceBytes = std::min<std::size_t>(
+		_coalesceSize * 1024, (_tsBuffer.size() / 2) * slotSize);
+	const unsigned int coalesceLatency = _coalesceLatency;
+	const unsigned int timeout = (coalesceBytes > 0) ?
+		std::min(coalesceLatency, NULL_PACKET_TIMEOUT) : NULL_PACKET_TIMEOUT;
+	// A slow TCP client gets its data queued, so it never blocks the others
+	const std::size_t outputQueueBytes = _outputQueueSize * 1024;
+	const output::OutputQueue::Policy outputQueuePolicy = _outputQueueDisconnect ?
+		output::OutputQueue::Policy::DISCONNECT : output::OutputQueue::Policy::DROP_OLDEST;
+	for (const output::SpStreamClient &client : *clients) {
+		client->setWriteCoalescing(coalesceBytes, coalesceLatency);
+		client->setOutputQueue(outputQueueBytes, outputQueuePolicy);
+	}
+	if (!_tsBuffer.waitForData(timeout)) {
+		_writerIdle += timeout;
+		for (const output::SpStreamClient &client : *clients) {
+			if (!client->isStreaming()) {
+				continue;
+			}
+			if (_writerIdle >= NULL_PACKET_TIMEOUT) {
+				// Nothing to send within time-out, so send null packet
+				client->setWriteSequence(_tsBuffer.getReadSequence());
+				client->writeData(_tsEmpty);
+			}
+			client->flushData(true);
+		}
+		if (_writerIdle >= NULL_PACKET_TIMEOUT) {
+			_writerIdle = 0;
+		}
+		releaseRingBuffers(*clients);
+		return true;
+	}
+	_writerIdle = 0;
+	// When shared, the demux delivers the PIDs of all clients together, so
+	// each client only gets a view on the PIDs it requested
+	const bool shared = clients->size() > 1;
+	mpegts::PacketView view;
+
+	// Drain the complete backlog, in batches of ready buffers, so the
+	// StreamClient can send them together (sendmmsg for RTP/UDP)
+	const std::size_t sendBatch = _sendBatch;
+	std::array<mpegts::PacketBuffer *, output::StreamClient::MAX_WRITE_BATCH> buffers;
+	std::size_t available = _tsBuffer.getReadableSlots();
+	while (available > 0) {
+		const std::size_t batch = (available < sendBatch) ? available : sendBatch;
+		for (std::size_t i = 0; i < batch; ++i) {
+			buffers[i] = &_tsBuffer.getReadSlot(i);
+		}
+#ifdef LATENCY_HISTOGRAM
+		const bool sample = _writerSampleCount >= LATENCY_SAMPLE_INTERVAL;
+		const uint64_t sendBegin = sample ? base::LatencyHistogram::now() : 0;
+#endif
+		for (const output::SpStreamClient &client : *clients) {
+			if (!client->isStreaming()) {
+				continue;
+			}
+			client->setWriteSequence(_tsBuffer.getReadSequence());
+			if (shared && !client->getPidMask().isAll()) {
+				for (std::size_t i = 0; i < batch; ++i) {
+					view.select(*buffers[i], client->getPidMask());
+					if (!view.empty()) {
+						client->writeData(*buffers[i], view);
 					}
 				}
-				if (incrementReadIndex) {
-					++_readIndex;
-					_readIndex %= _tsBuffer.size();
-				}
-			} else if (intervalExeeded) {
-				for (const output::SpStreamClient &client : _streamClientVector) {
-					client->writeData(_tsEmpty);
-				}
-				break;
+			} else if (batch == 1) {
+				client->writeData(*buffers[0]);
 			} else {
-				break;
+				client->writeData(buffers.data(), batch);
 			}
 		}
+#ifdef LATENCY_HISTOGRAM
+		if (sample) {
+			_latency[LATENCY_SEND].record(base::LatencyHistogram::now() - sendBegin);
+			_writerSampleCount = 0;
+		}
+		_writerSampleCount += batch;
+#endif
+		_tsBuffer.advanceRead(batch);
+		available -= batch;
+	}
+	// Write what is coalesced for too long already, and what is queued
+	for (const output::SpStreamClient &client : *clients) {
+		if (client->isStreaming()) {
+			client->flushData(false);
+		}
+	}
+	releaseRingBuffers(*clients);
+	return true;
+}
+
+void Stream::releaseRingBuffers(const std::vector<output::SpStreamClient> &clients) {
+	uint64_t released = _tsBuffer.getReadSequence();
+	for (const output::SpStreamClient &client : clients) {
+		released = std::min(released, client->getReleasedSequence(_tsBuffer.getReadSequence()));
 	}
+	_tsBuffer.releaseUpTo(released);
 }
 
 bool Stream::threadExecuteDeviceMonitor() {
@@ -461,7 +836,8 @@ bool Stream::threadExecuteDeviceMonitor() {
 	const unsigned long interval = 200 * _rtcpSignalUpdate;
 
 	const std::string desc = _device->attributeDescribeString();
-	for (const output::SpStreamClient &client : _streamClientVector) {
+	const StreamClientSnapshot clients = std::atomic_load(&_streamClients);
+	for (const output::SpStreamClient &client : *clients) {
 		client->writeRTCPData(desc);
 	}
 	std::this_thread::sleep_for(std::chrono::milliseconds(interval));
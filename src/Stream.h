@@ -25,16 +25,28 @@
 #include <base/Thread.h>
 #include <base/XMLSupport.h>
 #include <mpegts/PacketBuffer.h>
+#include <mpegts/PacketBufferRing.h>
+#include <mpegts/PidMask.h>
+
+#ifdef LATENCY_HISTOGRAM
+	#include <base/LatencyHistogram.h>
+#endif
 
 #include <array>
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
 FW_DECL_NS0(SocketClient);
+FW_DECL_NS0(TransportParamVector);
+
+FW_DECL_NS1(base, Metrics);
 
+FW_DECL_SP_NS1(base, ThreadPlacement);
 FW_DECL_SP_NS1(input, Device);
+FW_DECL_SP_NS1(mpegts, PacketBufferPool);
 FW_DECL_SP_NS1(output, StreamClient);
 FW_DECL_SP_NS2(decrypt, dvbapi, Client);
 FW_DECL_SP_NS2(input, dvb, FrontendDecryptInterface);
@@ -89,6 +101,13 @@ class Stream :
 		input::dvb::SpFrontendDecryptInterface getFrontendDecryptInterface();
 #endif
 
+		/// Set the pool were the PacketBuffers of this stream are taken from
+		void setPacketBufferPool(mpegts::SpPacketBufferPool pool);
+
+		/// Set the placement of the threads of this stream and (re)apply it,
+		/// call again after the placement is changed
+		void setThreadPlacement(base::SpThreadPlacement placement);
+
 		///
 		void addDeliverySystemCount(
 				std::size_t &dvbs2,
@@ -101,6 +120,10 @@ class Stream :
 		output::SpStreamClient findStreamClientFor(SocketClient &socketClient,
 				bool newSession, std::string sessionID);
 
+		/// Check if this stream is in use and can be shared for the requested
+		/// parameters (same transponder)
+		bool isShareableFor(const TransportParamVector &params) const;
+
 		/// Check is this stream enabled, can we use it?
 		bool streamEnabled() const {
 			base::MutexLock lock(_mutex);
@@ -115,6 +138,10 @@ class Stream :
 		/// that should be closed
 		void checkForSessionTimeout();
 
+		/// Add the statistics of this stream and its clients to @p metrics,
+		/// the reader and writer threads are not waited for
+		void addToMetrics(base::Metrics &metrics) const;
+
 	private:
 
 		///
@@ -132,17 +159,45 @@ class Stream :
 		///
 		void determineAndMakeStreamClientType(FeID feID, const SocketClient &client);
 
+		/// Publish a new snapshot of the StreamClients for the Writer and
+		/// Monitor thread, call after every change of @c _streamClientVector
+		void publishStreamClients_L();
+
+		/// Update the PIDs requested by this StreamClient
+		void updateClientPIDs_L(output::StreamClient &streamClient,
+				const TransportParamVector &params);
+
+		/// Open the PIDs of all StreamClients together and close the PIDs
+		/// that are not requested anymore
+		void updatePIDUnion_L();
+
 		/// Thread execute function @see base::Thread should @return true to
 		/// keep thread running and @return false will stop and then terminate this thread
 		bool threadExecuteDeviceDataReader();
 
-		/// Write data to Streamclients
-		void executeStreamClientWriter();
+		/// Thread execute function @see base::Thread should @return true to
+		/// keep thread running and @return false will stop and then terminate this thread
+		bool threadExecuteStreamClientWriter();
+
+		/// Release the ring buffers that are not used by any StreamClient
+		/// anymore, zero-copy sends may still be holding some of them
+		void releaseRingBuffers(const std::vector<output::SpStreamClient> &clients);
 
 		/// Thread execute function @see base::Thread should @return true to
 		/// keep thread running and @return false will stop and then terminate this thread
 		bool threadExecuteDeviceMonitor();
 
+#ifdef LATENCY_HISTOGRAM
+		/// The stages of the hot path that are sampled
+		enum LatencyStage {
+			LATENCY_READ,
+			LATENCY_FILTER,
+			LATENCY_DECRYPT_SUBMIT,
+			LATENCY_SEND,
+			LATENCY_STAGES
+		};
+#endif
+
 		// =========================================================================
 		// -- Functions used for RTSP Server ---------------------------------------
 		// =========================================================================
@@ -167,21 +222,42 @@ class Stream :
 		bool _enabled;
 		bool _streamInUse;
 
+		using StreamClientSnapshot = std::shared_ptr<const std::vector<output::SpStreamClient>>;
+
 		std::vector<output::SpStreamClient> _streamClientVector;
+		StreamClientSnapshot _streamClients;
+		mpegts::PidMask _pidUnion;
 
 		decrypt::dvbapi::SpClient _decrypt;
 		input::SpDevice _device;
 		unsigned int _rtcpSignalUpdate;
 		base::Thread _threadDeviceDataReader;
+		base::Thread _threadStreamClientWriter;
 		base::Thread _threadDeviceMonitor;
-		std::array<mpegts::PacketBuffer, 100> _tsBuffer;
+		mpegts::SpPacketBufferPool _packetBufferPool;
+		base::SpThreadPlacement _threadPlacement;
+		mpegts::PacketBufferRing _tsBuffer;
+		std::size_t _ringSize;
+		std::atomic<std::size_t> _sendBatch;
+		bool _udpGSO;
+		bool _httpZeroCopy;
+		std::atomic<unsigned int> _coalesceSize;
+		std::atomic<unsigned int> _coalesceLatency;
+		unsigned int _writerIdle;
+		std::atomic<unsigned int> _outputQueueSize;
+		std::atomic_bool _outputQueueDisconnect;
 		mpegts::PacketBuffer _tsEmpty;
-		std::size_t _writeIndex;
-		std::size_t _readIndex;
-		unsigned long _sendInterval;
-		std::chrono::steady_clock::time_point _t1;
-		std::chrono::steady_clock::time_point _t2;
+		bool _overrun;
 		std::atomic_bool _signalLock;
+		std::atomic<unsigned long> _bytesIn;
+		std::atomic<unsigned long> _deviceReads;
+#ifdef LATENCY_HISTOGRAM
+		/// Read, filter and decrypt are recorded by the reader thread and
+		/// send by the writer thread
+		std::array<base::LatencyHistogram, LATENCY_STAGES> _latency;
+		std::size_t _readerSampleCount;
+		std::size_t _writerSampleCount;
+#endif
 
 };
 
@@ -21,6 +21,8 @@
 
 #include <Stream.h>
 #include <Log.h>
+#include <base/Metrics.h>
+#include <base/ThreadPlacement.h>
 #include <output/StreamClient.h>
 #include <socket/SocketClient.h>
 #include <StringConverter.h>
@@ -28,6 +30,7 @@
 #include <input/dvb/Frontend.h>
 #include <input/file/TSReader.h>
 #include <input/stream/Streamer.h>
+#include <mpegts/PacketBufferPool.h>
 #ifdef LIBDVBCSA
 	#include <decrypt/dvbapi/Client.h>
 	#include <input/dvb/FrontendDecryptInterface.h>
@@ -44,7 +47,9 @@
 
 StreamManager::StreamManager() :
 	XMLSupport(),
-	_decrypt(nullptr) {
+	_decrypt(nullptr),
+	_packetBufferPool(mpegts::PacketBufferPool::makeSP()),
+	_threadPlacement(base::ThreadPlacement::makeSP()) {
 #ifdef LIBDVBCSA
 	_decrypt = std::make_shared<decrypt::dvbapi::Client>(*this);
 #endif
@@ -59,6 +64,7 @@ void StreamManager::enumerateDevices(
 		const std::string &appDataPath,
 		const std::string &dvbPath,
 		const int numberOfChildPIPE,
+		const int numberOfSimulatedFrontends,
 		const bool enableUnsecureFrontends) {
 #ifdef NOT_PREFERRED_DVB_API
 	SI_LOG_ERROR("Not the preferred DVB API version, for correct function it should be 5.5 or higher");
@@ -66,12 +72,27 @@ void StreamManager::enumerateDevices(
 	SI_LOG_INFO("Enumerating all devices...");
 
 	// enumerate streams (frontends)
-	input::dvb::Frontend::enumerate(_streamVector, appDataPath, _decrypt, dvbPath);
+	input::dvb::Frontend::enumerate(_streamVector, appDataPath, _decrypt, dvbPath,
+		numberOfSimulatedFrontends);
 	input::file::TSReader::enumerate(_streamVector, appDataPath, enableUnsecureFrontends);
 	input::stream::Streamer::enumerate(_streamVector, bindIPAddress, appDataPath);
 	for (int i = 0; i < numberOfChildPIPE; ++i) {
 		input::childpipe::TSReader::enumerate(_streamVector, appDataPath, enableUnsecureFrontends);
 	}
+	// All streams share the same PacketBuffer pool
+	for (SpStream stream : _streamVector) {
+		stream->setPacketBufferPool(_packetBufferPool);
+	}
+	applyThreadPlacement();
+}
+
+void StreamManager::applyThreadPlacement() {
+	for (SpStream stream : _streamVector) {
+		stream->setThreadPlacement(_threadPlacement);
+	}
+#ifdef LIBDVBCSA
+	_decrypt->setThreadPlacement(_threadPlacement);
+#endif
 }
 
 std::string StreamManager::getXMLDeliveryString() const {
@@ -169,6 +190,18 @@ std::tuple<SpStream, output::SpStreamClient>  StreamManager::findStreamAndClient
 	if (feIndex == -1) {
 		SI_LOG_INFO("Found FrondtendID: x (fe=x)  StreamID: x  SessionID: @#1  New Session: @#2",
 			sessionID, newSession ? "true" : "false");
+		// First try to share a stream that is already tuned to this transponder
+		if (newSession) {
+			for (SpStream stream : _streamVector) {
+				if (stream->isShareableFor(params)) {
+					output::SpStreamClient streamClient = stream->findStreamClientFor(socketClient, newSession, sessionID);
+					if (streamClient) {
+						streamClient->setSessionID(sessionID);
+						return { stream, streamClient };
+					}
+				}
+			}
+		}
 		for (SpStream stream : _streamVector) {
 			output::SpStreamClient streamClient = stream->findStreamClientFor(socketClient, newSession, sessionID);
 			if (streamClient) {
@@ -205,6 +238,14 @@ void StreamManager::checkForSessionTimeout() {
 	}
 }
 
+std::string StreamManager::getMetrics() const {
+	base::Metrics metrics;
+	for (ScpStream stream : _streamVector) {
+		stream->addToMetrics(metrics);
+	}
+	return metrics.toText();
+}
+
 std::string StreamManager::getSDPSessionLevelString(
 		const std::string& bindIPAddress,
 		const std::string& sessionID) const {
@@ -257,8 +298,15 @@ void StreamManager::doFromXML(const std::string &xml) {
 			stream->fromXML(element);
 		}
 	}
-#ifdef LIBDVBCSA
 	std::string element;
+	if (findXMLElement(xml, "packetBufferPool", element)) {
+		_packetBufferPool->fromXML(element);
+	}
+	if (findXMLElement(xml, "threadPlacement", element)) {
+		_threadPlacement->fromXML(element);
+		applyThreadPlacement();
+	}
+#ifdef LIBDVBCSA
 	if (findXMLElement(xml, "decrypt", element)) {
 		_decrypt->fromXML(element);
 	}
@@ -271,6 +319,8 @@ void StreamManager::doAddToXML(std::string &xml) const {
 	for (ScpStream stream : _streamVector) {
 		ADD_XML_N_ELEMENT(xml, "stream", stream->getFeID(), stream->toXML());
 	}
+	ADD_XML_ELEMENT(xml, "packetBufferPool", _packetBufferPool->toXML());
+	ADD_XML_ELEMENT(xml, "threadPlacement", _threadPlacement->toXML());
 #ifdef LIBDVBCSA
 	ADD_XML_ELEMENT(xml, "decrypt", _decrypt->toXML());
 #endif
@@ -30,8 +30,13 @@
 FW_DECL_NS0(SocketClient);
 FW_DECL_NS0(TransportParamVector);
 
+FW_DECL_NS1(base, Metrics);
+
+FW_DECL_SP_NS1(base, ThreadPlacement);
+
 FW_DECL_VECTOR_OF_SP_NS0(Stream);
 
+FW_DECL_SP_NS1(mpegts, PacketBufferPool);
 FW_DECL_SP_NS1(output, StreamClient);
 FW_DECL_SP_NS2(decrypt, dvbapi, Client);
 FW_DECL_SP_NS2(input, dvb, FrontendDecryptInterface);
@@ -69,12 +74,14 @@ class StreamManager :
 		/// @param appDataPath specifies the path were to store application data
 		/// @param dvbPath specifies the path were to find dvb devices eg. /dev/dvb
 		/// @param numberOfChildPIPE to enable the requested amount of frontends 'Child PIPE - TS Reader'
+		/// @param numberOfSimulatedFrontends to add the requested amount of simulated DVB frontends
 		/// @param enableUnsecureFrontends to enable to use 'Child PIPE - TS Reader' in command directly
 		void enumerateDevices(
 			const std::string &bindIPAddress,
 			const std::string &appDataPath,
 			const std::string &dvbPath,
 			int numberOfChildPIPE,
+			int numberOfSimulatedFrontends,
 			bool enableUnsecureFrontends);
 
 		///
@@ -86,6 +93,10 @@ class StreamManager :
 		///
 		void checkForSessionTimeout();
 
+		/// Get the statistics of all streams and their clients in the
+		/// Prometheus text exposition format
+		std::string getMetrics() const;
+
 		///
 		std::string getXMLDeliveryString() const;
 
@@ -107,8 +118,16 @@ class StreamManager :
 		input::dvb::SpFrontendDecryptInterface getFrontendDecryptInterface(FeIndex feIndex);
 #endif
 
+		/// Get the CPU placement policy that is used for all threads
+		base::SpThreadPlacement getThreadPlacement() const {
+			return _threadPlacement;
+		}
+
 	private:
 
+		/// (Re)apply the thread placement to all streams and the decrypt thread
+		void applyThreadPlacement();
+
 		///
 		std::tuple<FeIndex, FeID, StreamID> findFrontendID(const TransportParamVector& params) const;
 
@@ -118,6 +137,8 @@ class StreamManager :
 	private:
 
 		decrypt::dvbapi::SpClient _decrypt;
+		mpegts::SpPacketBufferPool _packetBufferPool;
+		base::SpThreadPlacement _threadPlacement;
 		StreamSpVector _streamVector;
 };
 
@@ -0,0 +1,285 @@
+/* CPUSet.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <base/CPUSet.h>
+
+#include <Log.h>
+#include <StringConverter.h>
+#include <base/Mutex.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace base {
+
+// =============================================================================
+// -- Static member functions --------------------------------------------------
+// =============================================================================
+
+namespace {
+
+	std::string readFirstLine(const std::string &file) {
+		std::ifstream stream(file);
+		std::string line;
+		if (stream.is_open()) {
+			std::getline(stream, line);
+		}
+		return line;
+	}
+
+}
+
+CPUSet CPUSet::fromString(const std::string &list) {
+	CPUSet set;
+	std::istringstream stream(list);
+	std::string range;
+	while (std::getline(stream, range, ',')) {
+		const char *begin = range.c_str();
+		char *end = nullptr;
+		const long first = std::strtol(begin, &end, 10);
+		if (end == begin || first < 0) {
+			continue;
+		}
+		long last = first;
+		if (*end == '-') {
+			begin = end + 1;
+			last = std::strtol(begin, &end, 10);
+			if (end == begin || last < first) {
+				continue;
+			}
+		}
+		for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+			set.add(cpu);
+		}
+	}
+	return set;
+}
+
+CPUSet CPUSet::getOnline() {
+	CPUSet set = fromString(readFirstLine("/sys/devices/system/cpu/online"));
+	if (set.empty()) {
+		const long cpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+		for (long cpu = 0; cpu < cpus; ++cpu) {
+			set.add(cpu);
+		}
+	}
+	return set;
+}
+
+std::vector<CPUSet> CPUSet::getNUMANodes() {
+	const CPUSet online = getOnline();
+	std::vector<CPUSet> nodes;
+	dirent **fileList;
+	const int n = ::scandir("/sys/devices/system/node", &fileList, nullptr, versionsort);
+	for (int i = 0; i < n; ++i) {
+		int node;
+		if (std::sscanf(fileList[i]->d_name, "node%d", &node) == 1) {
+			const std::string file = StringConverter::stringFormat(
+				"/sys/devices/system/node/@#1/cpulist", fileList[i]->d_name);
+			const CPUSet cpus = fromString(readFirstLine(file)).intersect(online);
+			if (!cpus.empty()) {
+				nodes.push_back(cpus);
+			}
+		}
+		free(fileList[i]);
+	}
+	if (n >= 0) {
+		free(fileList);
+	}
+	if (nodes.empty()) {
+		nodes.push_back(online);
+	}
+	return nodes;
+}
+
+CPUSet CPUSet::fromThread(const pid_t tid) {
+	CPUSet set;
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	if (::sched_getaffinity(tid, sizeof(cpus), &cpus) == 0) {
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &cpus)) {
+				set.add(cpu);
+			}
+		}
+	}
+	return set;
+}
+
+int CPUSet::getLastCPUOfThread(const pid_t tid) {
+	const std::string stat = readFirstLine(
+		StringConverter::stringFormat("/proc/self/task/@#1/stat", tid));
+	// The name may contain spaces, so start after it. The CPU is field 39
+	// of which the first two are before this point
+	const std::string::size_type pos = stat.rfind(')');
+	if (pos == std::string::npos) {
+		return -1;
+	}
+	std::istringstream fields(stat.substr(pos + 1));
+	std::string field;
+	for (int i = 3; i <= 39; ++i) {
+		if (!(fields >> field)) {
+			return -1;
+		}
+	}
+	return std::atoi(field.c_str());
+}
+
+// =============================================================================
+// -- Other member functions ---------------------------------------------------
+// =============================================================================
+
+void CPUSet::add(const int cpu) {
+	const auto it = std::lower_bound(_cpus.begin(), _cpus.end(), cpu);
+	if (it == _cpus.end() || *it != cpu) {
+		_cpus.insert(it, cpu);
+	}
+}
+
+bool CPUSet::contains(const int cpu) const {
+	return std::binary_search(_cpus.begin(), _cpus.end(), cpu);
+}
+
+CPUSet CPUSet::intersect(const CPUSet &other) const {
+	CPUSet set;
+	std::set_intersection(_cpus.begin(), _cpus.end(),
+		other._cpus.begin(), other._cpus.end(), std::back_inserter(set._cpus));
+	return set;
+}
+
+CPUSet CPUSet::subtract(const CPUSet &other) const {
+	CPUSet set;
+	std::set_difference(_cpus.begin(), _cpus.end(),
+		other._cpus.begin(), other._cpus.end(), std::back_inserter(set._cpus));
+	return set;
+}
+
+std::string CPUSet::toString() const {
+	std::string list;
+	for (std::size_t i = 0; i < _cpus.size(); ) {
+		// Find the end of this range of consecutive CPUs
+		std::size_t j = i;
+		while (j + 1 < _cpus.size() && _cpus[j + 1] == _cpus[j] + 1) {
+			++j;
+		}
+		if (!list.empty()) {
+			list += ",";
+		}
+		list += std::to_string(_cpus[i]);
+		if (j > i) {
+			list += "-" + std::to_string(_cpus[j]);
+		}
+		i = j + 1;
+	}
+	return list;
+}
+
+bool CPUSet::applyToThread(const pid_t tid) const {
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (const int cpu : _cpus) {
+		CPU_SET(cpu, &cpus);
+	}
+	return ::sched_setaffinity(tid, sizeof(cpus), &cpus) == 0;
+}
+
+// =============================================================================
+// -- ThreadAffinity -----------------------------------------------------------
+// =============================================================================
+
+ThreadAffinity::ThreadAffinity(const std::string &name) :
+	_mutex(std::make_unique<Mutex>()),
+	_name(name),
+	_tid(0),
+	_realTimePriority(0) {}
+
+ThreadAffinity::~ThreadAffinity() {}
+
+void ThreadAffinity::attachThisThread() {
+	MutexLock lock(*_mutex);
+	_tid = static_cast<pid_t>(::syscall(SYS_gettid));
+	apply_L();
+}
+
+void ThreadAffinity::setAffinity(const CPUSet &cpus) {
+	MutexLock lock(*_mutex);
+	_affinity = cpus;
+	apply_L();
+}
+
+CPUSet ThreadAffinity::getAffinity() const {
+	const pid_t tid = _tid;
+	return (tid == 0) ? CPUSet() : CPUSet::fromThread(tid);
+}
+
+int ThreadAffinity::getLastCPU() const {
+	const pid_t tid = _tid;
+	return (tid == 0) ? -1 : CPUSet::getLastCPUOfThread(tid);
+}
+
+bool ThreadAffinity::setRealTimePriority(const int priority) {
+	MutexLock lock(*_mutex);
+	const bool wasRealTime = _realTimePriority > 0;
+	_realTimePriority = (priority < 0) ? 0 : ((priority > 99) ? 99 : priority);
+	// Only go back to the normal policy when this thread was real-time
+	if (_realTimePriority == 0 && wasRealTime && _tid != 0) {
+		sched_param param{};
+		return ::sched_setscheduler(_tid, SCHED_OTHER, &param) == 0;
+	}
+	return apply_L();
+}
+
+int ThreadAffinity::getRealTimePriority() const {
+	MutexLock lock(*_mutex);
+	return _realTimePriority;
+}
+
+bool ThreadAffinity::apply_L() {
+	const pid_t tid = _tid;
+	if (tid == 0) {
+		// Not running, it is applied when started
+		return true;
+	}
+	bool applied = true;
+	const CPUSet cpus = _affinity.empty() ? CPUSet::getOnline() : _affinity;
+	if (!cpus.applyToThread(tid)) {
+		SI_LOG_PERROR("@#1: Unable to set CPU affinity to @#2", _name, cpus.toString());
+		applied = false;
+	}
+	if (_realTimePriority > 0) {
+		sched_param param{};
+		param.sched_priority = _realTimePriority;
+		if (::sched_setscheduler(tid, SCHED_FIFO, &param) != 0) {
+			SI_LOG_PERROR("@#1: Unable to set SCHED_FIFO priority @#2", _name, _realTimePriority);
+			applied = false;
+		}
+	}
+	return applied;
+}
+
+}
@@ -0,0 +1,193 @@
+/* CPUSet.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#ifndef BASE_CPU_SET_H_INCLUDE
+#define BASE_CPU_SET_H_INCLUDE BASE_CPU_SET_H_INCLUDE
+
+#include <FwDecl.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+FW_DECL_UP_NS1(base, Mutex);
+
+namespace base {
+
+/// The class @c CPUSet is a sorted set of CPU numbers, that can be parsed from
+/// and converted to a CPU list like "0-3,6" as used by taskset and sysfs.
+/// It is used to set and get the CPU affinity of a thread by its thread ID.
+class CPUSet {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		CPUSet() = default;
+
+		virtual ~CPUSet() = default;
+
+		// =====================================================================
+		// -- Static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Parse a CPU list like "0-3,6", invalid entries are ignored
+		static CPUSet fromString(const std::string &list);
+
+		/// Get the CPUs that are online
+		static CPUSet getOnline();
+
+		/// Get the CPUs of each NUMA node, or one node with all online CPUs
+		/// when the system does not have NUMA information
+		static std::vector<CPUSet> getNUMANodes();
+
+		/// Get the CPU affinity of thread @p tid
+		static CPUSet fromThread(pid_t tid);
+
+		/// Get the CPU thread @p tid did run on lately, or -1 on error
+		static int getLastCPUOfThread(pid_t tid);
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Add @p cpu to this set
+		void add(int cpu);
+
+		/// Check if @p cpu is in this set
+		bool contains(int cpu) const;
+
+		/// Check if this set has no CPUs
+		bool empty() const {
+			return _cpus.empty();
+		}
+
+		/// Get the number of CPUs in this set
+		std::size_t size() const {
+			return _cpus.size();
+		}
+
+		/// Get the @p n th CPU of this set
+		int operator[](std::size_t n) const {
+			return _cpus[n];
+		}
+
+		/// Get the CPUs that are in this and the @p other set
+		CPUSet intersect(const CPUSet &other) const;
+
+		/// Get the CPUs that are in this set but not in the @p other set
+		CPUSet subtract(const CPUSet &other) const;
+
+		/// Convert this set to a CPU list like "0-3,6"
+		std::string toString() const;
+
+		/// Set the CPU affinity of thread @p tid to this set
+		/// @return true if the affinity was set
+		bool applyToThread(pid_t tid) const;
+
+		bool operator==(const CPUSet &other) const {
+			return _cpus == other._cpus;
+		}
+
+		bool operator!=(const CPUSet &other) const {
+			return _cpus != other._cpus;
+		}
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		std::vector<int> _cpus;
+};
+
+/// The class @c ThreadAffinity keeps the CPU affinity and real-time priority
+/// of one thread, so it can be set before the thread is started and is
+/// applied when it runs. It is used by @c Thread and @c ThreadBase.
+class ThreadAffinity {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		/// @param name specifies the thread name used for logging
+		explicit ThreadAffinity(const std::string &name);
+
+		virtual ~ThreadAffinity();
+
+		ThreadAffinity(const ThreadAffinity&) = delete;
+
+		ThreadAffinity& operator=(const ThreadAffinity&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Call this from the thread when it starts running, the affinity and
+		/// real-time priority are applied to it
+		void attachThisThread();
+
+		/// Call this when the thread is not running anymore
+		void detach() noexcept {
+			_tid = 0;
+		}
+
+		/// @see Thread::setAffinity
+		void setAffinity(const CPUSet &cpus);
+
+		/// @see Thread::getAffinity
+		CPUSet getAffinity() const;
+
+		/// @see Thread::getLastCPU
+		int getLastCPU() const;
+
+		/// @see Thread::setRealTimePriority
+		bool setRealTimePriority(int priority);
+
+		/// @see Thread::getRealTimePriority
+		int getRealTimePriority() const;
+
+	private:
+
+		/// Apply the affinity and real-time priority to the running thread
+		bool apply_L();
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		/// Mutex.h needs Thread.h, so it is kept by pointer here
+		UpMutex _mutex;
+		std::string _name;
+		std::atomic<pid_t> _tid;
+		CPUSet _affinity;
+		int _realTimePriority;
+};
+
+}
+
+#endif // BASE_CPU_SET_H_INCLUDE
@@ -0,0 +1,101 @@
+/* LatencyHistogram.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <base/LatencyHistogram.h>
+
+namespace base {
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+LatencyHistogram::LatencyHistogram() noexcept :
+	_count(0),
+	_sum(0),
+	_max(0) {
+	for (std::atomic<uint32_t> &bucket : _buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+// =============================================================================
+// -- Static member functions --------------------------------------------------
+// =============================================================================
+
+std::size_t LatencyHistogram::getIndex(const uint64_t ns) noexcept {
+	if (ns < SUB_BUCKETS) {
+		return ns;
+	}
+	const std::size_t bit = 63 - __builtin_clzll(ns);
+	if (bit > HIGHEST_BIT) {
+		return BUCKETS - 1;
+	}
+	// The highest bit selects the power of two, the next SUB_BUCKET_BITS
+	// bits select the bucket within it
+	const std::size_t shift = bit - SUB_BUCKET_BITS;
+	return (shift + 1) * SUB_BUCKETS + ((ns >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::getHighestValue(const std::size_t index) noexcept {
+	if (index < SUB_BUCKETS) {
+		return index;
+	}
+	const std::size_t shift = (index / SUB_BUCKETS) - 1;
+	const uint64_t lowest = (SUB_BUCKETS + (index % SUB_BUCKETS)) << shift;
+	return lowest + (uint64_t(1) << shift) - 1;
+}
+
+// =============================================================================
+// -- Other member functions ---------------------------------------------------
+// =============================================================================
+
+void LatencyHistogram::record(const uint64_t ns) noexcept {
+	// There is one recording thread, so no read-modify-write is needed
+	std::atomic<uint32_t> &bucket = _buckets[getIndex(ns)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	_count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	_sum.store(_sum.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+	if (ns > _max.load(std::memory_order_relaxed)) {
+		_max.store(ns, std::memory_order_relaxed);
+	}
+}
+
+uint64_t LatencyHistogram::getQuantile(const double quantile) const noexcept {
+	uint64_t total = 0;
+	for (const std::atomic<uint32_t> &bucket : _buckets) {
+		total += bucket.load(std::memory_order_relaxed);
+	}
+	if (total == 0) {
+		return 0;
+	}
+	const uint64_t rank = static_cast<uint64_t>(quantile * total);
+	uint64_t seen = 0;
+	for (std::size_t i = 0; i < BUCKETS; ++i) {
+		seen += _buckets[i].load(std::memory_order_relaxed);
+		if (seen > rank) {
+			// Do not report more then what was really seen
+			const uint64_t value = getHighestValue(i);
+			const uint64_t max = getMax();
+			return (value < max) ? value : max;
+		}
+	}
+	return getMax();
+}
+
+} // namespace base
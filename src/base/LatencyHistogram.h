@@ -0,0 +1,118 @@
+/* LatencyHistogram.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#ifndef BASE_LATENCY_HISTOGRAM_H_INCLUDE
+#define BASE_LATENCY_HISTOGRAM_H_INCLUDE BASE_LATENCY_HISTOGRAM_H_INCLUDE
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace base {
+
+/// The class @c LatencyHistogram records durations in nanoseconds in
+/// log-linear (HDR style) buckets. Every power of two is split into
+/// SUB_BUCKETS buckets, so a value is kept with a precision of about 6%.
+/// There should be one recording thread, reading is possible from any
+/// thread without locking.
+class LatencyHistogram {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		LatencyHistogram() noexcept;
+
+		virtual ~LatencyHistogram() = default;
+
+		LatencyHistogram(const LatencyHistogram&) = delete;
+
+		LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+		// =====================================================================
+		// -- Static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get the current time in nanoseconds, use it for a begin and end
+		/// of a duration to record
+		static uint64_t now() noexcept {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Record the duration @p ns in nanoseconds
+		void record(uint64_t ns) noexcept;
+
+		/// Get the amount of recorded durations
+		uint64_t getCount() const noexcept {
+			return _count.load(std::memory_order_relaxed);
+		}
+
+		/// Get the sum of all recorded durations in nanoseconds
+		uint64_t getSum() const noexcept {
+			return _sum.load(std::memory_order_relaxed);
+		}
+
+		/// Get the longest recorded duration in nanoseconds
+		uint64_t getMax() const noexcept {
+			return _max.load(std::memory_order_relaxed);
+		}
+
+		/// Get the duration in nanoseconds below which the fraction
+		/// @p quantile (0.0 - 1.0) of the recorded durations are
+		uint64_t getQuantile(double quantile) const noexcept;
+
+	private:
+
+		/// Get the bucket index of @p ns
+		static std::size_t getIndex(uint64_t ns) noexcept;
+
+		/// Get the highest value that is kept in bucket @p index
+		static uint64_t getHighestValue(std::size_t index) noexcept;
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		static constexpr std::size_t SUB_BUCKET_BITS = 4;
+		static constexpr std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+		/// Durations from 2^HIGHEST_BIT ns (about 9 minutes) go in the last bucket
+		static constexpr std::size_t HIGHEST_BIT = 39;
+		static constexpr std::size_t BUCKETS =
+			(HIGHEST_BIT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+		std::array<std::atomic<uint32_t>, BUCKETS> _buckets;
+		std::atomic<uint64_t> _count;
+		std::atomic<uint64_t> _sum;
+		std::atomic<uint64_t> _max;
+
+};
+
+} // namespace base
+
+#endif // BASE_LATENCY_HISTOGRAM_H_INCLUDE
@@ -0,0 +1,117 @@
+/* Metrics.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <base/Metrics.h>
+
+#include <cstdio>
+
+namespace base {
+
+// =============================================================================
+// -- Static member functions --------------------------------------------------
+// =============================================================================
+
+std::string Metrics::makeLabel(const std::string &name, const std::string &value) {
+	std::string label = name;
+	label += "=\"";
+	for (const char c : value) {
+		if (c == '\\' || c == '"') {
+			label += '\\';
+			label += c;
+		} else if (c == '\n') {
+			label += "\\n";
+		} else {
+			label += c;
+		}
+	}
+	label += '"';
+	return label;
+}
+
+std::string Metrics::formatValue(const double value) {
+	char str[32];
+	std::snprintf(str, sizeof(str), "%.9g", value);
+	return str;
+}
+
+// =============================================================================
+// -- Other member functions ---------------------------------------------------
+// =============================================================================
+
+void Metrics::addSummary(const std::string &name, const std::string &help,
+		const std::string &labels, const QuantileVector &quantiles,
+		const double sum, const uint64_t count) {
+	const std::string separator = labels.empty() ? "" : ",";
+	for (const auto &[quantile, value] : quantiles) {
+		addSample(name, name, Type::SUMMARY, help,
+			labels + separator + makeLabel("quantile", formatValue(quantile)), formatValue(value));
+	}
+	addSample(name, name + "_sum", Type::SUMMARY, help, labels, formatValue(sum));
+	addSample(name, name + "_count", Type::SUMMARY, help, labels, std::to_string(count));
+}
+
+void Metrics::addSample(const std::string &name, const std::string &sampleName,
+		const Type type, const std::string &help,
+		const std::string &labels, const std::string &value) {
+	Family *family = nullptr;
+	for (Family &f : _families) {
+		if (f.name == name) {
+			family = &f;
+			break;
+		}
+	}
+	if (family == nullptr) {
+		family = &_families.emplace_back(Family{name, type, help, ""});
+	}
+	family->samples += sampleName;
+	if (!labels.empty()) {
+		family->samples += '{';
+		family->samples += labels;
+		family->samples += '}';
+	}
+	family->samples += ' ';
+	family->samples += value;
+	family->samples += '\n';
+}
+
+std::string Metrics::toText() const {
+	std::string text;
+	for (const Family &family : _families) {
+		text += "# HELP " + family.name + " " + family.help + "\n";
+		text += "# TYPE " + family.name + " ";
+		switch (family.type) {
+			case Type::COUNTER:
+				text += "counter\n";
+				break;
+			case Type::GAUGE:
+				text += "gauge\n";
+				break;
+			case Type::SUMMARY:
+				text += "summary\n";
+				break;
+			default:
+				text += "untyped\n";
+				break;
+		}
+		text += family.samples;
+	}
+	return text;
+}
+
+} // namespace base
@@ -0,0 +1,133 @@
+/* Metrics.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#ifndef BASE_METRICS_H_INCLUDE
+#define BASE_METRICS_H_INCLUDE BASE_METRICS_H_INCLUDE
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace base {
+
+/// The class @c Metrics collects samples and formats them in the Prometheus
+/// text exposition format. The samples of one metric (family) are grouped
+/// together, so the HELP and TYPE lines are only written once.
+class Metrics {
+		// =====================================================================
+		// -- Defines ----------------------------------------------------------
+		// =====================================================================
+	public:
+
+		enum class Type {
+			COUNTER,
+			GAUGE,
+			SUMMARY
+		};
+
+		/// Pairs of quantile (0.0 - 1.0) and value for @see addSummary
+		using QuantileVector = std::vector<std::pair<double, double>>;
+
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		Metrics() = default;
+
+		virtual ~Metrics() = default;
+
+		// =====================================================================
+		// -- Static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Make the label @p name with @p value, the value is escaped
+		static std::string makeLabel(const std::string &name, const std::string &value);
+
+		/// Make the label @p name with the number @p value
+		template <typename Value, typename = std::enable_if_t<std::is_arithmetic_v<Value>>>
+		static std::string makeLabel(const std::string &name, const Value value) {
+			return makeLabel(name, std::to_string(value));
+		}
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Add a sample to the metric @p name
+		/// @param name specifies the metric name, like satpi_stream_bytes_received_total
+		/// @param type specifies if it is a counter or gauge
+		/// @param help specifies the description of this metric
+		/// @param labels specifies the comma separated labels @see makeLabel
+		/// @param value specifies the value of this sample
+		template <typename Value>
+		void add(const std::string &name, Type type, const std::string &help,
+				const std::string &labels, const Value &value) {
+			if constexpr (std::is_floating_point_v<Value>) {
+				addSample(name, name, type, help, labels, formatValue(value));
+			} else {
+				addSample(name, name, type, help, labels, std::to_string(value));
+			}
+		}
+
+		/// Add a summary to the metric @p name, this adds the quantiles
+		/// and the _sum and _count samples
+		/// @param quantiles specifies the quantiles with their value
+		/// @param sum specifies the sum of all observed values
+		/// @param count specifies the amount of observed values
+		void addSummary(const std::string &name, const std::string &help,
+				const std::string &labels, const QuantileVector &quantiles,
+				double sum, uint64_t count);
+
+		/// Get the collected metrics in the text exposition format
+		std::string toText() const;
+
+	private:
+
+		/// Add the sample @p sampleName to the metric (family) @p name
+		void addSample(const std::string &name, const std::string &sampleName,
+				Type type, const std::string &help,
+				const std::string &labels, const std::string &value);
+
+		/// Format a floating point value without losing small values
+		static std::string formatValue(double value);
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		struct Family {
+			std::string name;
+			Type type;
+			std::string help;
+			std::string samples;
+		};
+
+		std::vector<Family> _families;
+
+};
+
+} // namespace base
+
+#endif // BASE_METRICS_H_INCLUDE
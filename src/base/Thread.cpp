@@ -20,7 +20,6 @@
 #include <base/Thread.h>
 
 #include <Log.h>
-#include <Unused.h>
 
 #include <chrono>
 #include <thread>
@@ -46,7 +45,8 @@ namespace base {
 		_state(State::Unknown),
 		_thread(0),
 		_name(name),
-		_threadExecuteFunction(threadExecuteFunction) {}
+		_threadExecuteFunction(threadExecuteFunction),
+		_affinity(name) {}
 
 	// =========================================================================
 	// -- Other member functions -----------------------------------------------
@@ -100,6 +100,7 @@ namespace base {
 			return;
 		}
 		pthread_cancel(_thread);
+		_affinity.detach();
 		_state = State::Unknown;
 	}
 
@@ -110,16 +111,6 @@ namespace base {
 		(void) pthread_join(_thread, nullptr);
 	}
 
-	void Thread::setAffinity(int UNUSED(cpu)) {
-//		if (cpu > 0 && cpu < getNumberOfProcessorsOnline()) {
-//			cpu_set_t cpus;
-//			CPU_ZERO(&cpus);
-//			CPU_SET(cpu, &cpus);
-////			pthread_setaffinity_np(_thread, sizeof(cpu_set_t), &cpus);
-//			sched_setaffinity(_thread, sizeof(cpu_set_t), &cpus);
-//		}
-	}
-
 	int Thread::getScheduledAffinity() const {
 		return sched_getcpu();
 	}
@@ -165,6 +156,7 @@ namespace base {
 #else
 		prctl(PR_SET_NAME, _name.data(), 0, 0, 0);
 #endif
+		_affinity.attachThisThread();
 		try {
 			for (;;) {
 				switch (_state) {
@@ -187,6 +179,7 @@ namespace base {
 						_state = State::Stopped;
 						break;
 					case State::Stopped:
+						_affinity.detach();
 						return;
 					default:
 						break;
@@ -194,6 +187,7 @@ namespace base {
 			}
 		} catch (...) {
 			SI_LOG_ERROR("@#1: Catched an exception", _name);
+			_affinity.detach();
 			_state = State::Stopped;
 			throw;
 		}
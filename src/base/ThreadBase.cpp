@@ -43,7 +43,8 @@ namespace base {
 		_thread(0u),
 		_run(false),
 		_exit(false),
-		_name(name) {}
+		_name(name),
+		_affinity(name) {}
 
 	ThreadBase::~ThreadBase() {}
 
@@ -85,6 +86,7 @@ namespace base {
 
 	void ThreadBase::cancelThread() {
 		pthread_cancel(_thread);
+		_affinity.detach();
 		_exit = true;
 	}
 
@@ -92,16 +94,6 @@ namespace base {
 		(void) pthread_join(_thread, nullptr);
 	}
 
-	void ThreadBase::setAffinity(int cpu) {
-		if (cpu > 0 && cpu < getNumberOfProcessorsOnline()) {
-			cpu_set_t cpus;
-			CPU_ZERO(&cpus);
-			CPU_SET(cpu, &cpus);
-//			pthread_setaffinity_np(_thread, sizeof(cpu_set_t), &cpus);
-			sched_setaffinity(_thread, sizeof(cpu_set_t), &cpus);
-		}
-	}
-
 	int ThreadBase::getScheduledAffinity() const {
 		return sched_getcpu();
 	}
@@ -147,11 +139,14 @@ namespace base {
 #else
 		prctl(PR_SET_NAME, _name.data(), 0, 0, 0);
 #endif
+		_affinity.attachThisThread();
 		try {
 			threadEntry();
+			_affinity.detach();
 			_exit = true;
 		} catch (...) {
 			SI_LOG_ERROR("@#1: Catched an exception", _name);
+			_affinity.detach();
 			_exit = true;
 			throw;
 		}
@@ -20,6 +20,8 @@
 #ifndef BASE_THREADBASE_H_INCLUDE
 #define BASE_THREADBASE_H_INCLUDE BASE_THREADBASE_H_INCLUDE
 
+#include <base/CPUSet.h>
+
 #include <pthread.h>
 #include <string>
 #include <atomic>
@@ -92,9 +94,34 @@ namespace base {
 			/// Will not return until the internal thread has exited.
 			void joinThread();
 
-			/// This will set the threads affinity (which CPU is used).
-			/// @param cpu Set threads affinity with this CPU.
-			void setAffinity(int cpu);
+			/// Set the CPUs this thread may run on, an empty set allows all online
+			/// CPUs. It is applied now when running, or else when started
+			void setAffinity(const CPUSet &cpus) {
+				_affinity.setAffinity(cpus);
+			}
+
+			/// Get the CPUs this thread may run on, empty when not running
+			CPUSet getAffinity() const {
+				return _affinity.getAffinity();
+			}
+
+			/// Get the CPU this thread did run on lately, -1 when not running
+			int getLastCPU() const {
+				return _affinity.getLastCPU();
+			}
+
+			/// Use the real-time SCHED_FIFO policy with @p priority (1 - 99), or
+			/// the normal policy with 0. It is applied now when running, or else
+			/// when started
+			/// @return false if it could not be applied (needs CAP_SYS_NICE)
+			bool setRealTimePriority(int priority) {
+				return _affinity.setRealTimePriority(priority);
+			}
+
+			/// Get the real-time priority, 0 means the normal policy
+			int getRealTimePriority() const {
+				return _affinity.getRealTimePriority();
+			}
 
 			/// This will get the scheduled affinity of this thread.
 			/// @return @c returns the affinity of this thread.
@@ -123,6 +150,7 @@ namespace base {
 			std::atomic_bool _run;
 			std::atomic_bool _exit;
 			std::string      _name;
+			ThreadAffinity   _affinity;
 	};
 
 } // namespace base
@@ -0,0 +1,216 @@
+/* ThreadPlacement.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <base/ThreadPlacement.h>
+
+#include <Log.h>
+#include <StringConverter.h>
+#include <Utils.h>
+#include <base/Thread.h>
+#include <base/ThreadBase.h>
+
+namespace base {
+
+// =============================================================================
+// -- Static const data --------------------------------------------------------
+// =============================================================================
+
+static constexpr int MAX_REAL_TIME_PRIORITY = 99;
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+ThreadPlacement::ThreadPlacement() :
+	_online(CPUSet::getOnline()),
+	_nodes(CPUSet::getNUMANodes()),
+	_streamPolicy(StreamPolicy::None),
+	_readerRealTimePriority(0) {}
+
+// =============================================================================
+//  -- base::XMLSupport --------------------------------------------------------
+// =============================================================================
+
+void ThreadPlacement::doAddToXML(std::string &xml) const {
+	base::MutexLock lock(_mutex);
+	ADD_XML_BEGIN_ELEMENT(xml, "streamPolicy");
+		ADD_XML_ELEMENT(xml, "inputtype", "selectionlist");
+		ADD_XML_ELEMENT(xml, "value", asInteger(_streamPolicy));
+		ADD_XML_BEGIN_ELEMENT(xml, "list");
+		ADD_XML_ELEMENT(xml, "option0", "None");
+		ADD_XML_ELEMENT(xml, "option1", "Data CPUs");
+		ADD_XML_ELEMENT(xml, "option2", "Pin per Frontend");
+		ADD_XML_ELEMENT(xml, "option3", "Per NUMA Node");
+		ADD_XML_END_ELEMENT(xml, "list");
+	ADD_XML_END_ELEMENT(xml, "streamPolicy");
+	ADD_XML_TEXT_INPUT(xml, "dataCPUs", _dataCPUs.toString());
+	ADD_XML_TEXT_INPUT(xml, "decryptCPUs", _decryptCPUs.toString());
+	ADD_XML_TEXT_INPUT(xml, "housekeepingCPUs", _housekeepingCPUs.toString());
+	ADD_XML_NUMBER_INPUT(xml, "readerRealTimePriority", _readerRealTimePriority, 0, MAX_REAL_TIME_PRIORITY);
+	ADD_XML_ELEMENT(xml, "cpusOnline", _online.toString());
+	std::string nodes;
+	for (const CPUSet &node : _nodes) {
+		nodes += (nodes.empty() ? "" : " | ") + node.toString();
+	}
+	ADD_XML_ELEMENT(xml, "numaNodes", nodes);
+}
+
+void ThreadPlacement::doFromXML(const std::string &xml) {
+	base::MutexLock lock(_mutex);
+	std::string element;
+	if (findXMLElement(xml, "streamPolicy.value", element)) {
+		const int policy = std::stoi(element);
+		_streamPolicy = (policy >= asInteger(StreamPolicy::None) && policy <= asInteger(StreamPolicy::PerNUMANode)) ?
+			static_cast<StreamPolicy>(policy) : StreamPolicy::None;
+	}
+	if (findXMLElement(xml, "dataCPUs.value", element)) {
+		_dataCPUs = CPUSet::fromString(element);
+	}
+	if (findXMLElement(xml, "decryptCPUs.value", element)) {
+		_decryptCPUs = CPUSet::fromString(element);
+	}
+	if (findXMLElement(xml, "housekeepingCPUs.value", element)) {
+		_housekeepingCPUs = CPUSet::fromString(element);
+	}
+	if (findXMLElement(xml, "readerRealTimePriority.value", element)) {
+		const int priority = std::stoi(element);
+		_readerRealTimePriority = (priority < 0) ? 0 :
+			((priority < MAX_REAL_TIME_PRIORITY) ? priority : MAX_REAL_TIME_PRIORITY);
+	}
+}
+
+// =============================================================================
+//  -- Static member functions -------------------------------------------------
+// =============================================================================
+
+std::string ThreadPlacement::getPlacementString(const Thread &thread) {
+	const int cpu = thread.getLastCPU();
+	if (cpu == -1) {
+		return "Not running";
+	}
+	const int priority = thread.getRealTimePriority();
+	return StringConverter::stringFormat("CPUs @#1 (on CPU @#2)@#3",
+		thread.getAffinity().toString(), cpu,
+		(priority > 0) ? StringConverter::stringFormat(" SCHED_FIFO @#1", priority) : "");
+}
+
+std::string ThreadPlacement::getPlacementString(const ThreadBase &thread) {
+	const int cpu = thread.getLastCPU();
+	if (cpu == -1) {
+		return "Not running";
+	}
+	return StringConverter::stringFormat("CPUs @#1 (on CPU @#2)",
+		thread.getAffinity().toString(), cpu);
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void ThreadPlacement::placeStreamThreads(const std::size_t index,
+		Thread &reader, Thread &writer) const {
+	base::MutexLock lock(_mutex);
+	// An empty set allows all online CPUs
+	CPUSet readerCPUs;
+	CPUSet writerCPUs;
+	switch (_streamPolicy) {
+		case StreamPolicy::DataCPUs:
+			readerCPUs = getOrOnline_L(_dataCPUs);
+			writerCPUs = readerCPUs;
+			break;
+		case StreamPolicy::PerFrontend: {
+			// Take the next two data CPUs, these are ordered by NUMA node
+			// so the reader and writer will mostly share the same node
+			std::vector<int> cpus;
+			for (const CPUSet &node : getDataNodes_L()) {
+				for (std::size_t i = 0; i < node.size(); ++i) {
+					cpus.push_back(node[i]);
+				}
+			}
+			readerCPUs.add(cpus[(2 * index) % cpus.size()]);
+			writerCPUs.add(cpus[(2 * index + 1) % cpus.size()]);
+			break;
+		}
+		case StreamPolicy::PerNUMANode: {
+			const std::vector<CPUSet> nodes = getDataNodes_L();
+			readerCPUs = nodes[index % nodes.size()];
+			writerCPUs = readerCPUs;
+			break;
+		}
+		case StreamPolicy::None:
+		default:
+			break;
+	}
+	reader.setAffinity(readerCPUs);
+	writer.setAffinity(writerCPUs);
+	reader.setRealTimePriority(_readerRealTimePriority);
+}
+
+void ThreadPlacement::placeDecryptThread(ThreadBase &thread) const {
+	base::MutexLock lock(_mutex);
+	thread.setAffinity(_decryptCPUs.empty() ? CPUSet() : getOrOnline_L(_decryptCPUs));
+}
+
+void ThreadPlacement::placeDecryptThread(Thread &thread) const {
+	base::MutexLock lock(_mutex);
+	thread.setAffinity(_decryptCPUs.empty() ? CPUSet() : getOrOnline_L(_decryptCPUs));
+}
+
+void ThreadPlacement::placeHousekeepingThread(ThreadBase &thread) const {
+	base::MutexLock lock(_mutex);
+	thread.setAffinity(getHousekeepingCPUs_L());
+}
+
+void ThreadPlacement::placeHousekeepingThread(Thread &thread) const {
+	base::MutexLock lock(_mutex);
+	thread.setAffinity(getHousekeepingCPUs_L());
+}
+
+std::vector<CPUSet> ThreadPlacement::getDataNodes_L() const {
+	const CPUSet data = getOrOnline_L(_dataCPUs);
+	std::vector<CPUSet> nodes;
+	for (const CPUSet &node : _nodes) {
+		const CPUSet cpus = node.intersect(data);
+		if (!cpus.empty()) {
+			nodes.push_back(cpus);
+		}
+	}
+	if (nodes.empty()) {
+		nodes.push_back(data);
+	}
+	return nodes;
+}
+
+CPUSet ThreadPlacement::getOrOnline_L(const CPUSet &cpus) const {
+	const CPUSet online = cpus.intersect(_online);
+	return online.empty() ? _online : online;
+}
+
+CPUSet ThreadPlacement::getHousekeepingCPUs_L() const {
+	if (!_housekeepingCPUs.empty()) {
+		return getOrOnline_L(_housekeepingCPUs);
+	}
+	// Keep them off the data CPUs, when there are CPUs left
+	if (_streamPolicy != StreamPolicy::None && !_dataCPUs.empty()) {
+		return _online.subtract(_dataCPUs);
+	}
+	return CPUSet();
+}
+
+}
@@ -0,0 +1,141 @@
+/* ThreadPlacement.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#ifndef BASE_THREAD_PLACEMENT_H_INCLUDE
+#define BASE_THREAD_PLACEMENT_H_INCLUDE BASE_THREAD_PLACEMENT_H_INCLUDE
+
+#include <FwDecl.h>
+#include <base/CPUSet.h>
+#include <base/Mutex.h>
+#include <base/XMLSupport.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+FW_DECL_NS1(base, Thread);
+FW_DECL_NS1(base, ThreadBase);
+FW_DECL_SP_NS1(base, ThreadPlacement);
+
+namespace base {
+
+/// The class @c ThreadPlacement decides on which CPUs the threads may run.
+/// The reader and writer threads of the streams run on the data CPUs, where
+/// they can be pinned per frontend or per NUMA node. The decrypt threads and
+/// the housekeeping threads (servers and monitors) can be kept on their own
+/// CPUs, so they do not disturb the data path.
+class ThreadPlacement :
+	public base::XMLSupport {
+		// =====================================================================
+		// -- Defines ----------------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// How the reader and writer threads of the streams are placed
+		enum class StreamPolicy {
+			None,
+			DataCPUs,
+			PerFrontend,
+			PerNUMANode
+		};
+
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		ThreadPlacement();
+
+		virtual ~ThreadPlacement() = default;
+
+		// =====================================================================
+		// -- static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		static SpThreadPlacement makeSP() {
+			return std::make_shared<ThreadPlacement>();
+		}
+
+		// =====================================================================
+		// -- base::XMLSupport -------------------------------------------------
+		// =====================================================================
+	private:
+
+		/// @see XMLSupport
+		virtual void doAddToXML(std::string &xml) const final;
+
+		/// @see XMLSupport
+		virtual void doFromXML(const std::string &xml) final;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Place the reader and writer thread of the stream with @p index
+		void placeStreamThreads(std::size_t index, Thread &reader, Thread &writer) const;
+
+		/// Place a thread that is decrypting
+		void placeDecryptThread(ThreadBase &thread) const;
+
+		/// Place a thread that is decrypting
+		void placeDecryptThread(Thread &thread) const;
+
+		/// Place a housekeeping thread, like the servers and monitors
+		void placeHousekeepingThread(ThreadBase &thread) const;
+
+		/// Place a housekeeping thread, like the servers and monitors
+		void placeHousekeepingThread(Thread &thread) const;
+
+		/// Get the placement of @p thread as text for the web interface
+		static std::string getPlacementString(const Thread &thread);
+
+		/// Get the placement of @p thread as text for the web interface
+		static std::string getPlacementString(const ThreadBase &thread);
+
+	private:
+
+		/// Get the data CPUs ordered by NUMA node
+		std::vector<CPUSet> getDataNodes_L() const;
+
+		/// Get @p cpus or all online CPUs when it is empty
+		CPUSet getOrOnline_L(const CPUSet &cpus) const;
+
+		/// Get the housekeeping CPUs, an empty set allows all online CPUs
+		CPUSet getHousekeepingCPUs_L() const;
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		base::Mutex _mutex;
+		CPUSet _online;
+		std::vector<CPUSet> _nodes;
+		StreamPolicy _streamPolicy;
+		CPUSet _dataCPUs;
+		CPUSet _decryptCPUs;
+		CPUSet _housekeepingCPUs;
+		int _readerRealTimePriority;
+};
+
+}
+
+#endif // BASE_THREAD_PLACEMENT_H_INCLUDE
@@ -0,0 +1,337 @@
+/* CISSA.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <decrypt/descrambler/CISSA.h>
+
+#include <Unused.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#define CISSA_HAS_AESNI
+	#include <immintrin.h>
+#endif
+
+namespace decrypt::descrambler {
+
+namespace {
+
+/// The IV of DVB-CISSA, when the CA system does not give one
+constexpr unsigned char CISSA_IV[16] = {
+	'D', 'V', 'B', 'T', 'M', 'C', 'P', 'T', 'A', 'E', 'S', 'C', 'I', 'S', 'S', 'A'
+};
+
+constexpr std::size_t BLOCK_SIZE = 16;
+constexpr std::size_t ROUNDS = 10;
+
+// =============================================================================
+//  -- Portable AES-128 --------------------------------------------------------
+// =============================================================================
+
+uint8_t gmul(uint8_t a, uint8_t b) noexcept {
+	uint8_t p = 0;
+	while (b != 0) {
+		if (b & 1) {
+			p ^= a;
+		}
+		a = (a << 1) ^ ((a & 0x80) ? 0x1B : 0x00);
+		b >>= 1;
+	}
+	return p;
+}
+
+uint32_t ror32(const uint32_t v, const unsigned int n) noexcept {
+	return (v >> n) | (v << (32 - n));
+}
+
+uint32_t loadBE32(const unsigned char *p) noexcept {
+	return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+void storeBE32(unsigned char *p, const uint32_t v) noexcept {
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >>  8;
+	p[3] = v;
+}
+
+/// The S-boxes and the decrypt table, they are calculated instead of
+/// written out
+struct Tables {
+	uint8_t sbox[256];
+	uint8_t invSbox[256];
+	/// InvSubBytes followed by InvMixColumns of one byte
+	uint32_t td[256];
+
+	Tables() {
+		for (unsigned int x = 0; x < 256; ++x) {
+			// multiplicative inverse, followed by the affine transformation
+			uint8_t inv = 0;
+			for (unsigned int y = 1; y < 256 && x != 0; ++y) {
+				if (gmul(x, y) == 1) {
+					inv = y;
+					break;
+				}
+			}
+			uint8_t s = inv;
+			for (unsigned int r = 1; r < 5; ++r) {
+				s ^= (inv << r) | (inv >> (8 - r));
+			}
+			s ^= 0x63;
+			sbox[x] = s;
+			invSbox[s] = x;
+		}
+		for (unsigned int x = 0; x < 256; ++x) {
+			const uint8_t s = invSbox[x];
+			td[x] = (uint32_t(gmul(s, 0x0E)) << 24) | (uint32_t(gmul(s, 0x09)) << 16) |
+			        (uint32_t(gmul(s, 0x0D)) <<  8) |  uint32_t(gmul(s, 0x0B));
+		}
+	}
+};
+
+const Tables &getTables() {
+	static const Tables tables;
+	return tables;
+}
+
+/// Apply InvMixColumns to one column
+uint32_t invMixColumn(const uint32_t c) noexcept {
+	const uint8_t a0 = c >> 24;
+	const uint8_t a1 = c >> 16;
+	const uint8_t a2 = c >>  8;
+	const uint8_t a3 = c;
+	return (uint32_t(gmul(a0, 0x0E) ^ gmul(a1, 0x0B) ^ gmul(a2, 0x0D) ^ gmul(a3, 0x09)) << 24) |
+	       (uint32_t(gmul(a0, 0x09) ^ gmul(a1, 0x0E) ^ gmul(a2, 0x0B) ^ gmul(a3, 0x0D)) << 16) |
+	       (uint32_t(gmul(a0, 0x0D) ^ gmul(a1, 0x09) ^ gmul(a2, 0x0E) ^ gmul(a3, 0x0B)) <<  8) |
+	        uint32_t(gmul(a0, 0x0B) ^ gmul(a1, 0x0D) ^ gmul(a2, 0x09) ^ gmul(a3, 0x0E));
+}
+
+/// Decrypt one block with the round keys of the 'equivalent inverse cipher'
+void decryptBlock(const Tables &t, const uint32_t *rk,
+		const unsigned char *in, unsigned char *out) noexcept {
+	uint32_t s0 = loadBE32(in +  0) ^ rk[0];
+	uint32_t s1 = loadBE32(in +  4) ^ rk[1];
+	uint32_t s2 = loadBE32(in +  8) ^ rk[2];
+	uint32_t s3 = loadBE32(in + 12) ^ rk[3];
+	for (std::size_t r = 1; r < ROUNDS; ++r) {
+		rk += 4;
+		const uint32_t t0 = t.td[s0 >> 24] ^ ror32(t.td[(s3 >> 16) & 0xFF], 8) ^
+			ror32(t.td[(s2 >> 8) & 0xFF], 16) ^ ror32(t.td[s1 & 0xFF], 24) ^ rk[0];
+		const uint32_t t1 = t.td[s1 >> 24] ^ ror32(t.td[(s0 >> 16) & 0xFF], 8) ^
+			ror32(t.td[(s3 >> 8) & 0xFF], 16) ^ ror32(t.td[s2 & 0xFF], 24) ^ rk[1];
+		const uint32_t t2 = t.td[s2 >> 24] ^ ror32(t.td[(s1 >> 16) & 0xFF], 8) ^
+			ror32(t.td[(s0 >> 8) & 0xFF], 16) ^ ror32(t.td[s3 & 0xFF], 24) ^ rk[2];
+		const uint32_t t3 = t.td[s3 >> 24] ^ ror32(t.td[(s2 >> 16) & 0xFF], 8) ^
+			ror32(t.td[(s1 >> 8) & 0xFF], 16) ^ ror32(t.td[s0 & 0xFF], 24) ^ rk[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
+	rk += 4;
+	const uint8_t *is = t.invSbox;
+	storeBE32(out +  0, ((uint32_t(is[s0 >> 24]) << 24) | (uint32_t(is[(s3 >> 16) & 0xFF]) << 16) |
+		(uint32_t(is[(s2 >> 8) & 0xFF]) << 8) | is[s1 & 0xFF]) ^ rk[0]);
+	storeBE32(out +  4, ((uint32_t(is[s1 >> 24]) << 24) | (uint32_t(is[(s0 >> 16) & 0xFF]) << 16) |
+		(uint32_t(is[(s3 >> 8) & 0xFF]) << 8) | is[s2 & 0xFF]) ^ rk[1]);
+	storeBE32(out +  8, ((uint32_t(is[s2 >> 24]) << 24) | (uint32_t(is[(s1 >> 16) & 0xFF]) << 16) |
+		(uint32_t(is[(s0 >> 8) & 0xFF]) << 8) | is[s3 & 0xFF]) ^ rk[2]);
+	storeBE32(out + 12, ((uint32_t(is[s3 >> 24]) << 24) | (uint32_t(is[(s2 >> 16) & 0xFF]) << 16) |
+		(uint32_t(is[(s1 >> 8) & 0xFF]) << 8) | is[s0 & 0xFF]) ^ rk[3]);
+}
+
+/// CBC decrypt @p blocks blocks of @p data in place
+void decryptCBC(const uint32_t *rk, const unsigned char *iv,
+		unsigned char *data, const std::size_t blocks) noexcept {
+	const Tables &t = getTables();
+	unsigned char prev[BLOCK_SIZE];
+	unsigned char cipher[BLOCK_SIZE];
+	std::memcpy(prev, iv, BLOCK_SIZE);
+	for (std::size_t i = 0; i < blocks; ++i, data += BLOCK_SIZE) {
+		std::memcpy(cipher, data, BLOCK_SIZE);
+		decryptBlock(t, rk, cipher, data);
+		for (std::size_t j = 0; j < BLOCK_SIZE; ++j) {
+			data[j] ^= prev[j];
+		}
+		std::memcpy(prev, cipher, BLOCK_SIZE);
+	}
+}
+
+// =============================================================================
+//  -- AES-NI AES-128 ----------------------------------------------------------
+// =============================================================================
+
+#ifdef CISSA_HAS_AESNI
+
+/// CBC decrypt @p blocks blocks of @p data in place, the blocks of a packet
+/// do not depend on each other, so four are decrypted at the same time to
+/// fill the pipeline of the AES unit
+__attribute__((target("aes,sse2")))
+void decryptCBCAESNI(const unsigned char (*rk)[BLOCK_SIZE], const unsigned char *iv,
+		unsigned char *data, const std::size_t blocks) noexcept {
+	__m128i k[ROUNDS + 1];
+	for (std::size_t r = 0; r <= ROUNDS; ++r) {
+		k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rk[r]));
+	}
+	__m128i *p = reinterpret_cast<__m128i *>(data);
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(iv));
+	std::size_t i = 0;
+	for (; i + 4 <= blocks; i += 4) {
+		const __m128i c0 = _mm_loadu_si128(p + i + 0);
+		const __m128i c1 = _mm_loadu_si128(p + i + 1);
+		const __m128i c2 = _mm_loadu_si128(p + i + 2);
+		const __m128i c3 = _mm_loadu_si128(p + i + 3);
+		__m128i x0 = _mm_xor_si128(c0, k[0]);
+		__m128i x1 = _mm_xor_si128(c1, k[0]);
+		__m128i x2 = _mm_xor_si128(c2, k[0]);
+		__m128i x3 = _mm_xor_si128(c3, k[0]);
+		for (std::size_t r = 1; r < ROUNDS; ++r) {
+			x0 = _mm_aesdec_si128(x0, k[r]);
+			x1 = _mm_aesdec_si128(x1, k[r]);
+			x2 = _mm_aesdec_si128(x2, k[r]);
+			x3 = _mm_aesdec_si128(x3, k[r]);
+		}
+		x0 = _mm_aesdeclast_si128(x0, k[ROUNDS]);
+		x1 = _mm_aesdeclast_si128(x1, k[ROUNDS]);
+		x2 = _mm_aesdeclast_si128(x2, k[ROUNDS]);
+		x3 = _mm_aesdeclast_si128(x3, k[ROUNDS]);
+		_mm_storeu_si128(p + i + 0, _mm_xor_si128(x0, prev));
+		_mm_storeu_si128(p + i + 1, _mm_xor_si128(x1, c0));
+		_mm_storeu_si128(p + i + 2, _mm_xor_si128(x2, c1));
+		_mm_storeu_si128(p + i + 3, _mm_xor_si128(x3, c2));
+		prev = c3;
+	}
+	for (; i < blocks; ++i) {
+		const __m128i c = _mm_loadu_si128(p + i);
+		__m128i x = _mm_xor_si128(c, k[0]);
+		for (std::size_t r = 1; r < ROUNDS; ++r) {
+			x = _mm_aesdec_si128(x, k[r]);
+		}
+		x = _mm_aesdeclast_si128(x, k[ROUNDS]);
+		_mm_storeu_si128(p + i, _mm_xor_si128(x, prev));
+		prev = c;
+	}
+}
+
+#endif
+
+// =============================================================================
+//  -- CISSAKey ----------------------------------------------------------------
+// =============================================================================
+
+/// The decrypt round keys of one control word
+class CISSAKey :
+	public Key {
+	public:
+
+		CISSAKey(const unsigned char *cw, const unsigned char *iv, const bool aesni) :
+			_aesni(aesni) {
+			const Tables &t = getTables();
+			// The AES-128 key expansion
+			uint32_t w[4 * (ROUNDS + 1)];
+			for (std::size_t i = 0; i < 4; ++i) {
+				w[i] = loadBE32(cw + 4 * i);
+			}
+			uint8_t rcon = 0x01;
+			for (std::size_t i = 4; i < 4 * (ROUNDS + 1); ++i) {
+				uint32_t temp = w[i - 1];
+				if (i % 4 == 0) {
+					temp = (uint32_t(t.sbox[(temp >> 16) & 0xFF]) << 24) |
+					       (uint32_t(t.sbox[(temp >>  8) & 0xFF]) << 16) |
+					       (uint32_t(t.sbox[ temp        & 0xFF]) <<  8) |
+					        uint32_t(t.sbox[ temp >> 24        ]);
+					temp ^= uint32_t(rcon) << 24;
+					rcon = gmul(rcon, 0x02);
+				}
+				w[i] = w[i - 4] ^ temp;
+			}
+			// The round keys of the 'equivalent inverse cipher' in reverse
+			// order, this is also what AESDEC expects
+			for (std::size_t r = 0; r <= ROUNDS; ++r) {
+				for (std::size_t c = 0; c < 4; ++c) {
+					const uint32_t k = w[4 * (ROUNDS - r) + c];
+					_roundWords[4 * r + c] = (r == 0 || r == ROUNDS) ? k : invMixColumn(k);
+					storeBE32(_roundKeys[r] + 4 * c, _roundWords[4 * r + c]);
+				}
+			}
+			std::memcpy(_iv, iv, BLOCK_SIZE);
+		}
+
+		virtual void descramble(Payload *batch, const std::size_t count) const noexcept final {
+			for (std::size_t i = 0; i < count; ++i) {
+				// The residue of the payload after the last whole block is
+				// sent in the clear
+				const std::size_t blocks = batch[i].len / BLOCK_SIZE;
+#ifdef CISSA_HAS_AESNI
+				if (_aesni) {
+					decryptCBCAESNI(_roundKeys, _iv, batch[i].data, blocks);
+					continue;
+				}
+#endif
+				decryptCBC(_roundWords, _iv, batch[i].data, blocks);
+			}
+		}
+
+	private:
+
+		alignas(16) unsigned char _roundKeys[ROUNDS + 1][BLOCK_SIZE];
+		uint32_t _roundWords[4 * (ROUNDS + 1)];
+		unsigned char _iv[BLOCK_SIZE];
+		bool _aesni;
+};
+
+}
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+CISSA::CISSA() :
+	_aesni(isAESNISupported()) {}
+
+// =============================================================================
+//  -- Descrambler -------------------------------------------------------------
+// =============================================================================
+
+std::string CISSA::getName() const {
+	return _aesni ? "DVB-CISSA (AES-128 CBC, AES-NI)" : "DVB-CISSA (AES-128 CBC)";
+}
+
+SpKey CISSA::makeKey(const unsigned char *cw, const std::size_t length,
+		const unsigned char *iv, const int UNUSED(icamECM)) const {
+	if (length != getKeyLength()) {
+		return nullptr;
+	}
+	return std::make_shared<CISSAKey>(cw, (iv == nullptr) ? CISSA_IV : iv, _aesni);
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+bool CISSA::isAESNISupported() noexcept {
+#ifdef CISSA_HAS_AESNI
+	return __builtin_cpu_supports("aes");
+#else
+	return false;
+#endif
+}
+
+}
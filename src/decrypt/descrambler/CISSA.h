@@ -0,0 +1,86 @@
+/* CISSA.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef DECRYPT_DESCRAMBLER_CISSA_H_INCLUDE
+#define DECRYPT_DESCRAMBLER_CISSA_H_INCLUDE DECRYPT_DESCRAMBLER_CISSA_H_INCLUDE
+
+#include <decrypt/descrambler/Descrambler.h>
+
+namespace decrypt::descrambler {
+
+/// The class @c CISSA descrambles DVB-CISSA (ETSI TS 103 127), which is
+/// AES-128 in CBC mode over the whole 16 byte blocks of the payload with the
+/// IV reset for each TS packet, the remaining bytes are not scrambled. It
+/// uses AES-NI when the CPU has it, else a portable table implementation.
+class CISSA :
+	public Descrambler {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		CISSA();
+
+		virtual ~CISSA() = default;
+
+		// =====================================================================
+		// -- Descrambler ------------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// @see Descrambler
+		virtual std::string getName() const final;
+
+		/// @see Descrambler
+		virtual std::size_t getKeyLength() const noexcept final {
+			return 16;
+		}
+
+		/// @see Descrambler
+		virtual unsigned int getBatchSize() const noexcept final {
+			return BATCH_SIZE;
+		}
+
+		/// @see Descrambler
+		virtual SpKey makeKey(const unsigned char *cw, std::size_t length,
+				const unsigned char *iv, int icamECM) const final;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Check if the CPU has the AES instructions
+		static bool isAESNISupported() noexcept;
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		/// There is no gain in bigger batches, packets are descrambled one
+		/// by one, but it bounds the work per decrypt job
+		static constexpr unsigned int BATCH_SIZE = 64;
+
+		bool _aesni;
+};
+
+}
+
+#endif // DECRYPT_DESCRAMBLER_CISSA_H_INCLUDE
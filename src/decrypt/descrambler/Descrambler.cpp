@@ -0,0 +1,48 @@
+/* Descrambler.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <decrypt/descrambler/Descrambler.h>
+
+#include <decrypt/descrambler/CISSA.h>
+#ifdef LIBDVBCSA
+	#include <decrypt/descrambler/DvbCsa.h>
+#endif
+
+namespace decrypt::descrambler {
+
+// =============================================================================
+//  -- Static member functions -------------------------------------------------
+// =============================================================================
+
+SpDescrambler Descrambler::makeSP(const Algorithm algorithm) {
+	switch (algorithm) {
+		case Algorithm::DVBCSA:
+#ifdef LIBDVBCSA
+			return std::make_shared<DvbCsa>();
+#else
+			return nullptr;
+#endif
+		case Algorithm::CISSA:
+			return std::make_shared<CISSA>();
+		default:
+			return nullptr;
+	}
+}
+
+}
@@ -0,0 +1,133 @@
+/* Descrambler.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef DECRYPT_DESCRAMBLER_DESCRAMBLER_H_INCLUDE
+#define DECRYPT_DESCRAMBLER_DESCRAMBLER_H_INCLUDE DECRYPT_DESCRAMBLER_DESCRAMBLER_H_INCLUDE
+
+#include <FwDecl.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+FW_DECL_SP_NS2(decrypt, descrambler, Descrambler);
+FW_DECL_SP_NS2(decrypt, descrambler, Key);
+
+namespace decrypt::descrambler {
+
+/// The payload of one scrambled TS packet, it has the same layout as
+/// @c dvbcsa_bs_batch_s so a batch can be handed to libdvbcsa directly
+struct Payload {
+	unsigned char *data;
+	unsigned int len;
+};
+
+/// The class @c Key is a control word prepared (key schedule) by a
+/// @c Descrambler, it is immutable so batches may share it between threads
+class Key {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		Key() = default;
+
+		virtual ~Key() = default;
+
+		Key(const Key&) = delete;
+
+		Key& operator=(const Key&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Descramble the payloads in place
+		/// @param batch specifies the payloads, it should have room for one
+		/// extra entry after the last payload
+		/// @param count specifies the amount of payloads in @p batch
+		virtual void descramble(Payload *batch, std::size_t count) const noexcept = 0;
+};
+
+/// The class @c Descrambler is the interface to a descramble algorithm, it
+/// makes the keys that do the actual descrambling
+class Descrambler {
+		// =====================================================================
+		// -- Defines ----------------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// The algorithms that can be descrambled
+		enum class Algorithm {
+			DVBCSA,
+			CISSA
+		};
+
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		Descrambler() = default;
+
+		virtual ~Descrambler() = default;
+
+		Descrambler(const Descrambler&) = delete;
+
+		Descrambler& operator=(const Descrambler&) = delete;
+
+		// =====================================================================
+		// -- static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Make the descrambler for @p algorithm
+		/// @return nullptr if this algorithm is not build in
+		static SpDescrambler makeSP(Algorithm algorithm);
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get the name of this descrambler, also telling the implementation
+		/// that is used
+		virtual std::string getName() const = 0;
+
+		/// Get the length of the control word in bytes
+		virtual std::size_t getKeyLength() const noexcept = 0;
+
+		/// Get the amount of payloads that are descrambled together best
+		virtual unsigned int getBatchSize() const noexcept = 0;
+
+		/// Make the key for control word @p cw
+		/// @param cw specifies the control word
+		/// @param length specifies the length of @p cw
+		/// @param iv specifies the initialization vector to use, or nullptr
+		/// for the default of this algorithm
+		/// @param icamECM specifies the ICAM ECM byte or -1 if not used
+		/// @return nullptr if @p length is wrong for this algorithm
+		virtual SpKey makeKey(const unsigned char *cw, std::size_t length,
+				const unsigned char *iv, int icamECM) const = 0;
+};
+
+}
+
+#endif // DECRYPT_DESCRAMBLER_DESCRAMBLER_H_INCLUDE
@@ -0,0 +1,126 @@
+/* DvbCsa.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <decrypt/descrambler/DvbCsa.h>
+
+#include <Log.h>
+#include <Unused.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include <dlfcn.h>
+
+extern "C" {
+	#include <dvbcsa/dvbcsa.h>
+	void dvbcsa_bs_key_set_ecm(unsigned char ecm, const dvbcsa_cw_t cw, struct dvbcsa_bs_key_s *key) __attribute__((weak));
+}
+
+namespace decrypt::descrambler {
+
+static_assert(sizeof(Payload) == sizeof(dvbcsa_bs_batch_s) &&
+	offsetof(Payload, data) == offsetof(dvbcsa_bs_batch_s, data) &&
+	offsetof(Payload, len) == offsetof(dvbcsa_bs_batch_s, len),
+	"Payload should have the layout of dvbcsa_bs_batch_s");
+
+namespace {
+
+/// The key schedule of libdvbcsa
+class DvbCsaKey :
+	public Key {
+	public:
+
+		DvbCsaKey(const unsigned int batchSize) :
+			_key(dvbcsa_bs_key_alloc()),
+			_batchSize(batchSize) {}
+
+		virtual ~DvbCsaKey() {
+			dvbcsa_bs_key_free(_key);
+		}
+
+		virtual void descramble(Payload *batch, const std::size_t count) const noexcept final {
+			// libdvbcsa takes a nullptr terminated batch of at most its batch size
+			for (std::size_t i = 0; i < count; i += _batchSize) {
+				const std::size_t end = std::min<std::size_t>(i + _batchSize, count);
+				const Payload next = batch[end];
+				batch[end].data = nullptr;
+				batch[end].len  = 0;
+				dvbcsa_bs_decrypt(_key, reinterpret_cast<dvbcsa_bs_batch_s *>(batch + i), 184);
+				batch[end] = next;
+			}
+		}
+
+		dvbcsa_bs_key_s *_key;
+		const unsigned int _batchSize;
+};
+
+}
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+DvbCsa::DvbCsa() :
+	_batchSize(dvbcsa_bs_batch_size()) {}
+
+// =============================================================================
+//  -- Descrambler -------------------------------------------------------------
+// =============================================================================
+
+std::string DvbCsa::getName() const {
+	return "DVB-CSA (libdvbcsa)";
+}
+
+SpKey DvbCsa::makeKey(const unsigned char *cw, const std::size_t length,
+		const unsigned char *UNUSED(iv), const int icamECM) const {
+	if (length != getKeyLength()) {
+		return nullptr;
+	}
+	auto key = std::make_shared<DvbCsaKey>(_batchSize);
+	if (isICAMSupported() && icamECM >= 0) {
+		dvbcsa_bs_key_set_ecm(icamECM, cw, key->_key);
+	} else {
+		dvbcsa_bs_key_set(cw, key->_key);
+	}
+	return key;
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+bool DvbCsa::isICAMSupported() {
+	static const bool supported = []() {
+		bool icam = false;
+		void* handle = dlopen("libdvbcsa.so.1", RTLD_LAZY | RTLD_NODELETE);
+		if (handle != nullptr) {
+			if (dlsym(handle, "dvbcsa_bs_key_set_ecm") == nullptr) {
+				SI_LOG_INFO("ICAM support in libdvbcsa.so: No");
+			} else {
+				SI_LOG_INFO("ICAM support in libdvbcsa.so: Yes");
+				icam = true;
+			}
+			dlclose(handle);
+		}
+		return icam;
+	}();
+	return supported;
+}
+
+}
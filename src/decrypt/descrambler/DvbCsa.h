@@ -0,0 +1,81 @@
+/* DvbCsa.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef DECRYPT_DESCRAMBLER_DVBCSA_H_INCLUDE
+#define DECRYPT_DESCRAMBLER_DVBCSA_H_INCLUDE DECRYPT_DESCRAMBLER_DVBCSA_H_INCLUDE
+
+#include <decrypt/descrambler/Descrambler.h>
+
+namespace decrypt::descrambler {
+
+/// The class @c DvbCsa descrambles DVB-CSA with the bitsliced implementation
+/// of libdvbcsa, which uses the SIMD instructions it was build for.
+/// An in-tree bitsliced version is still on the Todo list of the README
+class DvbCsa :
+	public Descrambler {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		DvbCsa();
+
+		virtual ~DvbCsa() = default;
+
+		// =====================================================================
+		// -- Descrambler ------------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// @see Descrambler
+		virtual std::string getName() const final;
+
+		/// @see Descrambler
+		virtual std::size_t getKeyLength() const noexcept final {
+			return 8;
+		}
+
+		/// @see Descrambler
+		virtual unsigned int getBatchSize() const noexcept final {
+			return _batchSize;
+		}
+
+		/// @see Descrambler
+		virtual SpKey makeKey(const unsigned char *cw, std::size_t length,
+				const unsigned char *iv, int icamECM) const final;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Check if the loaded libdvbcsa supports ICAM
+		static bool isICAMSupported();
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		unsigned int _batchSize;
+};
+
+}
+
+#endif // DECRYPT_DESCRAMBLER_DVBCSA_H_INCLUDE
@@ -29,14 +29,11 @@
 #include <mpegts/PAT.h>
 #include <mpegts/PMT.h>
 #include <mpegts/SDT.h>
+#include <base/ThreadPlacement.h>
 #include <input/dvb/FrontendDecryptInterface.h>
 
 #include <cstring>
 
-extern "C" {
-	#include <dvbcsa/dvbcsa.h>
-}
-
 #include <poll.h>
 
 #include <netinet/in.h>
@@ -53,6 +50,8 @@ namespace decrypt::dvbapi {
 	#define DVBAPI_PROTOCOL_VERSION 2
 
 	#define DVBAPI_CA_SET_DESCR     0x40106f86
+	#define DVBAPI_CA_SET_DESCR_MODE 0x400c6f88
+	#define DVBAPI_CA_SET_DESCR_DATA 0x40186f89
 	#define DVBAPI_CA_SET_PID       0x40086f87
 	#define DVBAPI_DMX_SET_FILTER   0x403c6f2b
 	#define DVBAPI_DMX_STOP         0x00006f2a
@@ -65,6 +64,13 @@ namespace decrypt::dvbapi {
 	#define DVBAPI_SERVER_INFO      0xFFFF0002
 	#define DVBAPI_ECM_INFO         0xFFFF0003
 
+	// ca_descr_mode and ca_descr_data of the extended CW API
+	#define CA_ALGO_DVBCSA          0x00
+	#define CA_ALGO_AES128          0x02
+	#define CA_MODE_CBC             0x01
+	#define CA_DATA_IV              0x00
+	#define CA_DATA_KEY             0x01
+
 	#define LIST_MORE               0x00 // append 'MORE' CAPMT object the list and start receiving the next object
 	#define LIST_FIRST              0x01 // clear the list when 'FIRST' CAPMT object is received, and start receiving the next object
 	#define LIST_LAST               0x02 // append 'LAST' CAPMT object to the list, and start working with the list
@@ -72,6 +78,8 @@ namespace decrypt::dvbapi {
 	#define LIST_ADD                0x04 // append 'ADD' CAPMT object to the current list, and start working with the updated list
 	#define LIST_UPDATE             0x05 // replace entry in the list with 'UPDATE' CAPMT object, and start working with the updated list
 
+	#define MAX_DECRYPT_THREADS     16
+
 	Client::Client(StreamManager &streamManager) :
 		ThreadBase("DvbApiClient"),
 		XMLSupport(),
@@ -80,9 +88,11 @@ namespace decrypt::dvbapi {
 		_rewritePMT(false),
 		_serverPort(15011),
 		_adapterOffset(0),
+		_decryptThreads(WorkerPool::getDefaultSize()),
 		_serverIPAddr("127.0.0.1"),
 		_serverName("Not connected"),
 		_streamManager(streamManager) {
+		_workerPool.resize(_decryptThreads);
 		startThread();
 	}
 
@@ -92,10 +102,25 @@ namespace decrypt::dvbapi {
 	}
 
 	void Client::decrypt(const FeIndex index, const FeID id, mpegts::PacketBuffer &buffer) {
-		if (_connected && _enabled) {
+		if (_connected && _enabled && static_cast<std::size_t>(index.getID()) < MAX_FRONTENDS) {
 			const input::dvb::SpFrontendDecryptInterface frontend = _streamManager.getFrontendDecryptInterface(index);
-			const unsigned int maxBatchSize = frontend->getMaximumBatchSize();
+			const unsigned int targetBatchSize = frontend->getTargetBatchSize();
 			const std::size_t size = buffer.getNumberOfCompletedPackets();
+			frontend->keysEnter();
+
+			// Did the PAT, PMT or SDT change, then the CA PMT should be updated.
+			// Remove the old one, so it is not send with the PMTs of other frontends
+			const uint32_t psiChanges = frontend->getPSIChanges();
+			if (_psiChanges[index.getID()] != psiChanges) {
+				_psiChanges[index.getID()] = psiChanges;
+				{
+					base::MutexLock lock(_capmtMutex);
+					_capmtMap.erase(index.getID());
+				}
+				_resendPMT[index.getID()] = true;
+				SI_LOG_INFO("Frontend: @#1, PSI changed, updating PMT for OSCam", id);
+			}
+
 			for (std::size_t i = 0; i < size; ++i) {
 				// Get TS packet from the buffer
 				unsigned char *data = buffer.getTSPacketPtr(i);
@@ -117,13 +142,13 @@ namespace decrypt::dvbapi {
 
 						// check if the parity changed in this batch (but should not be the begin of the batch)
 						// or check if this batch full, then decrypt this batch
-						if (countBatch != 0 && (parity != parityBatch || countBatch >= maxBatchSize)) {
+						if (countBatch != 0 && (parity != parityBatch || countBatch >= targetBatchSize)) {
 							//
 							SI_LOG_COND_DEBUG(parity != parityBatch, "Frontend: @#1, PID @#2 Parity changed from @#3 to @#4, decrypting batch size @#5",
 								id, PID(pid), parityBatch, parity, countBatch);
 
 							// decrypt this batch
-							frontend->decryptBatch();
+							frontend->decryptBatch(_workerPool);
 						}
 
 						// Can we add this packet to the batch
@@ -133,11 +158,8 @@ namespace decrypt::dvbapi {
 							if((data[3] & 0x20) && (data[4] < 183)) {
 								skip += data[4] + 1;
 							}
-							// Add it to batch.
-							frontend->setBatchData(data + skip, 188 - skip, parity, data);
-
-							// set pending decrypt for this buffer
-							buffer.setDecryptPending();
+							// Add it to batch, this sets pending decrypt for this buffer
+							frontend->setBatchData(data + skip, 188 - skip, parity, data, buffer);
 						} else {
 							// set decrypt failed by setting NULL packet ID..
 							data[1] |= 0x1F;
@@ -182,7 +204,8 @@ namespace decrypt::dvbapi {
 						}
 
 						if (frontend->isMarkedAsActivePMT(pid)) {
-							sendPMT(index, id, *frontend->getSDTData(), *frontend->getPMTData(pid));
+							sendPMT(index, id, *frontend->getSDTData(), *frontend->getPMTData(pid),
+								_resendPMT[index.getID()]);
 							if (_rewritePMT) {
 								mpegts::PMT::cleanPI(data);
 							}
@@ -190,6 +213,31 @@ namespace decrypt::dvbapi {
 					}
 				}
 			}
+			// Do not let the first packets of the batch wait for a full batch
+			if (frontend->isBatchDeadlineExpired()) {
+				frontend->decryptBatch(_workerPool);
+			}
+			// No keys of this frontend are in use by this thread anymore
+			frontend->keysQuiescent();
+		} else {
+			// A batch that was partly filled before OSCam disconnected or was
+			// disabled will not be filled anymore, so flush it
+			decryptExpiredBatch(index);
+		}
+	}
+
+	void Client::decryptExpiredBatch(const FeIndex index) {
+		// Also when not connected anymore, else the buffers stay pending
+		const input::dvb::SpFrontendDecryptInterface frontend = _streamManager.getFrontendDecryptInterface(index);
+		if (frontend) {
+			// Without OSCam the batch does not grow anymore, so do not wait for
+			// the deadline (there might be none) and flush it right away
+			const bool flush = !_connected || !_enabled;
+			frontend->keysEnter();
+			if ((flush && frontend->getBatchCount() != 0) || frontend->isBatchDeadlineExpired()) {
+				frontend->decryptBatch(_workerPool);
+			}
+			frontend->keysQuiescent();
 		}
 	}
 
@@ -212,15 +260,26 @@ namespace decrypt::dvbapi {
 			}
 		}
 		// Remove this PMT from the list
-		const auto it = _capmtMap.find(index.getID());
-		if (it != _capmtMap.end()) {
-			_capmtMap.erase(it);
+		{
+			base::MutexLock lock(_capmtMutex);
+			const auto it = _capmtMap.find(index.getID());
+			if (it != _capmtMap.end()) {
+				_capmtMap.erase(it);
+			}
+		}
+		if (static_cast<std::size_t>(index.getID()) < MAX_FRONTENDS) {
+			_resendPMT[index.getID()] = false;
 		}
 		// cleaning OSCam filters
 		frontend->stopOSCamFilters(id);
 		return true;
 	}
 
+	void Client::setThreadPlacement(base::SpThreadPlacement placement) {
+		placement->placeDecryptThread(*this);
+		_workerPool.setThreadPlacement(placement);
+	}
+
 	bool Client::initClientSocket(SocketClient &client, const std::string &ipAddr, int port) {
 
 		client.setupSocketStructure(ipAddr, port, 0);
@@ -260,15 +319,17 @@ namespace decrypt::dvbapi {
 		}
 	}
 
-	void Client::sendPMT(const FeIndex index, const FeID id, const mpegts::SDT &sdt, const mpegts::PMT &pmt) {
+	void Client::sendPMT(const FeIndex index, const FeID id, const mpegts::SDT &sdt,
+			const mpegts::PMT &pmt, const bool force) {
 		// Did we collect SDT and PMT
 		if (!sdt.isCollected()) {
 			return;
 		}
 		// Did we send PMT already
-		if (!pmt.isReadySend()) {
+		if (!pmt.isReadySend() && !(force && pmt.isCollected())) {
 			return;
 		}
+		_resendPMT[index.getID()] = false;
 		const int adapterIndex = index.getID() + _adapterOffset;
 		const int demuxIndex = adapterIndex;
 
@@ -335,6 +396,7 @@ namespace decrypt::dvbapi {
 		std::memcpy(&caPMT[12], oscamDesc, sizeof(oscamDesc));
 		std::memcpy(&caPMT[12 + sizeof(oscamDesc)], progInfo.data(), progInfo.size());
 		// Save new PMT so we can send it
+		base::MutexLock lock(_capmtMutex);
 		_capmtMap[index.getID()] = PMTEntry{ caPMT, totLength + 6 };
 
 		// Send the collected PMT list
@@ -456,7 +518,9 @@ namespace decrypt::dvbapi {
 										cw[8] = 0;
 
 										const input::dvb::SpFrontendDecryptInterface frontend = _streamManager.getFrontendDecryptInterface(adapter);
-										frontend->setKey(cw, parity, index);
+										if (!frontend->setKey(cw, 8, parity, index)) {
+											SI_LOG_ERROR("Frontend: @#1, Received CW does not fit the selected descrambler", frontend->getFeID());
+										}
 										SI_LOG_DEBUG("Frontend: @#1, Received @#2(@#3) CW: @#4 @#5 @#6 @#7 @#8 @#9 @#10 @#11  index: @#12",
 											frontend->getFeID(), (parity == 0) ? "even" : "odd", HEX2(parity),
 											HEX2(cw[0]), HEX2(cw[1]), HEX2(cw[2]), HEX2(cw[3]),
@@ -466,6 +530,57 @@ namespace decrypt::dvbapi {
 										i += 21;
 										break;
 									}
+								case DVBAPI_CA_SET_DESCR_MODE: {
+										const int adapter   =  buf[i +  4] - _adapterOffset;
+										const int algorithm = (buf[i +  9] << 24) | (buf[i + 10] << 16) | (buf[i + 11] << 8) | buf[i + 12];
+										const int mode      = (buf[i + 13] << 24) | (buf[i + 14] << 16) | (buf[i + 15] << 8) | buf[i + 16];
+
+										const input::dvb::SpFrontendDecryptInterface frontend = _streamManager.getFrontendDecryptInterface(adapter);
+										if (algorithm == CA_ALGO_DVBCSA) {
+											frontend->setDescramblerAlgorithm(descrambler::Descrambler::Algorithm::DVBCSA);
+										} else if (algorithm == CA_ALGO_AES128 && mode == CA_MODE_CBC) {
+											frontend->setDescramblerAlgorithm(descrambler::Descrambler::Algorithm::CISSA);
+										} else {
+											SI_LOG_ERROR("Frontend: @#1, Descramble algorithm @#2 with mode @#3 is not supported",
+												frontend->getFeID(), algorithm, mode);
+										}
+										SI_LOG_DEBUG("Frontend: @#1, Received descramble algorithm: @#2  mode: @#3",
+											frontend->getFeID(), algorithm, mode);
+
+										// Goto next cmd
+										i += 17;
+										break;
+									}
+								case DVBAPI_CA_SET_DESCR_DATA: {
+										const int adapter  =  buf[i +  4] - _adapterOffset;
+										const int index    = (buf[i +  5] << 24) | (buf[i +  6] << 16) | (buf[i +  7] << 8) | buf[i +  8];
+										const int parity   = (buf[i +  9] << 24) | (buf[i + 10] << 16) | (buf[i + 11] << 8) | buf[i + 12];
+										const int dataType = (buf[i + 13] << 24) | (buf[i + 14] << 16) | (buf[i + 15] << 8) | buf[i + 16];
+										const int length   = (buf[i + 17] << 24) | (buf[i + 18] << 16) | (buf[i + 19] << 8) | buf[i + 20];
+										const unsigned char* data = &buf[i + 21];
+										if (length < 0 || i + 21 + length > size) {
+											SI_LOG_ERROR("Frontend: x, Received incomplete descramble data");
+											i = size;
+											break;
+										}
+
+										const input::dvb::SpFrontendDecryptInterface frontend = _streamManager.getFrontendDecryptInterface(adapter);
+										if (dataType == CA_DATA_IV && length == 16) {
+											frontend->setIV(data, parity);
+										} else if (dataType == CA_DATA_KEY) {
+											if (!frontend->setKey(data, length, parity, index)) {
+												SI_LOG_ERROR("Frontend: @#1, Received @#2 byte key does not fit the selected descrambler",
+													frontend->getFeID(), length);
+											}
+										}
+										SI_LOG_DEBUG("Frontend: @#1, Received @#2(@#3) @#4 with @#5 bytes  index: @#6",
+											frontend->getFeID(), (parity == 0) ? "even" : "odd", HEX2(parity),
+											(dataType == CA_DATA_IV) ? "IV" : "Key", length, index);
+
+										// Goto next cmd
+										i += 21 + length;
+										break;
+									}
 								case DVBAPI_CA_SET_PID: {
 //										const int adapter   =  buf[i +  4] - _adapterOffset;
 //										SI_LOG_BIN_DEBUG(&buf[i], 65, "Frontend: @#1, DVBAPI_CA_SET_PID", adapter);
@@ -550,6 +665,11 @@ namespace decrypt::dvbapi {
 		if (findXMLElement(xml, "RewritePMT.value", element)) {
 			_rewritePMT = (element == "true") ? true : false;
 		}
+		if (findXMLElement(xml, "decryptThreads.value", element)) {
+			const unsigned int threads = std::stoi(element);
+			_decryptThreads = (threads < MAX_DECRYPT_THREADS) ? threads : MAX_DECRYPT_THREADS;
+			_workerPool.resize(_decryptThreads);
+		}
 	}
 
 	void Client::doAddToXML(std::string &xml) const {
@@ -559,6 +679,9 @@ namespace decrypt::dvbapi {
 		ADD_XML_NUMBER_INPUT(xml, "OSCamPORT", _serverPort.load(), 0, 65535);
 		ADD_XML_NUMBER_INPUT(xml, "AdapterOffset", _adapterOffset.load(), 0, 128);
 		ADD_XML_ELEMENT(xml, "OSCamServerName", _serverName);
+		ADD_XML_NUMBER_INPUT(xml, "decryptThreads", _decryptThreads.load(), 0, MAX_DECRYPT_THREADS);
+		ADD_XML_ELEMENT(xml, "decryptQueued", _workerPool.getQueued());
+		ADD_XML_ELEMENT(xml, "decryptMaxQueued", _workerPool.getMaxQueued());
 	}
 
 }
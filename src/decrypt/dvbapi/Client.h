@@ -22,15 +22,19 @@
 
 #include <Defs.h>
 #include <FwDecl.h>
+#include <base/Mutex.h>
 #include <base/ThreadBase.h>
 #include <base/XMLSupport.h>
+#include <decrypt/dvbapi/WorkerPool.h>
 #include <socket/SocketClient.h>
 
+#include <array>
 #include <atomic>
 #include <string>
 #include <map>
 
 FW_DECL_NS0(StreamManager);
+FW_DECL_SP_NS1(base, ThreadPlacement);
 FW_DECL_NS1(mpegts, PacketBuffer);
 FW_DECL_NS1(mpegts, PMT);
 FW_DECL_NS1(mpegts, SDT);
@@ -110,9 +114,17 @@ class Client :
 		///
 		void decrypt(FeIndex index, FeID id, mpegts::PacketBuffer &buffer);
 
+		/// Decrypt the batch of this frontend when its first packet is
+		/// waiting longer then the deadline, or right away when OSCam is not
+		/// connected or disabled. Call it on every pass of the reader
+		void decryptExpiredBatch(FeIndex index);
+
 		///
 		bool stopDecrypt(FeIndex index, FeID id);
 
+		/// Set the placement of this thread and the decrypt threads
+		void setThreadPlacement(base::SpThreadPlacement placement);
+
 	private:
 
 		///
@@ -125,7 +137,8 @@ class Client :
 		void sendClientInfo();
 
 		///
-		void sendPMT(FeIndex index, FeID id, const mpegts::SDT &sdt, const mpegts::PMT &pmt);
+		/// @param force specifies to send the PMT also when it was send before
+		void sendPMT(FeIndex index, FeID id, const mpegts::SDT &sdt, const mpegts::PMT &pmt, bool force);
 
 		// =================================================================
 		// -- Data members -------------------------------------------------
@@ -134,6 +147,9 @@ class Client :
 
 		using UCharPtr = std::shared_ptr<unsigned char[]>;
 
+		/// The adapter and demux index are send as one byte to OSCam
+		static constexpr std::size_t MAX_FRONTENDS = 256;
+
 		struct PMTEntry {
 			UCharPtr caPtr;
 			int size;
@@ -145,9 +161,17 @@ class Client :
 		std::atomic_bool _rewritePMT;
 		std::atomic<int> _serverPort;
 		std::atomic<int> _adapterOffset;
+		std::atomic<unsigned int> _decryptThreads;
+		WorkerPool       _workerPool;
 		std::string      _serverIPAddr;
 		std::string      _serverName;
+		base::Mutex      _capmtMutex;
 		std::map<int, PMTEntry> _capmtMap;
+		/// The PSI changes of each frontend that are handled, these are
+		/// used by all Stream readers so they are indexed by FeIndex
+		std::array<std::atomic<uint32_t>, MAX_FRONTENDS> _psiChanges{};
+		/// The frontends that should send their PMT again
+		std::array<std::atomic_bool, MAX_FRONTENDS> _resendPMT{};
 
 		StreamManager &_streamManager;
 };
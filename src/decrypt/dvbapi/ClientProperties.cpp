@@ -19,10 +19,14 @@
  */
 #include <decrypt/dvbapi/ClientProperties.h>
 
+#include <StringConverter.h>
 #include <Utils.h>
 #include <Unused.h>
+#include <decrypt/descrambler/DvbCsa.h>
+#include <decrypt/dvbapi/WorkerPool.h>
 
-#include <dlfcn.h>
+#include <algorithm>
+#include <chrono>
 
 namespace decrypt::dvbapi {
 
@@ -30,29 +34,42 @@ namespace decrypt::dvbapi {
 // -- Constructors and destructor --------------------------------------------
 // ===========================================================================
 
-ClientProperties::ClientProperties() {
-	_batchSizeMax = dvbcsa_bs_batch_size();
-	_batchSize = _batchSizeMax;
-	_batch = new dvbcsa_bs_batch_s[_batchSizeMax + 1];
-	_ts = new dvbcsa_bs_batch_s[_batchSizeMax + 1];
-	_batchCount = 0;
-	_parity = 0;
-	void* handle = dlopen("libdvbcsa.so.1", RTLD_LAZY | RTLD_NODELETE);
-	if (handle != nullptr) {
-		if (dlsym(handle, "dvbcsa_bs_key_set_ecm") == nullptr) {
-			SI_LOG_INFO("  ICAM support in libdvbcsa.so: No");
-			_icamEnabled = false;
-		} else {
-			SI_LOG_INFO("  ICAM support in libdvbcsa.so: Yes");
-			_icamEnabled = true;
+ClientProperties::ClientProperties() :
+	_batchSizeMax(1),
+	_batchSize(_batchSizeMax),
+	_batchDeadline(20),
+	_targetBatchSize(_batchSizeMax),
+	_rateWindowStart(getMicros()),
+	_ratePackets(0),
+	_scrambledRate(0),
+	_batchCapacity(0),
+	_flushSize(0),
+	_flushDeadline(0),
+	_flushParity(0),
+	_batchLatencyTotal(0),
+	_batchLatencyMax(0),
+	_batch(nullptr),
+	_pendingBatches(0),
+	_decryptedBatches(0),
+	_decryptedPackets(0),
+	_descramblerMode(DescramblerMode::Auto),
+	_serverAlgorithm(Algorithm::DVBCSA) {
+	_descramblers[asInteger(Algorithm::DVBCSA)] = descrambler::Descrambler::makeSP(Algorithm::DVBCSA);
+	_descramblers[asInteger(Algorithm::CISSA)] = descrambler::Descrambler::makeSP(Algorithm::CISSA);
+	// A batch should fit the descrambler with the biggest batches
+	for (const descrambler::SpDescrambler &descrambler : _descramblers) {
+		if (descrambler && descrambler->getBatchSize() > _batchSizeMax) {
+			_batchSizeMax = descrambler->getBatchSize();
 		}
-		dlclose(handle);
 	}
+	_batchSize = _batchSizeMax;
+	_targetBatchSize = _batchSizeMax;
+	_batches.emplace_back(new DecryptBatch(_batchSizeMax));
+	_batch = _batches.back().get();
 }
 
 ClientProperties::~ClientProperties() {
-	DELETE_ARRAY(_batch);
-	DELETE_ARRAY(_ts);
+	waitForPendingBatches();
 	_keys.freeKeys();
 }
 
@@ -61,50 +78,178 @@ ClientProperties::~ClientProperties() {
 // =============================================================================
 
 void ClientProperties::doAddToXML(std::string& xml) const {
-	ADD_XML_NUMBER_INPUT(xml, "dvbcsa_bs_batch_size", _batchSize, 0, _batchSizeMax);
-	ADD_XML_ELEMENT(xml, "icamEnabled", _icamEnabled ? "Yes" : "No");
+	ADD_XML_NUMBER_INPUT(xml, "dvbcsa_bs_batch_size", _batchSize.load(), 1, _batchSizeMax);
+	ADD_XML_NUMBER_INPUT(xml, "dvbcsa_batch_deadline", _batchDeadline.load(), 0, MAX_BATCH_DEADLINE);
+	ADD_XML_ELEMENT(xml, "icamEnabled", descrambler::DvbCsa::isICAMSupported() ? "Yes" : "No");
+	ADD_XML_BEGIN_ELEMENT(xml, "descrambler");
+		ADD_XML_ELEMENT(xml, "inputtype", "selectionlist");
+		ADD_XML_ELEMENT(xml, "value", asInteger(_descramblerMode.load()));
+		ADD_XML_BEGIN_ELEMENT(xml, "list");
+		ADD_XML_ELEMENT(xml, "option0", "Auto (as OSCam sends)");
+		ADD_XML_ELEMENT(xml, "option1", "DVB-CSA");
+		ADD_XML_ELEMENT(xml, "option2", "DVB-CISSA");
+		ADD_XML_END_ELEMENT(xml, "list");
+	ADD_XML_END_ELEMENT(xml, "descrambler");
+	const descrambler::Descrambler *active = getDescrambler();
+	ADD_XML_ELEMENT(xml, "descramblerActive", (active == nullptr) ? "Not available" : active->getName());
+
+	const unsigned long batches = _decryptedBatches.load(std::memory_order_relaxed);
+	const unsigned long capacity = _batchCapacity.load(std::memory_order_relaxed);
+	ADD_XML_ELEMENT(xml, "batchTargetSize", _targetBatchSize.load());
+	ADD_XML_ELEMENT(xml, "scrambledPacketRate", _scrambledRate.load());
+	ADD_XML_ELEMENT(xml, "batchFillRatio", (capacity == 0) ? 0 :
+		(_decryptedPackets.load(std::memory_order_relaxed) * 100) / capacity);
+	ADD_XML_ELEMENT(xml, "batchLatencyAvg", (batches == 0) ? 0 :
+		_batchLatencyTotal.load(std::memory_order_relaxed) / batches);
+	ADD_XML_ELEMENT(xml, "batchLatencyMax", _batchLatencyMax.load());
+	ADD_XML_ELEMENT(xml, "batchFlushes", StringConverter::stringFormat("size @#1 / deadline @#2 / parity @#3",
+		_flushSize.load(), _flushDeadline.load(), _flushParity.load()));
 }
 
-void ClientProperties::doFromXML(const std::string& UNUSED(xml)) {
+void ClientProperties::doFromXML(const std::string& xml) {
+	std::string element;
+	if (findXMLElement(xml, "dvbcsa_bs_batch_size.value", element)) {
+		const unsigned int size = std::stoi(element);
+		_batchSize = (size < 1) ? 1 : ((size < _batchSizeMax) ? size : _batchSizeMax);
+	}
+	if (findXMLElement(xml, "dvbcsa_batch_deadline.value", element)) {
+		const unsigned int deadline = std::stoi(element);
+		_batchDeadline = (deadline < MAX_BATCH_DEADLINE) ? deadline : MAX_BATCH_DEADLINE;
+	}
+	if (findXMLElement(xml, "descrambler.value", element)) {
+		const int mode = std::stoi(element);
+		_descramblerMode = (mode >= asInteger(DescramblerMode::Auto) && mode <= asInteger(DescramblerMode::CISSA)) ?
+			static_cast<DescramblerMode>(mode) : DescramblerMode::Auto;
+	}
 }
 
 // ===========================================================================
 // -- Other member functions -------------------------------------------------
 // ===========================================================================
 
+const descrambler::Descrambler *ClientProperties::getDescrambler() const {
+	Algorithm algorithm = _serverAlgorithm;
+	switch (_descramblerMode.load()) {
+		case DescramblerMode::Auto:
+			break;
+		case DescramblerMode::DVBCSA:
+			algorithm = Algorithm::DVBCSA;
+			break;
+		case DescramblerMode::CISSA:
+			algorithm = Algorithm::CISSA;
+			break;
+		default:
+			// Use the algorithm of the server, like Auto
+			break;
+	}
+	return _descramblers[asInteger(algorithm)].get();
+}
+
+bool ClientProperties::setKey(const unsigned char* cw, const std::size_t length,
+		const unsigned int parity, const int index) {
+	const descrambler::Descrambler *descrambler = getDescrambler();
+	return descrambler != nullptr && _keys.set(*descrambler, cw, length, parity, index);
+}
+
 void ClientProperties::stopOSCamFilters(FeID id) {
 	SI_LOG_INFO("Frontend: @#1, Clearing OSCam filters and Keys...", id);
+	// The buffers of the pending batches are given back after this
+	waitForPendingBatches();
 	// free keys
 	_keys.freeKeys();
-	_batchCount = 0;
-	_parity = 0;
+	_serverAlgorithm = Algorithm::DVBCSA;
+	_batch->clear();
 	_filter.clear();
+	_rateWindowStart = getMicros();
+	_ratePackets = 0;
 }
 
-void ClientProperties::decryptBatch() noexcept {
-	const auto key = _keys.get(_parity);
-	if (key != nullptr) {
-		// terminate batch buffer
-		setBatchData(nullptr, 0, _parity, nullptr);
-		// decrypt it
-		dvbcsa_bs_decrypt(key, _batch, 184);
-
-		// clear scramble flags, so we can send it.
-		for (unsigned int i = 0; _ts[i].data != nullptr; ++i) {
-			_ts[i].data[3] &= 0x3F;
-		}
-	} else {
-		for (unsigned int i = 0; _ts[i].data != nullptr; ++i) {
-			// set decrypt failed by setting NULL packet ID..
-			_ts[i].data[1] |= 0x1F;
-			_ts[i].data[2] |= 0xFF;
+long ClientProperties::getMicros() noexcept {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-			// clear scramble flag, so we can send it.
-			_ts[i].data[3] &= 0x3F;
+bool ClientProperties::isBatchDeadlineExpired() noexcept {
+	const long now = getMicros();
+	const unsigned int deadline = _batchDeadline.load(std::memory_order_relaxed);
+	const unsigned int maxSize = _batchSize.load(std::memory_order_relaxed);
+	const long window = now - _rateWindowStart;
+	if (window >= RATE_WINDOW) {
+		const unsigned long rate = (_ratePackets * 1000000ul) / window;
+		_scrambledRate.store(rate, std::memory_order_relaxed);
+		// The batch size that fills within the deadline, without deadline
+		// only a full batch or parity change is decrypted
+		const unsigned long target = (deadline == 0) ? maxSize : (rate * deadline) / 1000;
+		_targetBatchSize.store(std::clamp<unsigned long>(target, 1, maxSize), std::memory_order_relaxed);
+		_rateWindowStart = now;
+		_ratePackets = 0;
+	}
+	return deadline != 0 && _batch->size() != 0 &&
+		(now - _batch->getStartTime()) >= (deadline * 1000l);
+}
+
+int ClientProperties::getBatchWaitTime(const int timeout) const noexcept {
+	const unsigned int deadline = _batchDeadline.load(std::memory_order_relaxed);
+	if (deadline == 0 || _batch->size() == 0) {
+		return timeout;
+	}
+	const long left = (deadline * 1000l) - (getMicros() - _batch->getStartTime());
+	// Round up, so the deadline did expire when waking up
+	return std::clamp<long>((left + 999) / 1000, 0, timeout);
+}
+
+void ClientProperties::decryptBatch(WorkerPool &pool) noexcept {
+	DecryptBatch *batch = _batch;
+	const unsigned int count = batch->size();
+	const unsigned int deadline = _batchDeadline.load(std::memory_order_relaxed);
+	if (count >= getTargetBatchSize()) {
+		_flushSize.fetch_add(1, std::memory_order_relaxed);
+	} else if (deadline != 0 && (getMicros() - batch->getStartTime()) >= (deadline * 1000l)) {
+		_flushDeadline.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		_flushParity.fetch_add(1, std::memory_order_relaxed);
+	}
+	_batchCapacity.fetch_add(_batchSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	_decryptedBatches.fetch_add(1, std::memory_order_relaxed);
+	_decryptedPackets.fetch_add(count, std::memory_order_relaxed);
+	batch->setKey(_keys.get(batch->getParity()));
+	{
+		base::MutexLock lock(_batchMutex);
+		++_pendingBatches;
+		// Continue with a free batch, or make one when they are all busy
+		if (_freeBatches.empty()) {
+			_batches.emplace_back(new DecryptBatch(_batchSizeMax));
+			_batch = _batches.back().get();
+		} else {
+			_batch = _freeBatches.back();
+			_freeBatches.pop_back();
 		}
 	}
-	// decrypted this batch reset counter
-	_batchCount = 0;
+	pool.submit([this, batch]() {
+		batch->decrypt();
+		releaseBatch(batch);
+	});
+}
+
+void ClientProperties::releaseBatch(DecryptBatch *batch) {
+	const unsigned long latency = getMicros() - batch->getStartTime();
+	_batchLatencyTotal.fetch_add(latency, std::memory_order_relaxed);
+	unsigned long max = _batchLatencyMax.load(std::memory_order_relaxed);
+	while (latency > max && !_batchLatencyMax.compare_exchange_weak(max, latency,
+			std::memory_order_relaxed)) {}
+	{
+		base::MutexLock lock(_batchMutex);
+		_freeBatches.push_back(batch);
+		--_pendingBatches;
+		// Notify with the lock held, else the destructor may see no pending
+		// batches and destroy _batchDone before it is notified
+		_batchDone.notify_all();
+	}
+}
+
+void ClientProperties::waitForPendingBatches() {
+	base::MutexLock lock(_batchMutex);
+	_batchDone.wait(_batchMutex, [this]() { return _pendingBatches == 0; });
 }
 
 void ClientProperties::setECMInfo(
@@ -23,20 +23,42 @@
 #include <Defs.h>
 #include <FwDecl.h>
 #include <mpegts/TableData.h>
+#include <base/Mutex.h>
 #include <base/TimeCounter.h>
 #include <base/XMLSupport.h>
+#include <decrypt/descrambler/Descrambler.h>
+#include <decrypt/dvbapi/DecryptBatch.h>
 #include <decrypt/dvbapi/Filter.h>
 #include <decrypt/dvbapi/Keys.h>
 
-extern "C" {
-	#include <dvbcsa/dvbcsa.h>
-}
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+FW_DECL_NS2(decrypt, dvbapi, WorkerPool);
 
 namespace decrypt::dvbapi {
 
 ///
 class ClientProperties :
 	public base::XMLSupport {
+		// ================================================================
+		// -- Defines -----------------------------------------------------
+		// ================================================================
+	public:
+
+		using Algorithm = descrambler::Descrambler::Algorithm;
+
+		/// Which descrambler is used for the keys of this frontend
+		enum class DescramblerMode {
+			Auto,
+			DVBCSA,
+			CISSA
+		};
+
 		// ================================================================
 		// -- Constructors and destructor ---------------------------------
 		// ================================================================
@@ -66,49 +88,97 @@ class ClientProperties :
 		// ================================================================
 	public:
 
-		/// Get the maximum decrypt batch size
-		unsigned int getMaximumBatchSize() const noexcept {
-			return _batchSize;
+		/// Get the batch size that should be decrypted, it is derived from
+		/// the scrambled packet rate so a batch fills within the deadline
+		unsigned int getTargetBatchSize() const noexcept {
+			return _targetBatchSize.load(std::memory_order_relaxed);
 		}
 
+		/// Check if the first packet of the batch is waiting longer then the
+		/// deadline. It also measures the scrambled packet rate, so call it
+		/// regularly from the reader thread
+		bool isBatchDeadlineExpired() noexcept;
+
+		/// Get how long the reader may wait for new data before the deadline
+		/// of the batch expires, only for the reader thread
+		/// @param timeout specifies the time in ms to wait without pending batch
+		/// @return the time to wait in ms
+		int getBatchWaitTime(int timeout) const noexcept;
+
 		/// Get how big this decrypt batch is
 		unsigned int getBatchCount() const noexcept {
-			return _batchCount;
+			return _batch->size();
 		}
 
 		/// Get the global parity of this decrypt batch
 		unsigned int getBatchParity() const noexcept {
-			return _parity;
+			return _batch->getParity();
 		}
 
 		/// Set the pointers into the decrypt batch
 		/// @param ptr specifies the pointer to de data that should be decrypted
 		/// @param len specifies the lenght of data
 		/// @param originalPtr specifies the original TS packet (so we can clear scramble flag when finished)
-		void setBatchData(unsigned char* ptr, unsigned int len, unsigned int parity, unsigned char* originalPtr) noexcept {
-			_batch[_batchCount].data = ptr;
-			_batch[_batchCount].len  = len;
-			_ts[_batchCount].data = originalPtr;
-			_parity = parity;
-			++_batchCount;
+		/// @param buffer specifies the buffer the TS packet is in
+		void setBatchData(unsigned char* ptr, unsigned int len, unsigned int parity,
+				unsigned char* originalPtr, mpegts::PacketBuffer &buffer) noexcept {
+			if (_batch->size() == 0) {
+				_batch->setStartTime(getMicros());
+			}
+			++_ratePackets;
+			_batch->add(ptr, len, parity, originalPtr, buffer);
 		}
 
-		/// This function will decrypt the batch upon success it will clear scramble flag
+		/// Hand the batch to @p pool to decrypt it, upon success it will clear scramble flag
 		/// on failure it will make a NULL TS Packet and clear scramble flag
-		void decryptBatch() noexcept;
+		void decryptBatch(WorkerPool &pool) noexcept;
+
+		/// Wait until all batches that were handed to the WorkerPool are finished
+		void waitForPendingBatches();
+
+		/// Get the amount of batches that were decrypted
+		unsigned long getDecryptedBatches() const noexcept {
+			return _decryptedBatches.load(std::memory_order_relaxed);
+		}
+
+		/// Get the amount of TS packets that were decrypted in all batches
+		unsigned long getDecryptedPackets() const noexcept {
+			return _decryptedPackets.load(std::memory_order_relaxed);
+		}
 
 		/// Set the 'next' key for the requested parity
-		void setKey(const unsigned char* cw, const unsigned int parity, const int index) {
-			_keys.set(cw, parity, index, _icamEnabled);
+		/// @return false if there is no descrambler for the length of @p cw
+		bool setKey(const unsigned char* cw, std::size_t length, unsigned int parity, int index);
+
+		/// Set the IV that is used for the next keys of the requested parity
+		void setIV(const unsigned char* iv, const unsigned int parity) {
+			_keys.setIV(iv, parity);
+		}
+
+		/// Set the algorithm the server (OSCam) is sending keys for, it is
+		/// used when the descrambler mode is Auto
+		void setServerAlgorithm(const Algorithm algorithm) {
+			_serverAlgorithm = algorithm;
 		}
 
 		void setICAM(const unsigned char ecm, const unsigned int parity) {
 			_keys.setICAM(ecm, parity);
 		}
 
-		/// Get the active key for the requested parity
-		const dvbcsa_bs_key_s* getKey(unsigned int parity) const {
-			return _keys.get(parity);
+		/// Get the active key for the requested parity, only for the reader
+		/// thread until it calls @c keysQuiescent()
+		const descrambler::Key* getKey(unsigned int parity) const noexcept {
+			return _keys.get(parity).get();
+		}
+
+		/// The reader thread starts using the keys
+		void keysEnter() noexcept {
+			_keys.enter();
+		}
+
+		/// The reader thread does not use the keys it got anymore
+		void keysQuiescent() noexcept {
+			_keys.quiescent();
 		}
 
 		/// Start and add the requested filter
@@ -138,7 +208,8 @@ class ClientProperties :
 			return _filter.getActiveFilterPIDs(demux);
 		}
 
-		/// Clear all 'active' filters
+		/// Clear all 'active' filters, the batches that are still being
+		/// decrypted are finished first
 		void stopOSCamFilters(FeID id);
 
 		///
@@ -154,18 +225,55 @@ class ClientProperties :
 			const std::string& protocolName,
 			int hops);
 
+	private:
+
+		/// Get the descrambler that makes the keys of this frontend
+		/// @return nullptr if it is not build in
+		const descrambler::Descrambler *getDescrambler() const;
+
+		/// Get the monotonic time in us
+		static long getMicros() noexcept;
+
+		/// Give a decrypted batch back, so it can be filled again
+		void releaseBatch(DecryptBatch *batch);
+
 		// ================================================================
 		//  -- Data members -----------------------------------------------
 		// ================================================================
 	private:
 
-		struct dvbcsa_bs_batch_s* _batch;
-		struct dvbcsa_bs_batch_s* _ts;
+		static constexpr unsigned int MAX_BATCH_DEADLINE = 500;
+		static constexpr long RATE_WINDOW = 500000;
+
 		unsigned int _batchSizeMax;
-		unsigned int _batchSize;
-		unsigned int _batchCount;
-		unsigned int _parity;
-		bool _icamEnabled;
+		std::atomic<unsigned int> _batchSize;
+		/// The time in ms a packet may wait for the batch to fill
+		std::atomic<unsigned int> _batchDeadline;
+		std::atomic<unsigned int> _targetBatchSize;
+		long _rateWindowStart;
+		unsigned long _ratePackets;
+		std::atomic<unsigned long> _scrambledRate;
+		std::atomic<unsigned long> _batchCapacity;
+		std::atomic<unsigned long> _flushSize;
+		std::atomic<unsigned long> _flushDeadline;
+		std::atomic<unsigned long> _flushParity;
+		/// Time in us from the first packet of a batch until decrypted
+		std::atomic<unsigned long> _batchLatencyTotal;
+		std::atomic<unsigned long> _batchLatencyMax;
+		/// The batch that is being filled by the reader thread
+		DecryptBatch *_batch;
+		base::Mutex _batchMutex;
+		/// Only used to wait for the pending batches, it is the only
+		/// condition variable that works with a base::Mutex
+		std::condition_variable_any _batchDone;
+		std::vector<std::unique_ptr<DecryptBatch>> _batches;
+		std::vector<DecryptBatch *> _freeBatches;
+		std::size_t _pendingBatches;
+		std::atomic<unsigned long> _decryptedBatches;
+		std::atomic<unsigned long> _decryptedPackets;
+		std::array<descrambler::SpDescrambler, 2> _descramblers;
+		std::atomic<DescramblerMode> _descramblerMode;
+		std::atomic<Algorithm> _serverAlgorithm;
 		Keys _keys;
 		Filter _filter;
 
@@ -0,0 +1,76 @@
+/* DecryptBatch.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <decrypt/dvbapi/DecryptBatch.h>
+
+#include <mpegts/PacketBuffer.h>
+
+namespace decrypt::dvbapi {
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+DecryptBatch::DecryptBatch(const unsigned int maxSize) :
+	_batch(maxSize + 1),
+	_ts(maxSize),
+	_count(0),
+	_parity(0),
+	_startTime(0) {
+	_buffers.reserve(maxSize);
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void DecryptBatch::decrypt() noexcept {
+	if (_key) {
+		// decrypt it with the descrambler that made the key
+		_key->descramble(_batch.data(), _count);
+
+		// clear scramble flags, so we can send it.
+		for (unsigned int i = 0; i < _count; ++i) {
+			_ts[i][3] &= 0x3F;
+		}
+	} else {
+		for (unsigned int i = 0; i < _count; ++i) {
+			// set decrypt failed by setting NULL packet ID..
+			_ts[i][1] |= 0x1F;
+			_ts[i][2] |= 0xFF;
+
+			// clear scramble flag, so we can send it.
+			_ts[i][3] &= 0x3F;
+		}
+	}
+	// Now the buffers may be send, when no other batch is busy with them
+	for (mpegts::PacketBuffer *buffer : _buffers) {
+		buffer->clearDecryptPending();
+	}
+	clear();
+}
+
+void DecryptBatch::clear() noexcept {
+	_buffers.clear();
+	_key.reset();
+	_count = 0;
+	_parity = 0;
+}
+
+}
@@ -0,0 +1,125 @@
+/* DecryptBatch.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#ifndef DECRYPT_DVBAPI_DECRYPT_BATCH_H_INCLUDE
+#define DECRYPT_DVBAPI_DECRYPT_BATCH_H_INCLUDE DECRYPT_DVBAPI_DECRYPT_BATCH_H_INCLUDE
+
+#include <decrypt/dvbapi/Keys.h>
+#include <mpegts/PacketBuffer.h>
+
+#include <vector>
+
+namespace decrypt::dvbapi {
+
+/// The class @c DecryptBatch collects the scrambled TS packets of one
+/// frontend with the same parity, so they can be decrypted together. It
+/// remembers the PacketBuffers (ring slots) the packets are in, so they can
+/// be marked as decrypted when finished, possibly on an other thread.
+class DecryptBatch {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		/// @param maxSize specifies the maximum amount of packets in this batch
+		explicit DecryptBatch(unsigned int maxSize);
+
+		virtual ~DecryptBatch() = default;
+
+		DecryptBatch(const DecryptBatch&) = delete;
+
+		DecryptBatch& operator=(const DecryptBatch&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get the amount of packets in this batch
+		unsigned int size() const noexcept {
+			return _count;
+		}
+
+		/// Get the parity of the packets in this batch
+		unsigned int getParity() const noexcept {
+			return _parity;
+		}
+
+		/// Add a packet to this batch and set the decrypt pending flag of
+		/// @p buffer when it is the first packet of it in this batch
+		/// @param ptr specifies the pointer to de data that should be decrypted
+		/// @param len specifies the lenght of data
+		/// @param originalPtr specifies the original TS packet (so we can clear scramble flag when finished)
+		/// @param buffer specifies the buffer the TS packet is in
+		void add(unsigned char *ptr, unsigned int len, unsigned int parity,
+				unsigned char *originalPtr, mpegts::PacketBuffer &buffer) noexcept {
+			_batch[_count].data = ptr;
+			_batch[_count].len  = len;
+			_ts[_count] = originalPtr;
+			_parity = parity;
+			++_count;
+			if (_buffers.empty() || _buffers.back() != &buffer) {
+				buffer.setDecryptPending();
+				_buffers.push_back(&buffer);
+			}
+		}
+
+		/// Set the time in us the first packet was added, it is kept until
+		/// the batch is filled again
+		void setStartTime(long time) noexcept {
+			_startTime = time;
+		}
+
+		/// Get the time in us the first packet was added
+		long getStartTime() const noexcept {
+			return _startTime;
+		}
+
+		/// Set the key this batch should be decrypted with
+		void setKey(Keys::KeyPtr key) noexcept {
+			_key = key;
+		}
+
+		/// This function will decrypt the batch upon success it will clear scramble flag
+		/// on failure it will make a NULL TS Packet and clear scramble flag.
+		/// Then it clears the decrypt pending flag of the buffers and empties
+		/// this batch, so it can be used again
+		void decrypt() noexcept;
+
+		/// Empty this batch without decrypting it, only call this when the
+		/// buffers are not used anymore
+		void clear() noexcept;
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		std::vector<descrambler::Payload> _batch;
+		std::vector<unsigned char *> _ts;
+		std::vector<mpegts::PacketBuffer *> _buffers;
+		unsigned int _count;
+		unsigned int _parity;
+		long _startTime;
+		Keys::KeyPtr _key;
+};
+
+}
+
+#endif // DECRYPT_DVBAPI_DECRYPT_BATCH_H_INCLUDE
@@ -23,19 +23,34 @@
 #include <Defs.h>
 #include <base/Mutex.h>
 #include <decrypt/dvbapi/FilterData.h>
+#include <mpegts/PidMask.h>
+#include <mpegts/SectionArena.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace decrypt::dvbapi {
 
-	/// The class @c Filter are all available filters for OSCam
+	/// The class @c Filter are all available filters for OSCam. The active
+	/// filters are indexed by PID, so a packet is only matched with the
+	/// filters of its own PID. The PIDs with a filter are also kept in a
+	/// lock-free mask, so packets without a filter do not take the mutex.
 	class Filter {
 			// =======================================================================
 			//  -- Constructors and destructor ---------------------------------------
 			// =======================================================================
 		public:
 
-			Filter() = default;
+			Filter() :
+				_sectionArena(mpegts::SectionArena::makeSP()) {
+				for (unsigned int demux = 0; demux < DEMUX_SIZE; ++demux) {
+					for (unsigned int filter = 0; filter < FILTER_SIZE; ++filter) {
+						_filterData[demux][filter].setSectionArena(_sectionArena);
+					}
+				}
+			}
 
 			virtual ~Filter() = default;
 
@@ -48,31 +63,42 @@ namespace decrypt::dvbapi {
 			void start(const FeID id, int pid, unsigned int demux, unsigned int filter,
 					const unsigned char* filterData, const unsigned char* filterMask) {
 				base::MutexLock lock(_mutex);
-				if (demux < DEMUX_SIZE && filter < FILTER_SIZE) {
+				if (demux < DEMUX_SIZE && filter < FILTER_SIZE && pid >= 0 && pid < mpegts::PidMask::ALL_PIDS) {
 					_filterData[demux][filter].set(id, pid, filterData, filterMask);
+					updateDispatch_L();
 				}
 			}
 
 			/// Find the correct filter for the 'collected' data or ts packet
-			bool find(const FeID id, const int pid, const unsigned char* data, const int tableID,
+			bool find(const FeID id, const int pid, const unsigned char* tsPacket, const int tableID,
 					unsigned int& filter, unsigned int& demux, mpegts::TSData& filterData) {
+				// Most packets have no filter at all
+				if (pid < 0 || pid >= mpegts::PidMask::ALL_PIDS || !_pids.isSetInMask(pid)) {
+					return false;
+				}
 				base::MutexLock lock(_mutex);
-				for (demux = 0; demux < DEMUX_SIZE; ++demux) {
-					for (filter = 0; filter < FILTER_SIZE; ++filter) {
-						// Find filter with correct id and PID
-						if (!_filterData[demux][filter].activeWith(id, pid)) {
-							continue;
-						}
-						// Does filter matches with 'data' or already collecting
-						if (_filterData[demux][filter].matchOrCollecting(data)) {
-							// Collect table data
-							_filterData[demux][filter].collectRawTableData(id, tableID, data, false);
-							if (_filterData[demux][filter].isTableCollected()) {
-								// Finished there is only 1 section
-								filterData = _filterData[demux][filter].getTableData(0);
-								_filterData[demux][filter].resetTableData();
-								return true;
-							}
+				// The filters of this PID, in demux and filter order
+				auto it = std::lower_bound(_dispatch.begin(), _dispatch.end(), pid,
+					[](const Dispatch &entry, const int value) {
+						return entry.pid < value;
+					});
+				for (; it != _dispatch.end() && it->pid == pid; ++it) {
+					demux = it->demux;
+					filter = it->filter;
+					FilterData &data = _filterData[demux][filter];
+					// Find filter with correct id
+					if (!data.activeWith(id, pid)) {
+						continue;
+					}
+					// Does filter matches with 'data' or already collecting
+					if (data.matchOrCollecting(tsPacket)) {
+						// Collect table data
+						data.collectRawTableData(id, tableID, tsPacket, false);
+						if (data.isTableCollected()) {
+							// Finished there is only 1 section
+							filterData = data.getTableData(0);
+							data.resetTableData();
+							return true;
 						}
 					}
 				}
@@ -84,6 +110,7 @@ namespace decrypt::dvbapi {
 				base::MutexLock lock(_mutex);
 				if (demux < DEMUX_SIZE && filter < FILTER_SIZE) {
 					_filterData[demux][filter].clear();
+					updateDispatch_L();
 				}
 			}
 
@@ -94,6 +121,7 @@ namespace decrypt::dvbapi {
 						_filterData[demux][filter].clear();
 					}
 				}
+				updateDispatch_L();
 			}
 
 			std::vector<int> getActiveDemuxFilters() const {
@@ -119,6 +147,46 @@ namespace decrypt::dvbapi {
 				return pids;
 			}
 
+		private:
+
+			/// Rebuild the PID index of the active filters, call after every
+			/// start or stop of a filter
+			void updateDispatch_L() {
+				const std::vector<Dispatch> previous = std::move(_dispatch);
+				_dispatch.clear();
+				for (unsigned int demux = 0; demux < DEMUX_SIZE; ++demux) {
+					for (unsigned int filter = 0; filter < FILTER_SIZE; ++filter) {
+						if (_filterData[demux][filter].active()) {
+							_dispatch.push_back({_filterData[demux][filter].getAssociatedPID(),
+								static_cast<uint8_t>(demux), static_cast<uint8_t>(filter)});
+						}
+					}
+				}
+				// Keep the demux and filter order within a PID
+				std::stable_sort(_dispatch.begin(), _dispatch.end(),
+					[](const Dispatch &a, const Dispatch &b) {
+						return a.pid < b.pid;
+					});
+				// Add the new PIDs, then remove the PIDs that have no filter
+				// anymore, so the PIDs that stay are never missing
+				for (const Dispatch &entry : _dispatch) {
+					_pids.setPID(entry.pid, true);
+				}
+				for (const Dispatch &entry : previous) {
+					if (!hasDispatch_L(entry.pid)) {
+						_pids.setPID(entry.pid, false);
+					}
+				}
+			}
+
+			/// Check if @p pid has an active filter in the PID index
+			bool hasDispatch_L(const int pid) const {
+				return std::binary_search(_dispatch.begin(), _dispatch.end(), Dispatch{pid, 0, 0},
+					[](const Dispatch &a, const Dispatch &b) {
+						return a.pid < b.pid;
+					});
+			}
+
 			// =======================================================================
 			//  -- Data members ------------------------------------------------------
 			// =======================================================================
@@ -127,7 +195,19 @@ namespace decrypt::dvbapi {
 			static constexpr unsigned int DEMUX_SIZE  = 25;
 			static constexpr unsigned int FILTER_SIZE = 15;
 
+			/// One active filter in the PID index
+			struct Dispatch {
+				int pid;
+				uint8_t demux;
+				uint8_t filter;
+			};
+
 			base::Mutex _mutex;
+			/// The PIDs that have at least one active filter
+			mpegts::PidMask _pids;
+			/// The active filters sorted by PID
+			std::vector<Dispatch> _dispatch;
+			mpegts::SpSectionArena _sectionArena;
 			FilterData _filterData[DEMUX_SIZE][FILTER_SIZE];
 	};
 
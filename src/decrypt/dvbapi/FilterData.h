@@ -26,9 +26,18 @@
 #include <cstring>
 #include <cstdint>
 
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define DECRYPT_DVBAPI_FILTERDATA_NEON
+#endif
+
 namespace decrypt::dvbapi {
 
-	/// The class @c FilterData carries all filter data for OSCam
+	/// The class @c FilterData carries all filter data for OSCam. The filter
+	/// bytes are compared with the section header 16 bytes at a time, with
+	/// SSE2 or NEON when available
 	class FilterData {
 		public:
 
@@ -55,9 +64,17 @@ namespace decrypt::dvbapi {
 				_collecting = false;
 				std::memset(_data, 0x00, 16);
 				std::memset(_mask, 0x00, 16);
+				std::memset(_matchData, 0x00, 16);
+				std::memset(_matchMask, 0x00, 16);
+				_lastMaskedOffset = 0;
 				_tableData.clear();
 			}
 
+			/// Set the arena where the table data is assembled
+			void setSectionArena(mpegts::SpSectionArena arena) {
+				_tableData.setSectionArena(arena);
+			}
+
 			/// Collect Table data for tableID
 			void collectRawTableData(const FeID id, const int tableID, const unsigned char* data, bool trace) {
 				_tableData.collectRawData(id, tableID, data, trace);
@@ -103,30 +120,56 @@ namespace decrypt::dvbapi {
 				_tableData.clear();
 				std::memcpy(_data, data, 16);
 				std::memcpy(_mask, mask, 16);
+				// Filter byte 0 is the table ID at packet offset 5, the others
+				// are compared with packet offset 8 (after the section length)
+				// and up, so _matchData[j] is for packet offset 7 + j
+				_lastMaskedOffset = 0;
+				for (unsigned int i = 0; i < 16; ++i) {
+					_matchMask[i] = (i == 0) ? 0x00 : _mask[i];
+					_matchData[i] = _data[i] & _matchMask[i];
+					if (_mask[i] != 0x00) {
+						_lastMaskedOffset = (i == 0) ? 5 : i + 7;
+					}
+				}
 			}
 
 			/// Check if the requested data matches this filter or if we already collecting
 			bool matchOrCollecting(const unsigned char* data) const {
 				if (!_collecting) {
-					bool match = true;
 					const uint32_t sectionLength = (((data[6] & 0x0F) << 8) | data[7]) + 3; // 3 = tableID + length field
-					uint32_t i, k;
-					for (i = 0, k = 5; i < 16 && match; ++i, ++k) {
-						// skip sectionLength bytes
-						if (k == 6) {
-							k += 2;
-						}
-						const unsigned char mask = _mask[i];
-						if (mask != 0x00) {
-							const unsigned char filter = (_data[i] & mask);
-							match = (k <= sectionLength) ? (filter == (data[k] & mask)) : false;
-						}
-					}
-					_collecting = (match && i == 16);
+					// The masked bytes should all be in the section
+					_collecting = _lastMaskedOffset <= sectionLength &&
+						((data[5] ^ _data[0]) & _mask[0]) == 0 && matchSectionHeader(data + 7);
 				}
 				return _collecting;
 			}
 
+		private:
+
+			/// Compare the 16 bytes at @p header with filter bytes 1 - 15
+			bool matchSectionHeader(const unsigned char* header) const {
+#if defined(__SSE2__)
+				const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(header));
+				const __m128i diff = _mm_and_si128(_mm_xor_si128(bytes,
+					_mm_load_si128(reinterpret_cast<const __m128i *>(_matchData))),
+					_mm_load_si128(reinterpret_cast<const __m128i *>(_matchMask)));
+				return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(DECRYPT_DVBAPI_FILTERDATA_NEON)
+				const uint8x16_t diff = vandq_u8(veorq_u8(vld1q_u8(header),
+					vld1q_u8(_matchData)), vld1q_u8(_matchMask));
+				const uint64x2_t words = vreinterpretq_u64_u8(diff);
+				return (vgetq_lane_u64(words, 0) | vgetq_lane_u64(words, 1)) == 0;
+#else
+				uint64_t bytes[2];
+				uint64_t data[2];
+				uint64_t mask[2];
+				std::memcpy(bytes, header, 16);
+				std::memcpy(data, _matchData, 16);
+				std::memcpy(mask, _matchMask, 16);
+				return (((bytes[0] ^ data[0]) & mask[0]) | ((bytes[1] ^ data[1]) & mask[1])) == 0;
+#endif
+			}
+
 			// =======================================================================
 			//  -- Data members ------------------------------------------------------
 			// =======================================================================
@@ -138,6 +181,11 @@ namespace decrypt::dvbapi {
 			int _pid;
 			unsigned char _data[16];
 			unsigned char _mask[16];
+			/// The filter for packet offset 7 up to 22, already masked
+			alignas(16) unsigned char _matchData[16];
+			alignas(16) unsigned char _matchMask[16];
+			/// The highest packet offset with a filter mask
+			uint32_t _lastMaskedOffset;
 			mpegts::TableData _tableData;
 			mutable bool _collecting = false;
 	};
@@ -21,67 +21,100 @@
 
 #include <Unused.h>
 
-extern "C" {
-	#include <dvbcsa/dvbcsa.h>
-	void dvbcsa_bs_key_set_ecm(unsigned char ecm, const dvbcsa_cw_t cw, struct dvbcsa_bs_key_s *key) __attribute__((weak));
-}
+#include <algorithm>
+#include <cstring>
 
 namespace decrypt::dvbapi {
 
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+Keys::Keys() :
+	_slot(new KeySlot),
+	_epoch(0),
+	_quiescentEpoch(0),
+	_readerActive(false) {}
+
+Keys::~Keys() {
+	base::MutexLock lock(_mutex);
+	reclaim_L(true);
+	delete _slot.load();
+}
+
 // =============================================================================
 //  -- Other member functions --------------------------------------------------
 // =============================================================================
 
-void Keys::set(const unsigned char* cw, unsigned int parity, int UNUSED(index), const bool icamEnabled) {
-	dvbcsa_bs_key_s* k = dvbcsa_bs_key_alloc();
+bool Keys::set(const descrambler::Descrambler &descrambler, const unsigned char* cw,
+		const std::size_t length, unsigned int parity, int UNUSED(index)) {
+	base::MutexLock lock(_mutex);
 	const unsigned char icamECM = (_icam[parity].size() > 0) ? _icam[parity].back() : 0;
-	if (icamEnabled) {
-		dvbcsa_bs_key_set_ecm(icamECM, cw, k);
-	} else {
-		dvbcsa_bs_key_set(cw, k);
-	}
-	_key[parity].push(std::make_tuple(base::TimeCounter::getTicks(), k));
-	while (_key[parity].size() > 1) {
-		remove(parity);
+	KeyPtr key = descrambler.makeKey(cw, length, _ivSet[parity] ? _iv[parity] : nullptr, icamECM);
+	if (!key) {
+		return false;
 	}
+	// Copy the active slot, with the new key for this parity
+	KeySlot *slot = new KeySlot(*_slot.load(std::memory_order_relaxed));
+	slot->key[parity] = key;
+	publish_L(slot);
+	reclaim_L(false);
+	return true;
 }
 
 void Keys::setICAM(const unsigned char ecm, unsigned int parity) {
+	base::MutexLock lock(_mutex);
 	_icam[parity].push(ecm);
 	while (_icam[parity].size() > 1) {
 		_icam[parity].pop();
 	}
 }
 
-const dvbcsa_bs_key_s* Keys::get(unsigned int parity) const {
-	if (!_key[parity].empty()) {
-		const KeyTuple tup = _key[parity].back();
-//		const long duration = base::TimeCounter::getTicks() - pair.first;
-		return std::get<1>(tup);
-	} else {
-		return nullptr;
-	}
+void Keys::setIV(const unsigned char* iv, unsigned int parity) {
+	base::MutexLock lock(_mutex);
+	std::memcpy(_iv[parity], iv, sizeof(_iv[parity]));
+	_ivSet[parity] = true;
 }
 
 void Keys::freeKeys() {
-	while (!_key[0].empty()) {
-		remove(0);
-	}
-	while (!_key[1].empty()) {
-		remove(1);
-	}
+	base::MutexLock lock(_mutex);
+	publish_L(new KeySlot);
+	reclaim_L(true);
 	while (_icam[0].size() > 1) {
 		_icam[0].pop();
 	}
 	while (_icam[1].size() > 1) {
 		_icam[1].pop();
 	}
+	_ivSet[0] = false;
+	_ivSet[1] = false;
+}
+
+void Keys::publish_L(const KeySlot *slot) {
+	const KeySlot *old = _slot.exchange(slot, std::memory_order_acq_rel);
+	// A reader that sees this epoch at its quiescent point, loads the new
+	// slot after it, so it does not use the old one anymore
+	const uint64_t epoch = _epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+	_retired.emplace_back(old, epoch);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 }
 
-void Keys::remove(unsigned int parity) {
-	const KeyTuple tup = _key[parity].front();
-	dvbcsa_bs_key_free(std::get<1>(tup));
-	_key[parity].pop();
+void Keys::reclaim_L(bool all) {
+	// A reader that is not active (paused or not decrypting) does not use any
+	// retired slot, and it gets the active slot when it enters again. So then
+	// reclaim all, or the list keeps growing while the reader is away
+	all = all || !_readerActive.load(std::memory_order_acquire);
+	const uint64_t quiescent = _quiescentEpoch.load(std::memory_order_acquire);
+	const auto it = std::remove_if(_retired.begin(), _retired.end(),
+		[all, quiescent](const std::pair<const KeySlot *, uint64_t> &retired) {
+			if (all || retired.second <= quiescent) {
+				// The keys are freed when the last decrypt batch using them is finished
+				delete retired.first;
+				return true;
+			}
+			return false;
+		});
+	_retired.erase(it, _retired.end());
 }
 
 }
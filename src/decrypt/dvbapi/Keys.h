@@ -21,57 +21,117 @@
 #define DECRYPT_DVBAPI_KEYS_H_INCLUDE DECRYPT_DVBAPI_KEYS_H_INCLUDE
 
 #include <FwDecl.h>
-#include <base/TimeCounter.h>
-#include <Log.h>
+#include <base/Mutex.h>
+#include <decrypt/descrambler/Descrambler.h>
 
-#include <utility>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <queue>
-#include <tuple>
-
-FW_DECL_NS0(dvbcsa_bs_key_s);
+#include <utility>
+#include <vector>
 
 namespace decrypt::dvbapi {
 
-///
+/// The class @c Keys hands the even and odd keys from the dvbapi thread to
+/// the reader thread of the frontend. The active keys are in an immutable
+/// @c KeySlot that is replaced as a whole, so the reader gets both keys with
+/// one atomic load and without a lock. A replaced slot is reclaimed when the
+/// reader passed a quiescent point (epoch based), the keys itself live on
+/// in the decrypt batches that still use them.
 class Keys {
 	public:
-		using KeyTuple = std::tuple<long, dvbcsa_bs_key_s *>;
-		using KeyQueue = std::queue<KeyTuple>;
+		/// A key stays alive as long as a decrypt batch is using it
+		using KeyPtr = descrambler::SpKey;
 		using ICAMQueue = std::queue<unsigned char>;
 
+		/// The keys that are active at one moment, it is not changed
+		/// anymore after it is published
+		struct KeySlot {
+			KeyPtr key[2];
+		};
+
 		// =========================================================================
 		//  -- Constructors and destructor -----------------------------------------
 		// =========================================================================
 	public:
 
-		Keys() = default;
+		Keys();
 
-		virtual ~Keys() = default;
+		virtual ~Keys();
+
+		Keys(const Keys&) = delete;
+
+		Keys& operator=(const Keys&) = delete;
 
 		// =========================================================================
 		//  -- Other member functions ----------------------------------------------
 		// =========================================================================
 	public:
 
-		void set(const unsigned char* cw, unsigned int parity, int index, bool icamEnabled);
+		/// Set the 'next' key for @p parity, made by @p descrambler
+		/// @return false if the length of @p cw is wrong for @p descrambler
+		bool set(const descrambler::Descrambler &descrambler, const unsigned char* cw,
+			std::size_t length, unsigned int parity, int index);
 
 		void setICAM(const unsigned char ecm, unsigned int parity);
 
-		const dvbcsa_bs_key_s *get(unsigned int parity) const;
-
+		/// Set the IV that is used for the next keys of @p parity
+		void setIV(const unsigned char* iv, unsigned int parity);
+
+		/// Get the active key for @p parity, only for the reader thread. The
+		/// reference is valid until it calls @c quiescent()
+		const KeyPtr &get(unsigned int parity) const noexcept {
+			return _slot.load(std::memory_order_acquire)->key[parity];
+		}
+
+		/// The reader thread calls this before it uses @c get(). Until then
+		/// the writers may reclaim all replaced slots right away
+		void enter() noexcept {
+			_readerActive.store(true, std::memory_order_relaxed);
+			// Pairs with the fence in publish_L, so either the writer sees the
+			// reader is active, or the reader sees the new slot
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+
+		/// The reader thread calls this when it does not use any key it got
+		/// from @c get() anymore, so the replaced slots can be reclaimed
+		void quiescent() noexcept {
+			_quiescentEpoch.store(_epoch.load(std::memory_order_acquire), std::memory_order_release);
+			_readerActive.store(false, std::memory_order_release);
+		}
+
+		/// Remove all keys, only call this when the reader thread is stopped
+		/// or paused
 		void freeKeys();
 
 	private:
 
-		void remove(unsigned int parity);
+		/// Publish @p slot as the active slot and retire the current one
+		void publish_L(const KeySlot *slot);
+
+		/// Reclaim the retired slots the reader can not use anymore, all of
+		/// them when the reader is not active
+		/// @param all specifies to reclaim all, because the reader is stopped
+		void reclaim_L(bool all);
 
 		// =====================================================================
 		//  -- Data members ----------------------------------------------------
 		// =====================================================================
 	private:
 
-		KeyQueue _key[2];
+		/// Serializes the writers, the reader does not use it
+		base::Mutex _mutex;
+		std::atomic<const KeySlot *> _slot;
+		std::atomic<uint64_t> _epoch;
+		std::atomic<uint64_t> _quiescentEpoch;
+		std::atomic_bool _readerActive;
+		/// The replaced slots with the epoch they were replaced in
+		std::vector<std::pair<const KeySlot *, uint64_t>> _retired;
 		ICAMQueue _icam[2];
+		unsigned char _iv[2][16];
+		bool _ivSet[2] = { false, false };
 };
 
 }
@@ -0,0 +1,151 @@
+/* WorkerPool.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <decrypt/dvbapi/WorkerPool.h>
+
+#include <Log.h>
+#include <StringConverter.h>
+#include <base/CPUSet.h>
+#include <base/ThreadPlacement.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace decrypt::dvbapi {
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+WorkerPool::WorkerPool() :
+	_maxQueued(0) {}
+
+WorkerPool::~WorkerPool() {
+	resize(0);
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+unsigned int WorkerPool::getDefaultSize() {
+	// Keep half of the CPUs for reading and sending
+	const unsigned int cpus = base::CPUSet::getOnline().size();
+	return std::min(cpus / 2, MAX_DEFAULT_SIZE);
+}
+
+void WorkerPool::resize(const unsigned int size) {
+	std::vector<std::unique_ptr<base::Thread>> threads;
+	base::SpThreadPlacement placement;
+	{
+		base::MutexLock lock(_mutex);
+		if (_threads.size() == size) {
+			return;
+		}
+		// From here new jobs are decrypted directly by the caller
+		threads.swap(_threads);
+		placement = _threadPlacement;
+	}
+	for (std::unique_ptr<base::Thread> &thread : threads) {
+		thread->terminateThread();
+	}
+	// Finish the jobs the stopped threads left behind
+	for (;;) {
+		Job job;
+		{
+			base::MutexLock lock(_mutex);
+			if (_jobs.empty()) {
+				break;
+			}
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+		job();
+	}
+	threads.clear();
+	for (unsigned int i = 0; i < size; ++i) {
+		std::unique_ptr<base::Thread> thread(new base::Thread(
+			StringConverter::stringFormat("Decrypt@#1", i),
+			std::bind(&WorkerPool::threadExecuteWorker, this)));
+		if (placement) {
+			placement->placeDecryptThread(*thread);
+		}
+		thread->startThread();
+		threads.push_back(std::move(thread));
+	}
+	{
+		base::MutexLock lock(_mutex);
+		_threads.swap(threads);
+	}
+	SI_LOG_INFO("Decrypting with @#1 decrypt thread(s)", size);
+}
+
+unsigned int WorkerPool::size() const {
+	base::MutexLock lock(_mutex);
+	return _threads.size();
+}
+
+void WorkerPool::setThreadPlacement(base::SpThreadPlacement placement) {
+	base::MutexLock lock(_mutex);
+	_threadPlacement = placement;
+	for (std::unique_ptr<base::Thread> &thread : _threads) {
+		_threadPlacement->placeDecryptThread(*thread);
+	}
+}
+
+void WorkerPool::submit(Job job) {
+	{
+		base::MutexLock lock(_mutex);
+		if (!_threads.empty()) {
+			_jobs.push_back(std::move(job));
+			_maxQueued = std::max(_maxQueued, _jobs.size());
+			_cond.notify_one();
+			return;
+		}
+	}
+	job();
+}
+
+std::size_t WorkerPool::getQueued() const {
+	base::MutexLock lock(_mutex);
+	return _jobs.size();
+}
+
+std::size_t WorkerPool::getMaxQueued() const {
+	base::MutexLock lock(_mutex);
+	return _maxQueued;
+}
+
+bool WorkerPool::threadExecuteWorker() {
+	Job job;
+	{
+		base::MutexLock lock(_mutex);
+		// Wake up now and then, so the thread can be stopped
+		if (!_cond.wait_for(_mutex, std::chrono::milliseconds(50),
+				[this]() { return !_jobs.empty(); })) {
+			return true;
+		}
+		job = std::move(_jobs.front());
+		_jobs.pop_front();
+	}
+	job();
+	return true;
+}
+
+}
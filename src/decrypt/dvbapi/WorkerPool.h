@@ -0,0 +1,115 @@
+/* WorkerPool.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#ifndef DECRYPT_DVBAPI_WORKER_POOL_H_INCLUDE
+#define DECRYPT_DVBAPI_WORKER_POOL_H_INCLUDE DECRYPT_DVBAPI_WORKER_POOL_H_INCLUDE
+
+#include <FwDecl.h>
+#include <base/Mutex.h>
+#include <base/Thread.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+FW_DECL_SP_NS1(base, ThreadPlacement);
+
+namespace decrypt::dvbapi {
+
+/// The class @c WorkerPool runs the decrypt batches of all frontends on a
+/// couple of decrypt threads, so the reader threads of the streams do not
+/// stall on the CSA calculation. Batches are taken in order, but may finish
+/// out of order, the decrypt pending flags of the PacketBuffers keep the
+/// ring slots in order. Without threads the batches are decrypted directly
+/// on the calling thread.
+class WorkerPool {
+	public:
+
+		using Job = std::function<void()>;
+
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		WorkerPool();
+
+		virtual ~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get the default amount of decrypt threads for this system
+		static unsigned int getDefaultSize();
+
+		/// Start @p size decrypt threads, 0 decrypts on the calling thread.
+		/// The jobs that are still waiting are finished first
+		void resize(unsigned int size);
+
+		/// Get the amount of decrypt threads
+		unsigned int size() const;
+
+		/// Set the placement of the decrypt threads, also for the threads
+		/// that are started later
+		void setThreadPlacement(base::SpThreadPlacement placement);
+
+		/// Run @p job on one of the decrypt threads, or directly when there
+		/// are none
+		void submit(Job job);
+
+		/// Get the amount of jobs waiting for a decrypt thread
+		std::size_t getQueued() const;
+
+		/// Get the highest amount of jobs that were waiting
+		std::size_t getMaxQueued() const;
+
+	private:
+
+		/// Thread execute function @see base::Thread should @return true to
+		/// keep thread running and @return false will stop and then terminate this thread
+		bool threadExecuteWorker();
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		static constexpr unsigned int MAX_DEFAULT_SIZE = 4;
+
+		base::Mutex _mutex;
+		/// The decrypt threads wait on this for a job, it is the only
+		/// condition variable that works with a base::Mutex
+		std::condition_variable_any _cond;
+		std::deque<Job> _jobs;
+		std::size_t _maxQueued;
+		std::vector<std::unique_ptr<base::Thread>> _threads;
+		base::SpThreadPlacement _threadPlacement;
+};
+
+}
+
+#endif // DECRYPT_DVBAPI_WORKER_POOL_H_INCLUDE
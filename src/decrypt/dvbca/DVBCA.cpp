@@ -161,10 +161,12 @@ static char fileFIFO[] = "/tmp/fifo";
 			0xF0, 0x00   // 4b-res 12b-ES_info_length (00)
 		};
 */
-		mpegts::PMT::Data tableData;
-		pmt.getDataForSectionNumber(0, tableData);
+		const mpegts::PMT::Data *tableData = pmt.getDataForSectionNumber(0);
+		if (tableData == nullptr) {
+			return false;
+		}
 		const int programNumber = pmt.getProgramNumber();
-		const unsigned char* data = tableData.data.data();
+		const unsigned char* data = tableData->data.data();
 		const std::size_t tableSize = (data[6] & 0x0F) | data[7];
 		const mpegts::TSData progInfo = pmt.getProgramInfo();
 		const std::size_t progSize = progInfo.size();
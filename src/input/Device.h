@@ -26,6 +26,7 @@
 #include <input/InputSystem.h>
 #include <mpegts/Filter.h>
 
+#include <cstddef>
 #include <string>
 #include <utility>
 
@@ -70,6 +71,14 @@ class Device :
 		/// @param buffer this is the buffer were to wirite to
 		virtual bool readTSPackets(mpegts::PacketBuffer& buffer) = 0;
 
+		/// Read the available data from this device into consecutive buffers
+		/// @param buffers this is the first buffer were to write to
+		/// @param count the amount of consecutive buffers that may be written
+		/// @return the amount of buffers that are completely filled
+		virtual std::size_t readTSPackets(mpegts::PacketBuffer* buffers, std::size_t count) {
+			return (count > 0 && readTSPackets(*buffers)) ? 1 : 0;
+		}
+
 		/// Check the capability of this device
 		/// @param system specifies the input system that this device is capable of
 		virtual bool capableOf(input::InputSystem system) const = 0;
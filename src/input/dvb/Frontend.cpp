@@ -32,6 +32,7 @@
 #include <input/dvb/delivery/DVBT.h>
 #include <input/dvb/delivery/DiSEqc.h>
 
+#include <array>
 #include <chrono>
 #include <thread>
 
@@ -44,6 +45,7 @@
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <base/StopWatch.h>
 
@@ -57,6 +59,8 @@ static constexpr unsigned int DEFAULT_DVR_BUFFER_SIZE       = 3;
 static constexpr unsigned int MAX_DVR_BUFFER_SIZE           = 3 * 10;
 static constexpr unsigned long MAX_WAIT_ON_LOCK_TIMEOUT     = 3500;
 static constexpr unsigned long DEFAULT_WAIT_ON_LOCK_TIMEOUT = 1000;
+static constexpr std::size_t MAX_DVR_READ_BATCH             = 32;
+static constexpr std::size_t DEFAULT_DVR_READ_BATCH         = 16;
 
 // =============================================================================
 // -- Constructors and destructor ----------------------------------------------
@@ -67,7 +71,8 @@ Frontend::Frontend(
 		const std::string &appDataPath,
 		const std::string &fe,
 		const std::string &dvr,
-		const std::string &dmx) :
+		const std::string &dmx,
+		const bool simulate) :
 	Device(index),
 	_tuned(false),
 	_fd_fe(-1),
@@ -76,6 +81,7 @@ Frontend::Frontend(
 	_path_to_dvr(dvr),
 	_path_to_dmx(dmx),
 	_dvbVersion(0),
+	_simulator(simulate ? std::make_unique<FrontendSimulator>() : nullptr),
 	_transform(appDataPath),
 	_dvbs(0),
 	_dvbs2(0),
@@ -84,7 +90,9 @@ Frontend::Frontend(
 	_dvbc(0),
 	_dvbc2(0),
 	_dvrBufferSizeMB(DEFAULT_DVR_BUFFER_SIZE),
-	_waitOnLockTimeout(DEFAULT_WAIT_ON_LOCK_TIMEOUT) {
+	_dvrReadBatch(DEFAULT_DVR_READ_BATCH),
+	_waitOnLockTimeout(DEFAULT_WAIT_ON_LOCK_TIMEOUT),
+	_tunerSharing(true) {
 	snprintf(_fe_info.name, sizeof(_fe_info.name), "Not Set");
 	setupFrontend();
 #if FULL_DVB_API_VERSION >= 0x050A
@@ -116,13 +124,13 @@ namespace {
 		const std::string fe0 = StringConverter::stringFormat(FRONTEND.data(), 0, 0);
 		const std::string dvr0 = StringConverter::stringFormat(DVR.data(), 0, 0);
 		const std::string dmx0 = StringConverter::stringFormat(DMX.data(), 0, 0);
-		input::dvb::SpFrontend frontend0 = std::make_shared<input::dvb::Frontend>(0, appDataPath, fe0, dvr0, dmx0);
+		input::dvb::SpFrontend frontend0 = std::make_shared<input::dvb::Frontend>(0, appDataPath, fe0, dvr0, dmx0, false);
 		streamVector.push_back(Stream::makeSP(frontend0, decrypt));
 
 		const std::string fe1 = StringConverter::stringFormat(FRONTEND.data(), 1, 0);
 		const std::string dvr1 = StringConverter::stringFormat(DVR.data(), 1, 0);
 		const std::string dmx1 = StringConverter::stringFormat(DMX.data(), 1, 0);
-		input::dvb::SpFrontend frontend1 = std::make_shared<input::dvb::Frontend>(1, appDataPath, fe1, dvr1, dmx1);
+		input::dvb::SpFrontend frontend1 = std::make_shared<input::dvb::Frontend>(1, appDataPath, fe1, dvr1, dmx1, false);
 		streamVector.push_back(Stream::makeSP(frontend1, decrypt));
 	#else
 		dirent **file_list;
@@ -148,7 +156,7 @@ namespace {
 
 								// Make new frontend here
 								const StreamSpVector::size_type size = streamVector.size();
-								const input::dvb::SpFrontend frontend = std::make_shared<input::dvb::Frontend>(size, appDataPath, fe, dvr, dmx);
+								const input::dvb::SpFrontend frontend = std::make_shared<input::dvb::Frontend>(size, appDataPath, fe, dvr, dmx, false);
 								streamVector.push_back(Stream::makeSP(frontend, decrypt));
 							}
 							break;
@@ -178,12 +186,26 @@ void Frontend::enumerate(
 		StreamSpVector &streamVector,
 		const std::string &appDataPath,
 		decrypt::dvbapi::SpClient decrypt,
-		const std::string &dvbAdapterPath) {
+		const std::string &dvbAdapterPath,
+		const int numberOfSimulatedFrontends) {
 	const StreamSpVector::size_type beginSize = streamVector.size();
 	SI_LOG_INFO("Detecting frontends in: @#1", dvbAdapterPath);
 	getAttachedFrontends(streamVector, appDataPath, decrypt, dvbAdapterPath, dvbAdapterPath);
 	const StreamSpVector::size_type endSize = streamVector.size();
 	SI_LOG_INFO("Frontends found: @#1", endSize - beginSize);
+
+	// Add the simulated frontends, these do not need any hardware
+	for (int i = 0; i < numberOfSimulatedFrontends; ++i) {
+		const std::string fe = StringConverter::stringFormat("simulation/frontend@#1", i);
+		const std::string dvr = StringConverter::stringFormat("simulation/dvr@#1", i);
+		const std::string dmx = StringConverter::stringFormat("simulation/demux@#1", i);
+		const StreamSpVector::size_type size = streamVector.size();
+		const input::dvb::SpFrontend frontend = std::make_shared<input::dvb::Frontend>(size, appDataPath, fe, dvr, dmx, true);
+		streamVector.push_back(Stream::makeSP(frontend, decrypt));
+	}
+	if (numberOfSimulatedFrontends > 0) {
+		SI_LOG_INFO("Frontends simulated: @#1", numberOfSimulatedFrontends);
+	}
 }
 
 // =============================================================================
@@ -198,8 +220,10 @@ void Frontend::doAddToXML(std::string &xml) const {
 	ADD_XML_ELEMENT(xml, "dvbversion", HEX(_dvbVersion, 4));
 
 	ADD_XML_NUMBER_INPUT(xml, "dvrbuffer", _dvrBufferSizeMB, 0, MAX_DVR_BUFFER_SIZE);
+	ADD_XML_NUMBER_INPUT(xml, "dvrReadBatch", _dvrReadBatch, 1, MAX_DVR_READ_BATCH);
 	ADD_XML_NUMBER_INPUT(xml, "waitOnLockTimeout", _waitOnLockTimeout, 0, MAX_WAIT_ON_LOCK_TIMEOUT);
 	ADD_XML_CHECKBOX(xml, "forceOldStyleStatus", (_oldApiCallStats ? "true" : "false"));
+	ADD_XML_CHECKBOX(xml, "tunerSharing", (_tunerSharing ? "true" : "false"));
 
 #ifdef LIBDVBCSA
 	_dvbapiData.addToXML(xml);
@@ -210,6 +234,10 @@ void Frontend::doAddToXML(std::string &xml) const {
 
 	ADD_XML_ELEMENT(xml, "transformation", _transform.toXML());
 
+	if (_simulator) {
+		ADD_XML_ELEMENT(xml, "simulation", _simulator->toXML());
+	}
+
 	for (std::size_t i = 0; i < _deliverySystem.size(); ++i) {
 		ADD_XML_N_ELEMENT(xml, "deliverySystem", i, _deliverySystem[i]->toXML());
 	}
@@ -222,6 +250,10 @@ void Frontend::doFromXML(const std::string &xml) {
 		_dvrBufferSizeMB = (newSize < MAX_DVR_BUFFER_SIZE) ?
 			newSize : DEFAULT_DVR_BUFFER_SIZE;
 	}
+	if (findXMLElement(xml, "dvrReadBatch.value", element)) {
+		const std::size_t batch = std::stoi(element);
+		_dvrReadBatch = (batch < 1) ? 1 : ((batch < MAX_DVR_READ_BATCH) ? batch : MAX_DVR_READ_BATCH);
+	}
 	if (findXMLElement(xml, "waitOnLockTimeout.value", element)) {
 		const unsigned int c = std::stoi(element);
 		_waitOnLockTimeout = (c < MAX_WAIT_ON_LOCK_TIMEOUT) ? c : MAX_WAIT_ON_LOCK_TIMEOUT;
@@ -229,6 +261,9 @@ void Frontend::doFromXML(const std::string &xml) {
 	if (findXMLElement(xml, "forceOldStyleStatus.value", element)) {
 		_oldApiCallStats = (element == "true") ? true : false;
 	}
+	if (findXMLElement(xml, "tunerSharing.value", element)) {
+		_tunerSharing = (element == "true") ? true : false;
+	}
 	for (std::size_t i = 0; i < _deliverySystem.size(); ++i) {
 		const std::string deliverySystem = StringConverter::stringFormat("deliverySystem@#1", i);
 		if (findXMLElement(xml, deliverySystem, element)) {
@@ -238,6 +273,12 @@ void Frontend::doFromXML(const std::string &xml) {
 	if (findXMLElement(xml, "transformation", element)) {
 		_transform.fromXML(element);
 	}
+	if (_simulator && findXMLElement(xml, "simulation", element)) {
+		_simulator->fromXML(element);
+	}
+#ifdef LIBDVBCSA
+	_dvbapiData.fromXML(xml);
+#endif
 	_frontendData.fromXML(xml);
 }
 
@@ -259,11 +300,20 @@ void Frontend::addDeliverySystemCount(
 }
 
 bool Frontend::isDataAvailable() {
+#ifdef LIBDVBCSA
+	// Wake up in time for the deadline of the pending decrypt batch
+	const int timeout = _dvbapiData.getBatchWaitTime(100);
+#else
+	const int timeout = 100;
+#endif
+	if (_simulator) {
+		return _simulator->waitForData(timeout);
+	}
 	thread_local pollfd pfd;
 	pfd.fd = _fd_dmx;
 	pfd.events = POLLIN;
 	pfd.revents = 0;
-	const int pollRet = ::poll(&pfd, 1, 100);
+	const int pollRet = ::poll(&pfd, 1, timeout);
 	if (pollRet > 0) {
 		return (pfd.revents & POLLIN) == POLLIN;
 	} else if (pollRet < 0) {
@@ -275,6 +325,13 @@ bool Frontend::isDataAvailable() {
 }
 
 bool Frontend::readTSPackets(mpegts::PacketBuffer& buffer) {
+	if (_simulator) {
+		if (_simulator->read(&buffer, 1) == 1) {
+			_frontendData.getFilter().filterData(_feID, buffer, false);
+			return true;
+		}
+		return false;
+	}
 	// try read maximum amount of bytes from DMX
 	const auto readSize = ::read(_fd_dmx, buffer.getWriteBufferPtr(), buffer.getAmountOfBytesToWrite());
 	if (readSize > 0) {
@@ -292,6 +349,43 @@ bool Frontend::readTSPackets(mpegts::PacketBuffer& buffer) {
 	return false;
 }
 
+std::size_t Frontend::readTSPackets(mpegts::PacketBuffer* buffers, const std::size_t count) {
+	// Scatter one read from DMX over the consecutive buffers, the first one
+	// might still be partially filled from the previous read
+	const std::size_t cnt = (count < _dvrReadBatch) ? count : _dvrReadBatch;
+	if (_simulator) {
+		const std::size_t filled = _simulator->read(buffers, cnt);
+		_frontendData.getFilter().filterData(_feID, buffers, filled, false);
+		return filled;
+	}
+	std::array<iovec, MAX_DVR_READ_BATCH> iov;
+	for (std::size_t i = 0; i < cnt; ++i) {
+		iov[i].iov_base = buffers[i].getWriteBufferPtr();
+		iov[i].iov_len  = buffers[i].getAmountOfBytesToWrite();
+	}
+	const auto readSize = ::readv(_fd_dmx, iov.data(), cnt);
+	if (readSize > 0) {
+		std::size_t bytesLeft = readSize;
+		std::size_t filled = 0;
+		for (std::size_t i = 0; i < cnt && bytesLeft > 0; ++i) {
+			const std::size_t size = (bytesLeft < iov[i].iov_len) ? bytesLeft : iov[i].iov_len;
+			buffers[i].addAmountOfBytesWritten(size);
+			bytesLeft -= size;
+			if (buffers[i].full()) {
+				++filled;
+			}
+		}
+		// The full buffers are the first ones, filter them with one lock
+		_frontendData.getFilter().filterData(_feID, buffers, filled, false);
+		return filled;
+	} else if (readSize < 0) {
+		SI_LOG_PERROR("Frontend: @#1, Error reading data..", _feID);
+	} else {
+		SI_LOG_ERROR("Frontend: @#1, Error reading data: 0 Bytes available..", _feID);
+	}
+	return 0;
+}
+
 bool Frontend::capableOf(const input::InputSystem system) const {
 	for (const input::dvb::delivery::UpSystem& deliverySystem : _deliverySystem) {
 		if (deliverySystem->isCapableOf(system)) {
@@ -301,10 +395,13 @@ bool Frontend::capableOf(const input::InputSystem system) const {
 	return false;
 }
 
-bool Frontend::capableToShare(const TransportParamVector& UNUSED(params)) const {
-	// @TODO: Check if the same "channel" is requested for sharing this frontend
-	//        maybe check if sharing is allowed
-	return false;
+bool Frontend::capableToShare(const TransportParamVector& params) const {
+	// Only share a tuned frontend, and only when the same transponder is
+	// requested. Transformed requests are not compared, so do not share them
+	if (!_tunerSharing || !_tuned || _transform.isEnabled()) {
+		return false;
+	}
+	return _frontendData.isSameTransponder(params);
 }
 
 bool Frontend::capableToTransform(const TransportParamVector& params) const {
@@ -313,6 +410,9 @@ bool Frontend::capableToTransform(const TransportParamVector& params) const {
 }
 
 bool Frontend::isLockedByOtherProcess() const {
+	if (_simulator) {
+		return false;
+	}
 	int fd = ::open(_path_to_fe.data(), O_RDWR);
 	if (fd  < 0) {
 		return true;
@@ -322,6 +422,18 @@ bool Frontend::isLockedByOtherProcess() const {
 }
 
 bool Frontend::monitorSignal(const bool showStatus) {
+	if (_simulator) {
+		const fe_status_t status = _simulator->readStatus();
+		const bool locked = (status & FE_HAS_LOCK) == FE_HAS_LOCK;
+		const uint16_t strength = locked ? 214 : 0;
+		const uint16_t snr = locked ? 15 : 0;
+		if (showStatus) {
+			SI_LOG_INFO("status @#1 | signal @#2% | snr @#3% | ber @#4 | unc @#5 | Locked @#6",
+				HEX(status, 2), DIGIT(strength, 3), DIGIT(snr, 3), 0, 0, locked ? 1 : 0);
+		}
+		_frontendData.setMonitorData(status, strength, snr, 0, 0);
+		return locked;
+	}
 #if SIMU
 	(void)showStatus;
 	_frontendData.setMonitorData(FE_HAS_LOCK, 214, 15, 0, 0);
@@ -476,8 +588,10 @@ bool Frontend::teardown() {
 	closeActivePIDFilters();
 	_tuned = false;
 	// Do teardown of frontends before closing FE
-	for (const input::dvb::delivery::UpSystem& deliverySystem : _deliverySystem) {
-		deliverySystem->teardown(_fd_fe);
+	if (!_simulator) {
+		for (const input::dvb::delivery::UpSystem& deliverySystem : _deliverySystem) {
+			deliverySystem->teardown(_fd_fe);
+		}
 	}
 	closeDMX();
 	closeFE();
@@ -495,6 +609,10 @@ void Frontend::closeActivePIDFilters() {
 	_frontendData.getFilter().closeActivePIDFilters(_feID,
 		// closePid lambda function
 		[&](const int pid) {
+			if (_simulator) {
+				_simulator->removePID(pid);
+				return true;
+			}
 			uint16_t p = pid;
 			if (::ioctl(_fd_dmx, DMX_REMOVE_PID, &p) != 0) {
 				SI_LOG_PERROR("Frontend: @#1, DMX_REMOVE_PID: PID @#2", _feID, PID(p));
@@ -513,8 +631,14 @@ void Frontend::updatePIDFilters() {
 		// openPid lambda function
 		[&](const int pid) {
 			uint16_t p = pid;
+			if (_simulator) {
+				if (!_simulator->isDemuxOpen()) {
+					_simulator->openDemux(_dvrBufferSizeMB * 1024 * 1024);
+					SI_LOG_INFO("Frontend: @#1, Opened simulated @#2", _feID, _path_to_dmx);
+				}
+				_simulator->addPID(pid);
 			// Check if we have already a DMX open
-			if (_fd_dmx == -1) {
+			} else if (_fd_dmx == -1) {
 				// try opening DMX, try again if fails
 				std::size_t timeout = 0;
 				while ((_fd_dmx = openDMX(_path_to_dmx)) == -1) {
@@ -568,7 +692,9 @@ void Frontend::updatePIDFilters() {
 		// closePid lambda function
 		[&](const int pid) {
 			uint16_t p = pid;
-			if (::ioctl(_fd_dmx, DMX_REMOVE_PID, &p) != 0) {
+			if (_simulator) {
+				_simulator->removePID(pid);
+			} else if (::ioctl(_fd_dmx, DMX_REMOVE_PID, &p) != 0) {
 				SI_LOG_PERROR("Frontend: @#1, DMX_REMOVE_PID: PID @#2", _feID, PID(p));
 				return false;
 			}
@@ -582,99 +708,19 @@ void Frontend::updatePIDFilters() {
 // =============================================================================
 
 void Frontend::setupFrontend() {
-#if SIMU
-	sprintf(_fe_info.name, "Simulation DVB-S2/C/T Card");
-	_fe_info.frequency_min = 1000000UL;
-	_fe_info.frequency_max = 21000000UL;
-	_fe_info.symbol_rate_min = 20000UL;
-	_fe_info.symbol_rate_max = 250000UL;
-#else
-	// open frontend in readonly mode
-	int fd_fe = openFE(_path_to_fe, true);
-	if (fd_fe < 0) {
-		snprintf(_fe_info.name, sizeof(_fe_info.name), "Not Found");
-		SI_LOG_PERROR("openFE");
-		return;
-	}
-
-	if (::ioctl(fd_fe, FE_GET_INFO, &_fe_info) != 0) {
-		snprintf(_fe_info.name, sizeof(_fe_info.name), "Not Set");
-		SI_LOG_PERROR("FE_GET_INFO");
-		CLOSE_FD(fd_fe);
+	struct dtv_property dtvProperty[2];
+	if (_simulator) {
+		_simulator->getFrontendInfo(_fe_info, dtvProperty[0]);
+		dtvProperty[1].u.data = DTV_UNDEFINED;
+	} else if (!readFrontendInfo(dtvProperty)) {
 		return;
 	}
-#endif
 	SI_LOG_INFO("Frontend Name: @#1", _fe_info.name);
 	if (_oldApiCallStats) {
 		SI_LOG_INFO("Frontend Stat: Use legacy signal stats");
 	} else {
 		SI_LOG_INFO("Frontend Stat: Use advanced signal stats");
 	}
-	struct dtv_property dtvProperty[2];
-#if SIMU
-	dtvProperty[0].u.buffer.len = 4;
-	dtvProperty[0].u.buffer.data[0] = SYS_DVBS;
-	dtvProperty[0].u.buffer.data[1] = SYS_DVBS2;
-	dtvProperty[0].u.buffer.data[2] = SYS_DVBT;
-#  if FULL_DVB_API_VERSION >= 0x0505
-	dtvProperty[0].u.buffer.data[3] = SYS_DVBC_ANNEX_A;
-#  else
-	dtvProperty[0].u.buffer.data[3] = SYS_DVBC_ANNEX_AC;
-#  endif
-#else
-	dtvProperty[0].cmd    = DTV_ENUM_DELSYS;
-	dtvProperty[0].u.data = DTV_UNDEFINED;
-	dtvProperty[1].cmd    = DTV_API_VERSION;
-	dtvProperty[1].u.data = DTV_UNDEFINED;
-
-	struct dtv_properties dtvProperties;
-	dtvProperties.num = 2;
-	dtvProperties.props = dtvProperty;
-	if (::ioctl(fd_fe, FE_GET_PROPERTY, &dtvProperties ) != 0) {
-		// If we are here it can mean we have an DVB-API <= 5.4
-		SI_LOG_DEBUG("Unable to enumerate the delivery systems, retrying via old API Call");
-		auto index = 0;
-		switch (_fe_info.type) {
-			case FE_QPSK:
-				if (_fe_info.caps & FE_CAN_2G_MODULATION) {
-					dtvProperty[0].u.buffer.data[index] = SYS_DVBS2;
-					++index;
-				}
-				dtvProperty[0].u.buffer.data[index] = SYS_DVBS;
-				++index;
-				break;
-			case FE_OFDM:
-				if (_fe_info.caps & FE_CAN_2G_MODULATION) {
-					dtvProperty[0].u.buffer.data[index] = SYS_DVBT2;
-					++index;
-				}
-				dtvProperty[0].u.buffer.data[index] = SYS_DVBT;
-				++index;
-				break;
-			case FE_QAM:
-#  if FULL_DVB_API_VERSION >= 0x0505
-				dtvProperty[0].u.buffer.data[index] = SYS_DVBC_ANNEX_A;
-#  else
-				dtvProperty[0].u.buffer.data[index] = SYS_DVBC_ANNEX_AC;
-#  endif
-				++index;
-				break;
-			case FE_ATSC:
-				if (_fe_info.caps & (FE_CAN_QAM_64 | FE_CAN_QAM_256 | FE_CAN_QAM_AUTO)) {
-					dtvProperty[0].u.buffer.data[index] = SYS_DVBC_ANNEX_B;
-					++index;
-					break;
-				}
-			// Fall-through
-			default:
-				SI_LOG_ERROR("Frontend does not have any known delivery systems");
-				CLOSE_FD(fd_fe);
-				return;
-		}
-		dtvProperty[0].u.buffer.len = index;
-	}
-	CLOSE_FD(fd_fe);
-#endif
 	// get capability of this frontend and count the delivery systems
 	for (std::size_t i = 0; i < dtvProperty[0].u.buffer.len; ++i) {
 		const int deliveryType = dtvProperty[0].u.buffer.data[i];
@@ -756,6 +802,97 @@ void Frontend::setupFrontend() {
 	}
 }
 
+bool Frontend::readFrontendInfo(struct dtv_property (&dtvProperty)[2]) {
+#if SIMU
+	sprintf(_fe_info.name, "Simulation DVB-S2/C/T Card");
+	_fe_info.frequency_min = 1000000UL;
+	_fe_info.frequency_max = 21000000UL;
+	_fe_info.symbol_rate_min = 20000UL;
+	_fe_info.symbol_rate_max = 250000UL;
+#else
+	// open frontend in readonly mode
+	int fd_fe = openFE(_path_to_fe, true);
+	if (fd_fe < 0) {
+		snprintf(_fe_info.name, sizeof(_fe_info.name), "Not Found");
+		SI_LOG_PERROR("openFE");
+		return false;
+	}
+
+	if (::ioctl(fd_fe, FE_GET_INFO, &_fe_info) != 0) {
+		snprintf(_fe_info.name, sizeof(_fe_info.name), "Not Set");
+		SI_LOG_PERROR("FE_GET_INFO");
+		CLOSE_FD(fd_fe);
+		return false;
+	}
+#endif
+#if SIMU
+	dtvProperty[1].u.data = DTV_UNDEFINED;
+	dtvProperty[0].u.buffer.len = 4;
+	dtvProperty[0].u.buffer.data[0] = SYS_DVBS;
+	dtvProperty[0].u.buffer.data[1] = SYS_DVBS2;
+	dtvProperty[0].u.buffer.data[2] = SYS_DVBT;
+#  if FULL_DVB_API_VERSION >= 0x0505
+	dtvProperty[0].u.buffer.data[3] = SYS_DVBC_ANNEX_A;
+#  else
+	dtvProperty[0].u.buffer.data[3] = SYS_DVBC_ANNEX_AC;
+#  endif
+#else
+	dtvProperty[0].cmd    = DTV_ENUM_DELSYS;
+	dtvProperty[0].u.data = DTV_UNDEFINED;
+	dtvProperty[1].cmd    = DTV_API_VERSION;
+	dtvProperty[1].u.data = DTV_UNDEFINED;
+
+	struct dtv_properties dtvProperties;
+	dtvProperties.num = 2;
+	dtvProperties.props = dtvProperty;
+	if (::ioctl(fd_fe, FE_GET_PROPERTY, &dtvProperties ) != 0) {
+		// If we are here it can mean we have an DVB-API <= 5.4
+		SI_LOG_DEBUG("Unable to enumerate the delivery systems, retrying via old API Call");
+		auto index = 0;
+		switch (_fe_info.type) {
+			case FE_QPSK:
+				if (_fe_info.caps & FE_CAN_2G_MODULATION) {
+					dtvProperty[0].u.buffer.data[index] = SYS_DVBS2;
+					++index;
+				}
+				dtvProperty[0].u.buffer.data[index] = SYS_DVBS;
+				++index;
+				break;
+			case FE_OFDM:
+				if (_fe_info.caps & FE_CAN_2G_MODULATION) {
+					dtvProperty[0].u.buffer.data[index] = SYS_DVBT2;
+					++index;
+				}
+				dtvProperty[0].u.buffer.data[index] = SYS_DVBT;
+				++index;
+				break;
+			case FE_QAM:
+#  if FULL_DVB_API_VERSION >= 0x0505
+				dtvProperty[0].u.buffer.data[index] = SYS_DVBC_ANNEX_A;
+#  else
+				dtvProperty[0].u.buffer.data[index] = SYS_DVBC_ANNEX_AC;
+#  endif
+				++index;
+				break;
+			case FE_ATSC:
+				if (_fe_info.caps & (FE_CAN_QAM_64 | FE_CAN_QAM_256 | FE_CAN_QAM_AUTO)) {
+					dtvProperty[0].u.buffer.data[index] = SYS_DVBC_ANNEX_B;
+					++index;
+					break;
+				}
+			// Fall-through
+			default:
+				SI_LOG_ERROR("Frontend does not have any known delivery systems");
+				CLOSE_FD(fd_fe);
+				return false;
+		}
+		dtvProperty[0].u.buffer.len = index;
+	}
+	CLOSE_FD(fd_fe);
+#endif
+	return true;
+}
+
 int Frontend::openFE(const std::string &path, const bool readonly) const {
 	const int fd = ::open(path.data(), (readonly ? O_RDONLY : O_RDWR) | O_NONBLOCK);
 	if (fd  < 0) {
@@ -765,7 +902,9 @@ int Frontend::openFE(const std::string &path, const bool readonly) const {
 }
 
 void Frontend::closeFE() {
-	if (_fd_fe != -1) {
+	if (_simulator) {
+		_simulator->closeFrontend();
+	} else if (_fd_fe != -1) {
 		SI_LOG_INFO("Frontend: @#1, Closing @#2 fd: @#3", _feID, _path_to_fe, _fd_fe);
 		CLOSE_FD(_fd_fe);
 	}
@@ -780,7 +919,9 @@ int Frontend::openDMX(const std::string &path) const {
 }
 
 void Frontend::closeDMX() {
-	if (_fd_dmx != -1) {
+	if (_simulator) {
+		_simulator->closeDemux();
+	} else if (_fd_dmx != -1) {
 		SI_LOG_INFO("Frontend: @#1, Closing @#2 fd: @#3", _feID, _path_to_dmx, _fd_dmx);
 		CLOSE_FD(_fd_dmx);
 	}
@@ -790,7 +931,7 @@ bool Frontend::tune() {
 	const input::InputSystem delsys = _frontendData.getDeliverySystem();
 	for (input::dvb::delivery::UpSystem& system : _deliverySystem) {
 		if (system->isCapableOf(delsys)) {
-			return system->tune(_fd_fe, _frontendData);
+			return _simulator ? _simulator->tune(_frontendData) : system->tune(_fd_fe, _frontendData);
 		}
 	}
 	return false;
@@ -800,7 +941,7 @@ bool Frontend::setupAndTune() {
 	if (!_tuned) {
 		base::StopWatch sw;
 		// Check if we have already opened a FE
-		if (_fd_fe == -1) {
+		if (!_simulator && _fd_fe == -1) {
 			sw.start();
 			_fd_fe = openFE(_path_to_fe, false);
 			if (_fd_fe < 0) {
@@ -825,7 +966,7 @@ bool Frontend::setupAndTune() {
 			for (int i = 1;; ++i) {
 				fe_status_t status = FE_TIMEDOUT;
 				// first read status
-				if (::ioctl(_fd_fe, FE_READ_STATUS, &status) == 0) {
+				if (readFrontendStatus(status)) {
 					if (status & FE_HAS_LOCK) {
 						// We are tuned now, add some tuning stats
 						_frontendData.setMonitorData(FE_HAS_LOCK, 100, 8, 0, 0);
@@ -852,4 +993,12 @@ bool Frontend::setupAndTune() {
 	return _tuned;
 }
 
+bool Frontend::readFrontendStatus(fe_status_t &status) const {
+	if (_simulator) {
+		status = _simulator->readStatus();
+		return true;
+	}
+	return ::ioctl(_fd_fe, FE_READ_STATUS, &status) == 0;
+}
+
 }
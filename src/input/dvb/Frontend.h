@@ -26,6 +26,7 @@
 #include <input/Transformation.h>
 #include <input/dvb/delivery/System.h>
 #include <input/dvb/FrontendData.h>
+#include <input/dvb/FrontendSimulator.h>
 #ifdef LIBDVBCSA
 #include <input/dvb/FrontendDecryptInterface.h>
 #include <decrypt/dvbapi/ClientProperties.h>
@@ -38,6 +39,7 @@ FW_DECL_NS3(input, dvb, delivery, System);
 
 FW_DECL_SP_NS2(decrypt, dvbapi, Client);
 FW_DECL_SP_NS2(input, dvb, Frontend);
+FW_DECL_UP_NS2(input, dvb, FrontendSimulator);
 
 FW_DECL_VECTOR_OF_SP_NS0(Stream);
 
@@ -60,7 +62,8 @@ class Frontend :
 			const std::string &appDataPath,
 			const std::string &fe,
 			const std::string &dvr,
-			const std::string &dmx);
+			const std::string &dmx,
+			bool simulate);
 
 		virtual ~Frontend() = default;
 
@@ -73,7 +76,8 @@ class Frontend :
 			StreamSpVector &streamVector,
 			const std::string &appDataPath,
 			decrypt::dvbapi::SpClient decrypt,
-			const std::string &dvbAdapterPath);
+			const std::string &dvbAdapterPath,
+			int numberOfSimulatedFrontends);
 
 		// =========================================================================
 		// -- base::XMLSupport -----------------------------------------------------
@@ -104,25 +108,57 @@ class Frontend :
 			return _dvbapiData.getBatchParity();
 		}
 
-		virtual unsigned int getMaximumBatchSize() const noexcept final {
-			return _dvbapiData.getMaximumBatchSize();
+		virtual unsigned int getTargetBatchSize() const noexcept final {
+			return _dvbapiData.getTargetBatchSize();
 		}
 
-		virtual void decryptBatch() noexcept final {
-			return _dvbapiData.decryptBatch();
+		virtual bool isBatchDeadlineExpired() noexcept final {
+			return _dvbapiData.isBatchDeadlineExpired();
+		}
+
+		virtual void decryptBatch(decrypt::dvbapi::WorkerPool &pool) noexcept final {
+			_dvbapiData.decryptBatch(pool);
+		}
+
+		virtual void waitForPendingBatches() final {
+			_dvbapiData.waitForPendingBatches();
+		}
+
+		virtual unsigned long getDecryptedBatches() const noexcept final {
+			return _dvbapiData.getDecryptedBatches();
+		}
+
+		virtual unsigned long getDecryptedPackets() const noexcept final {
+			return _dvbapiData.getDecryptedPackets();
 		}
 
 		virtual void setBatchData(unsigned char* ptr, unsigned int len,
-				unsigned int parity, unsigned char* originalPtr) noexcept final {
-			_dvbapiData.setBatchData(ptr, len, parity, originalPtr);
+				unsigned int parity, unsigned char* originalPtr, mpegts::PacketBuffer &buffer) noexcept final {
+			_dvbapiData.setBatchData(ptr, len, parity, originalPtr, buffer);
 		}
 
-		virtual const dvbcsa_bs_key_s* getKey(unsigned int parity) const final {
+		virtual const decrypt::descrambler::Key* getKey(unsigned int parity) const noexcept final {
 			return _dvbapiData.getKey(parity);
 		}
 
-		virtual void setKey(const unsigned char* cw, unsigned int parity, int index) final {
-			_dvbapiData.setKey(cw, parity, index);
+		virtual void keysEnter() noexcept final {
+			_dvbapiData.keysEnter();
+		}
+
+		virtual void keysQuiescent() noexcept final {
+			_dvbapiData.keysQuiescent();
+		}
+
+		virtual bool setKey(const unsigned char* cw, std::size_t length, unsigned int parity, int index) final {
+			return _dvbapiData.setKey(cw, length, parity, index);
+		}
+
+		virtual void setIV(const unsigned char* iv, unsigned int parity) final {
+			_dvbapiData.setIV(iv, parity);
+		}
+
+		virtual void setDescramblerAlgorithm(const decrypt::descrambler::Descrambler::Algorithm algorithm) final {
+			_dvbapiData.setServerAlgorithm(algorithm);
 		}
 
 		virtual void setICAM(const unsigned char ecm, unsigned int parity) final {
@@ -173,6 +209,10 @@ class Frontend :
 		virtual mpegts::SpSDT getSDTData() const final {
 			return _frontendData.getFilter().getSDTData();
 		}
+
+		virtual uint32_t getPSIChanges() const final {
+			return _frontendData.getFilter().getPSIChanges();
+		}
 #endif
 
 		// =========================================================================
@@ -191,6 +231,8 @@ class Frontend :
 
 		virtual bool readTSPackets(mpegts::PacketBuffer& buffer) final;
 
+		virtual std::size_t readTSPackets(mpegts::PacketBuffer* buffers, std::size_t count) final;
+
 		virtual bool capableOf(InputSystem system) const final;
 
 		virtual bool capableToShare(const TransportParamVector& params) const final;
@@ -228,6 +270,9 @@ class Frontend :
 
 		void setupFrontend();
 
+		/// Get the frontend info and delivery systems from the hardware
+		bool readFrontendInfo(struct dtv_property (&dtvProperty)[2]);
+
 		///
 		int openFE(const std::string &path, bool readonly) const;
 
@@ -246,6 +291,9 @@ class Frontend :
 		///
 		bool setupAndTune();
 
+		/// Read the FE status from the frontend or simulator
+		bool readFrontendStatus(fe_status_t &status) const;
+
 		// =========================================================================
 		// -- Data members ---------------------------------------------------------
 		// =========================================================================
@@ -259,6 +307,8 @@ class Frontend :
 		std::string _path_to_dmx;
 		struct dvb_frontend_info _fe_info;
 		unsigned int _dvbVersion;
+		/// Only set when this frontend is simulated, without hardware
+		input::dvb::UpFrontendSimulator _simulator;
 
 		input::dvb::delivery::SystemUpVector _deliverySystem;
 		input::dvb::FrontendData _frontendData;
@@ -274,8 +324,10 @@ class Frontend :
 		std::size_t _dvbc2;
 
 		unsigned long _dvrBufferSizeMB;
+		std::size_t _dvrReadBatch;
 		unsigned long _waitOnLockTimeout;
 		bool _oldApiCallStats;
+		bool _tunerSharing;
 };
 
 }
@@ -448,6 +448,35 @@ uint32_t FrontendData::getFrequency() const {
 	return _freq;
 }
 
+bool FrontendData::isSameTransponder(const TransportParamVector& params) const {
+	base::MutexLock lock(_mutex);
+	const double reqFreq = params.getDoubleParameter("freq");
+	if (reqFreq == -1.0 || reqFreq != _freq / 1000.0) {
+		return false;
+	}
+	const input::InputSystem msys = params.getMSYSParameter();
+	if (msys != input::InputSystem::UNDEFINED && msys != _delsys) {
+		return false;
+	}
+	const std::string pol = params.getParameter("pol");
+	if (!pol.empty() && pol[0] != getPolarizationChar()) {
+		return false;
+	}
+	const int src = params.getIntParameter("src");
+	if (((src >= 1 && src <= 255) ? src : 1) != _src) {
+		return false;
+	}
+	const int isId = params.getIntParameter("isi");
+	if (isId != -1 && isId != _isId) {
+		return false;
+	}
+	const int plpId = params.getIntParameter("plp");
+	if (plpId != -1 && plpId != _plpId) {
+		return false;
+	}
+	return true;
+}
+
 int FrontendData::getDiSEqcSource() const {
 	base::MutexLock lock(_mutex);
 	return _src;
@@ -83,6 +83,10 @@ class FrontendData :
 		/// Get the frequency in Mhz
 		uint32_t getFrequency() const;
 
+		/// Check if the requested parameters are for the transponder that is
+		/// currently set, so the frontend could be shared
+		bool isSameTransponder(const TransportParamVector& params) const;
+
 		///
 		int getSymbolRate() const;
 
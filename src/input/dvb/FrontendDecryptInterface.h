@@ -22,8 +22,12 @@
 
 #include <Defs.h>
 #include <FwDecl.h>
+#include <decrypt/descrambler/Descrambler.h>
 
-FW_DECL_NS0(dvbcsa_bs_key_s);
+#include <cstddef>
+
+FW_DECL_NS1(mpegts, PacketBuffer);
+FW_DECL_NS2(decrypt, dvbapi, WorkerPool);
 
 FW_DECL_SP_NS1(mpegts, PMT);
 FW_DECL_SP_NS1(mpegts, SDT);
@@ -56,21 +60,49 @@ class FrontendDecryptInterface {
 		///
 		virtual unsigned int getBatchParity() const noexcept = 0;
 
-		///
-		virtual unsigned int getMaximumBatchSize() const noexcept = 0;
+		/// Get the batch size that should be decrypted
+		virtual unsigned int getTargetBatchSize() const noexcept = 0;
 
-		///
-		virtual void decryptBatch() noexcept = 0;
+		/// Check if the first packet of the batch is waiting longer then the deadline
+		virtual bool isBatchDeadlineExpired() noexcept = 0;
+
+		/// Hand the current batch to @p pool to decrypt it
+		virtual void decryptBatch(decrypt::dvbapi::WorkerPool &pool) noexcept = 0;
+
+		/// Wait until all batches that were handed to the pool are finished
+		virtual void waitForPendingBatches() = 0;
+
+		/// Get the amount of batches that were decrypted
+		virtual unsigned long getDecryptedBatches() const noexcept = 0;
+
+		/// Get the amount of TS packets that were decrypted in all batches
+		virtual unsigned long getDecryptedPackets() const noexcept = 0;
 
 		///
 		virtual void setBatchData(unsigned char* ptr, unsigned int len, unsigned int parity,
-			unsigned char* originalPtr) noexcept = 0;
+			unsigned char* originalPtr, mpegts::PacketBuffer &buffer) noexcept = 0;
 
-		///
-		virtual const dvbcsa_bs_key_s* getKey(unsigned int parity) const = 0;
+		/// Get the active key, only for the reader thread until it calls
+		/// @c keysQuiescent()
+		virtual const decrypt::descrambler::Key* getKey(unsigned int parity) const noexcept = 0;
 
-		///
-		virtual void setKey(const unsigned char* cw, unsigned int parity, int index) = 0;
+		/// The reader thread starts using the keys, call it before
+		/// @c getKey() and @c decryptBatch()
+		virtual void keysEnter() noexcept = 0;
+
+		/// The reader thread does not use the keys it got anymore, so the
+		/// replaced keys may be reclaimed
+		virtual void keysQuiescent() noexcept = 0;
+
+		/// Set the 'next' key, it is made by the descrambler of this frontend
+		/// @return false if the length of @p cw does not fit the descrambler
+		virtual bool setKey(const unsigned char* cw, std::size_t length, unsigned int parity, int index) = 0;
+
+		/// Set the IV that is used for the next keys (CISSA)
+		virtual void setIV(const unsigned char* iv, unsigned int parity) = 0;
+
+		/// Set the algorithm the server is sending keys for
+		virtual void setDescramblerAlgorithm(decrypt::descrambler::Descrambler::Algorithm algorithm) = 0;
 
 		///
 		virtual void setICAM(unsigned char ecm, unsigned int parity) = 0;
@@ -113,6 +145,9 @@ class FrontendDecryptInterface {
 
 		///
 		virtual mpegts::SpSDT getSDTData() const = 0;
+
+		/// Get the amount of times the PSI of this frontend changed version
+		virtual uint32_t getPSIChanges() const = 0;
 };
 
 }
@@ -0,0 +1,463 @@
+/* FrontendSimulator.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+ */
+#include <input/dvb/FrontendSimulator.h>
+
+#include <Log.h>
+#include <StringConverter.h>
+#include <input/dvb/FrontendData.h>
+#include <mpegts/CRC32.h>
+#include <mpegts/PacketBuffer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace input::dvb {
+
+// =============================================================================
+// -- Static const data --------------------------------------------------------
+// =============================================================================
+
+static constexpr unsigned int DEFAULT_BITRATE   = 40000;
+static constexpr unsigned int MIN_BITRATE       = 100;
+static constexpr unsigned int MAX_BITRATE       = 500000;
+static constexpr unsigned int DEFAULT_TUNE_TIME = 100;
+static constexpr unsigned int DEFAULT_LOCK_TIME = 300;
+static constexpr unsigned int MAX_TIME          = 5000;
+static constexpr unsigned int DEFAULT_PROGRAMS  = 4;
+static constexpr unsigned int MAX_PROGRAMS      = 32;
+
+static constexpr std::size_t TS_PACKET_SIZE        = 188;
+static constexpr std::size_t DEFAULT_DVR_BUFFER    = TS_PACKET_SIZE * 10 * 1024;
+static constexpr std::size_t PAYLOAD_VARIANTS      = 16;
+static constexpr uint64_t ES_PACKETS_PER_PSI       = 1000;
+static constexpr uint64_t VIDEO_PACKETS_PER_ROUND  = 10;
+static constexpr uint64_t ES_PACKETS_PER_ROUND     = VIDEO_PACKETS_PER_ROUND + 1;
+static constexpr int PMT_PID_BASE                  = 0x100;
+static constexpr int PMT_PID_STEP                  = 0x10;
+static constexpr int SDT_PID                       = 0x11;
+static constexpr int ORIGINAL_NETWORK_ID           = 0x0001;
+static constexpr int MAX_PIDS                      = 8192;
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+FrontendSimulator::FrontendSimulator() :
+	_bitrate(DEFAULT_BITRATE),
+	_tuneTime(DEFAULT_TUNE_TIME),
+	_lockTime(DEFAULT_LOCK_TIME),
+	_programs(DEFAULT_PROGRAMS),
+	_tuned(false),
+	_transportStreamID(0),
+	_muxIndex(0),
+	_overflowPackets(0),
+	_backlogPackets(DEFAULT_DVR_BUFFER / TS_PACKET_SIZE),
+	_demuxOpen(false),
+	_allPIDs(false),
+	_pids(MAX_PIDS, false),
+	_cc(MAX_PIDS, 0),
+	_payload(PAYLOAD_VARIANTS) {
+	// Fixed seed, so every run produces the same payload
+	std::mt19937 rand(0x5A7B1);
+	for (TSPacket &payload : _payload) {
+		for (unsigned char &byte : payload) {
+			byte = rand() & 0xFF;
+		}
+	}
+}
+
+// =============================================================================
+//  -- base::XMLSupport --------------------------------------------------------
+// =============================================================================
+
+void FrontendSimulator::doAddToXML(std::string &xml) const {
+	base::MutexLock lock(_mutex);
+	ADD_XML_NUMBER_INPUT(xml, "simBitrate", _bitrate, MIN_BITRATE, MAX_BITRATE);
+	ADD_XML_NUMBER_INPUT(xml, "simTuneTime", _tuneTime, 0, MAX_TIME);
+	ADD_XML_NUMBER_INPUT(xml, "simLockTime", _lockTime, 0, MAX_TIME);
+	ADD_XML_NUMBER_INPUT(xml, "simPrograms", _programs, 1, MAX_PROGRAMS);
+	ADD_XML_ELEMENT(xml, "simOverflowPackets", _overflowPackets);
+}
+
+void FrontendSimulator::doFromXML(const std::string &xml) {
+	base::MutexLock lock(_mutex);
+	std::string element;
+	if (findXMLElement(xml, "simBitrate.value", element)) {
+		const unsigned int bitrate = std::stoi(element);
+		_bitrate = (bitrate < MIN_BITRATE) ? MIN_BITRATE : ((bitrate < MAX_BITRATE) ? bitrate : MAX_BITRATE);
+	}
+	if (findXMLElement(xml, "simTuneTime.value", element)) {
+		const unsigned int time = std::stoi(element);
+		_tuneTime = (time < MAX_TIME) ? time : MAX_TIME;
+	}
+	if (findXMLElement(xml, "simLockTime.value", element)) {
+		const unsigned int time = std::stoi(element);
+		_lockTime = (time < MAX_TIME) ? time : MAX_TIME;
+	}
+	if (findXMLElement(xml, "simPrograms.value", element)) {
+		const unsigned int programs = std::stoi(element);
+		_programs = (programs < 1) ? 1 : ((programs < MAX_PROGRAMS) ? programs : MAX_PROGRAMS);
+		// The next tune will use the new number of programs
+	}
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void FrontendSimulator::getFrontendInfo(dvb_frontend_info &info, dtv_property &delsys) const {
+	snprintf(info.name, sizeof(info.name), "Simulation DVB-S2/C/T Card");
+	info.frequency_min = 47000UL;
+	info.frequency_max = 2150000UL;
+	info.symbol_rate_min = 1000000UL;
+	info.symbol_rate_max = 45000000UL;
+	delsys.u.buffer.len = 5;
+	delsys.u.buffer.data[0] = SYS_DVBS;
+	delsys.u.buffer.data[1] = SYS_DVBS2;
+	delsys.u.buffer.data[2] = SYS_DVBT;
+	delsys.u.buffer.data[3] = SYS_DVBT2;
+#if FULL_DVB_API_VERSION >= 0x0505
+	delsys.u.buffer.data[4] = SYS_DVBC_ANNEX_A;
+#else
+	delsys.u.buffer.data[4] = SYS_DVBC_ANNEX_AC;
+#endif
+}
+
+bool FrontendSimulator::tune(const input::dvb::FrontendData &frontendData) {
+	unsigned int tuneTime;
+	{
+		base::MutexLock lock(_mutex);
+		tuneTime = _tuneTime;
+	}
+	// Tuning blocks like the FE_SET_PROPERTY of a real frontend
+	std::this_thread::sleep_for(std::chrono::milliseconds(tuneTime));
+
+	base::MutexLock lock(_mutex);
+	_tuned = true;
+	_transportStreamID = 1 + (frontendData.getFrequency() % 0xFFFE);
+	_lockTimePoint = Clock::now() + std::chrono::milliseconds(_lockTime);
+	_muxIndex = 0;
+	std::fill(_cc.begin(), _cc.end(), 0);
+	generatePSI_L();
+	return true;
+}
+
+fe_status_t FrontendSimulator::readStatus() const {
+	base::MutexLock lock(_mutex);
+	if (!_tuned) {
+		return static_cast<fe_status_t>(0);
+	}
+	if (Clock::now() < _lockTimePoint) {
+		return FE_HAS_SIGNAL;
+	}
+	return static_cast<fe_status_t>(FE_HAS_SIGNAL | FE_HAS_CARRIER |
+		FE_HAS_VITERBI | FE_HAS_SYNC | FE_HAS_LOCK);
+}
+
+void FrontendSimulator::openDemux(const std::size_t bufferSize) {
+	base::MutexLock lock(_mutex);
+	_demuxOpen = true;
+	_backlogPackets = ((bufferSize > 0) ? bufferSize : DEFAULT_DVR_BUFFER) / TS_PACKET_SIZE;
+	// Like the DVR, only the packets from now on are delivered
+	_muxIndex = getDuePackets_L();
+}
+
+void FrontendSimulator::closeFrontend() {
+	base::MutexLock lock(_mutex);
+	_tuned = false;
+}
+
+void FrontendSimulator::closeDemux() {
+	base::MutexLock lock(_mutex);
+	_demuxOpen = false;
+	_allPIDs = false;
+	std::fill(_pids.begin(), _pids.end(), false);
+}
+
+bool FrontendSimulator::isDemuxOpen() const {
+	base::MutexLock lock(_mutex);
+	return _demuxOpen;
+}
+
+void FrontendSimulator::addPID(const int pid) {
+	base::MutexLock lock(_mutex);
+	if (pid >= MAX_PIDS) {
+		_allPIDs = true;
+	} else if (pid >= 0) {
+		_pids[pid] = true;
+	}
+}
+
+void FrontendSimulator::removePID(const int pid) {
+	base::MutexLock lock(_mutex);
+	if (pid >= MAX_PIDS) {
+		_allPIDs = false;
+	} else if (pid >= 0) {
+		_pids[pid] = false;
+	}
+}
+
+bool FrontendSimulator::waitForData(const unsigned int timeout) {
+	const Clock::time_point end = Clock::now() + std::chrono::milliseconds(timeout);
+	for (;;) {
+		Clock::time_point next;
+		{
+			base::MutexLock lock(_mutex);
+			if (!_demuxOpen || !_tuned) {
+				next = end;
+			} else {
+				// Wait for at least one PacketBuffer worth of mux packets
+				const uint64_t wanted = _muxIndex + mpegts::PacketBuffer::getMaxNumberOfTSPackets();
+				if (getDuePackets_L() >= wanted) {
+					return true;
+				}
+				const uint64_t us = (wanted * TS_PACKET_SIZE * 8 * 1000) / _bitrate;
+				next = _lockTimePoint + std::chrono::microseconds(us);
+			}
+		}
+		if (next >= end) {
+			std::this_thread::sleep_until(end);
+			return false;
+		}
+		std::this_thread::sleep_until(next);
+	}
+}
+
+std::size_t FrontendSimulator::read(mpegts::PacketBuffer *buffers, const std::size_t count) {
+	base::MutexLock lock(_mutex);
+	if (!_demuxOpen || !_tuned || count == 0) {
+		return 0;
+	}
+	const uint64_t due = getDuePackets_L();
+	if (due <= _muxIndex) {
+		return 0;
+	}
+	// Packets that did not fit in the DVR buffer are lost, like on a real
+	// demux when it is not read fast enough
+	if (due - _muxIndex > _backlogPackets) {
+		const uint64_t lost = due - _muxIndex - _backlogPackets;
+		if (_overflowPackets == 0) {
+			SI_LOG_ERROR("Simulated DVR buffer overflow, lost @#1 packets", lost);
+		}
+		_overflowPackets += lost;
+		_muxIndex += lost;
+	}
+	std::size_t filled = 0;
+	while (filled < count && _muxIndex < due) {
+		const uint64_t index = _muxIndex++;
+		const int pid = getPIDOf_L(index);
+		if (!_allPIDs && !_pids[pid]) {
+			// The PID is not used, but its CC still continues
+			_cc[pid] = (_cc[pid] + 1) & 0x0F;
+			continue;
+		}
+		mpegts::PacketBuffer &buffer = buffers[filled];
+		generatePacket_L(index, buffer.getWriteBufferPtr());
+		buffer.addAmountOfBytesWritten(TS_PACKET_SIZE);
+		if (buffer.full()) {
+			++filled;
+		}
+	}
+	return filled;
+}
+
+uint64_t FrontendSimulator::getDuePackets_L() const {
+	const Clock::time_point now = Clock::now();
+	if (!_tuned || now < _lockTimePoint) {
+		return 0;
+	}
+	const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(now - _lockTimePoint).count();
+	return (us * _bitrate) / (TS_PACKET_SIZE * 8 * 1000);
+}
+
+int FrontendSimulator::getPIDOf_L(const uint64_t index) const {
+	const uint64_t psi = _psi.size();
+	const uint64_t pos = index % (psi + ES_PACKETS_PER_PSI);
+	if (pos < psi) {
+		return _psiPID[pos];
+	}
+	const uint64_t slot = (pos - psi) % (_programs * ES_PACKETS_PER_ROUND);
+	const int pmtPID = PMT_PID_BASE + (slot / ES_PACKETS_PER_ROUND) * PMT_PID_STEP;
+	// First the video packets (PMT PID + 1) then one audio packet (PMT PID + 2)
+	return pmtPID + (((slot % ES_PACKETS_PER_ROUND) < VIDEO_PACKETS_PER_ROUND) ? 1 : 2);
+}
+
+void FrontendSimulator::generatePacket_L(const uint64_t index, unsigned char *ts) {
+	const uint64_t psi = _psi.size();
+	const uint64_t pos = index % (psi + ES_PACKETS_PER_PSI);
+	if (pos < psi) {
+		const int pid = _psiPID[pos];
+		std::memcpy(ts, _psi[pos].data(), TS_PACKET_SIZE);
+		ts[3] = (ts[3] & 0xF0) | _cc[pid];
+		_cc[pid] = (_cc[pid] + 1) & 0x0F;
+		return;
+	}
+	const int pid = getPIDOf_L(index);
+	const unsigned char *payload = _payload[index % PAYLOAD_VARIANTS].data();
+	ts[0] = 0x47;
+	ts[1] = (pid >> 8) & 0x1F;
+	ts[2] = pid & 0xFF;
+	// The first video packet of a program in every round carries the PCR
+	if (((pos - psi) % ES_PACKETS_PER_ROUND) == 0) {
+		const uint64_t pcr = (index * TS_PACKET_SIZE * 8 * 27000) / _bitrate;
+		const uint64_t base = (pcr / 300) & 0x1FFFFFFFFULL;
+		const unsigned int ext = pcr % 300;
+		ts[3]  = 0x30 | _cc[pid];
+		ts[4]  = 7;    // adaptation field length
+		ts[5]  = 0x10; // PCR flag
+		ts[6]  = (base >> 25) & 0xFF;
+		ts[7]  = (base >> 17) & 0xFF;
+		ts[8]  = (base >>  9) & 0xFF;
+		ts[9]  = (base >>  1) & 0xFF;
+		ts[10] = ((base & 0x01) << 7) | 0x7E | ((ext >> 8) & 0x01);
+		ts[11] = ext & 0xFF;
+		std::memcpy(&ts[12], payload, TS_PACKET_SIZE - 12);
+	} else {
+		ts[3] = 0x10 | _cc[pid];
+		std::memcpy(&ts[4], payload, TS_PACKET_SIZE - 4);
+	}
+	_cc[pid] = (_cc[pid] + 1) & 0x0F;
+}
+
+void FrontendSimulator::generatePSI_L() {
+	_psi.clear();
+	_psiPID.clear();
+	const int tsid = _transportStreamID;
+
+	// PAT
+	mpegts::TSData pat;
+	pat.push_back(mpegts::TableData::PAT_ID);
+	pat.push_back(0xB0);
+	pat.push_back(0x00);
+	pat.push_back((tsid >> 8) & 0xFF);
+	pat.push_back(tsid & 0xFF);
+	pat.push_back(0xC1); // version 0, current
+	pat.push_back(0x00); // section number
+	pat.push_back(0x00); // last section number
+	for (unsigned int i = 0; i < _programs; ++i) {
+		const int prognr = i + 1;
+		const int pmtPID = PMT_PID_BASE + i * PMT_PID_STEP;
+		pat.push_back((prognr >> 8) & 0xFF);
+		pat.push_back(prognr & 0xFF);
+		pat.push_back(0xE0 | ((pmtPID >> 8) & 0x1F));
+		pat.push_back(pmtPID & 0xFF);
+	}
+	addSectionPackets_L(0, pat);
+
+	// PMT for every program with an video (carrying the PCR) and audio PID
+	for (unsigned int i = 0; i < _programs; ++i) {
+		const int prognr = i + 1;
+		const int pmtPID = PMT_PID_BASE + i * PMT_PID_STEP;
+		mpegts::TSData pmt;
+		pmt.push_back(mpegts::TableData::PMT_ID);
+		pmt.push_back(0xB0);
+		pmt.push_back(0x00);
+		pmt.push_back((prognr >> 8) & 0xFF);
+		pmt.push_back(prognr & 0xFF);
+		pmt.push_back(0xC1);
+		pmt.push_back(0x00);
+		pmt.push_back(0x00);
+		pmt.push_back(0xE0 | (((pmtPID + 1) >> 8) & 0x1F)); // PCR PID
+		pmt.push_back((pmtPID + 1) & 0xFF);
+		pmt.push_back(0xF0); // program info length
+		pmt.push_back(0x00);
+		const int streamType[] = { 0x1B, 0x04 }; // H.264 video and MPEG-2 audio
+		for (int s = 0; s < 2; ++s) {
+			const int esPID = pmtPID + 1 + s;
+			pmt.push_back(streamType[s]);
+			pmt.push_back(0xE0 | ((esPID >> 8) & 0x1F));
+			pmt.push_back(esPID & 0xFF);
+			pmt.push_back(0xF0); // ES info length
+			pmt.push_back(0x00);
+		}
+		addSectionPackets_L(pmtPID, pmt);
+	}
+
+	// SDT
+	mpegts::TSData sdt;
+	sdt.push_back(mpegts::TableData::SDT_ID);
+	sdt.push_back(0xF0);
+	sdt.push_back(0x00);
+	sdt.push_back((tsid >> 8) & 0xFF);
+	sdt.push_back(tsid & 0xFF);
+	sdt.push_back(0xC1);
+	sdt.push_back(0x00);
+	sdt.push_back(0x00);
+	sdt.push_back((ORIGINAL_NETWORK_ID >> 8) & 0xFF);
+	sdt.push_back(ORIGINAL_NETWORK_ID & 0xFF);
+	sdt.push_back(0xFF);
+	const std::string provider = "SatPI";
+	for (unsigned int i = 0; i < _programs; ++i) {
+		const int prognr = i + 1;
+		const std::string name = StringConverter::stringFormat("Simulated @#1.@#2", tsid, prognr);
+		const int descLength = 2 + 3 + provider.size() + name.size();
+		sdt.push_back((prognr >> 8) & 0xFF);
+		sdt.push_back(prognr & 0xFF);
+		sdt.push_back(0xFC); // no EIT
+		sdt.push_back(0x80 | ((descLength >> 8) & 0x0F)); // running
+		sdt.push_back(descLength & 0xFF);
+		sdt.push_back(0x48); // service descriptor
+		sdt.push_back(descLength - 2);
+		sdt.push_back(0x01); // digital television service
+		sdt.push_back(provider.size());
+		sdt.append(provider.begin(), provider.end());
+		sdt.push_back(name.size());
+		sdt.append(name.begin(), name.end());
+	}
+	addSectionPackets_L(SDT_PID, sdt);
+}
+
+void FrontendSimulator::addSectionPackets_L(const int pid, const mpegts::TSData &section) {
+	// Set the section length, including the CRC, and append the CRC
+	mpegts::TSData data = section;
+	const std::size_t sectionLength = data.size() - 3 + 4;
+	data[1] = (data[1] & 0xF0) | ((sectionLength >> 8) & 0x0F);
+	data[2] = sectionLength & 0xFF;
+	const uint32_t crc = mpegts::CRC32::calculate(data.data(), data.size());
+	data.push_back((crc >> 24) & 0xFF);
+	data.push_back((crc >> 16) & 0xFF);
+	data.push_back((crc >>  8) & 0xFF);
+	data.push_back(crc & 0xFF);
+
+	// Split it over TS packets, the first one starts with the pointer field
+	std::size_t index = 0;
+	while (index < data.size()) {
+		TSPacket ts;
+		ts.fill(0xFF);
+		ts[0] = 0x47;
+		ts[1] = ((index == 0) ? 0x40 : 0x00) | ((pid >> 8) & 0x1F);
+		ts[2] = pid & 0xFF;
+		ts[3] = 0x10;
+		std::size_t offset = 4;
+		if (index == 0) {
+			ts[offset++] = 0x00;
+		}
+		const std::size_t size = std::min(TS_PACKET_SIZE - offset, data.size() - index);
+		std::memcpy(&ts[offset], &data[index], size);
+		index += size;
+		_psi.push_back(ts);
+		_psiPID.push_back(pid);
+	}
+}
+
+}
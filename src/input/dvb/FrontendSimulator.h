@@ -0,0 +1,162 @@
+/* FrontendSimulator.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef INPUT_DVB_FRONTEND_SIMULATOR_H_INCLUDE
+#define INPUT_DVB_FRONTEND_SIMULATOR_H_INCLUDE INPUT_DVB_FRONTEND_SIMULATOR_H_INCLUDE
+
+#include <Defs.h>
+#include <FwDecl.h>
+#include <base/Mutex.h>
+#include <base/XMLSupport.h>
+#include <input/dvb/dvbfix.h>
+#include <mpegts/TableData.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+FW_DECL_NS1(mpegts, PacketBuffer);
+FW_DECL_NS2(input, dvb, FrontendData);
+
+namespace input::dvb {
+
+/// The class @c FrontendSimulator emulates the frontend and demux of one
+/// DVB adapter, so a Frontend can be used without hardware. Tuning takes
+/// the configured tune and lock time, after which a multi-program TS with
+/// PAT, PMT, SDT and PCR is produced at the configured bitrate. Only the
+/// PIDs that are added to the demux are delivered
+class FrontendSimulator :
+	public base::XMLSupport {
+		// =========================================================================
+		//  -- Constructors and destructor -----------------------------------------
+		// =========================================================================
+	public:
+
+		FrontendSimulator();
+
+		virtual ~FrontendSimulator() = default;
+
+		// =========================================================================
+		// -- base::XMLSupport -----------------------------------------------------
+		// =========================================================================
+	private:
+
+		/// @see XMLSupport
+		virtual void doAddToXML(std::string &xml) const final;
+
+		/// @see XMLSupport
+		virtual void doFromXML(const std::string &xml) final;
+
+		// =========================================================================
+		//  -- Other member functions ----------------------------------------------
+		// =========================================================================
+	public:
+
+		/// Fill in what FE_GET_INFO and DTV_ENUM_DELSYS would return
+		void getFrontendInfo(dvb_frontend_info &info, dtv_property &delsys) const;
+
+		/// Tune to the transponder in @p frontendData, this will take the
+		/// configured tune time and the lock will follow after the lock time
+		bool tune(const input::dvb::FrontendData &frontendData);
+
+		/// Get the FE status like FE_READ_STATUS would return it
+		fe_status_t readStatus() const;
+
+		/// Close the frontend, it will lose the lock
+		void closeFrontend();
+
+		/// Open the demux with a DVR buffer of @p bufferSize bytes, when this
+		/// buffer overflows the oldest packets are lost
+		void openDemux(std::size_t bufferSize);
+
+		/// Close the demux and all its PIDs
+		void closeDemux();
+
+		/// Check if the demux is open
+		bool isDemuxOpen() const;
+
+		/// Add @p pid to the demux, like DMX_ADD_PID
+		void addPID(int pid);
+
+		/// Remove @p pid from the demux, like DMX_REMOVE_PID
+		void removePID(int pid);
+
+		/// Wait until the next packets of the demux are due, for a maximum
+		/// time of @p timeout msec
+		/// @return true if there is data to read
+		bool waitForData(unsigned int timeout);
+
+		/// Read the due packets of the opened PIDs into @p buffers, the first
+		/// buffer might still be partially filled from the previous read
+		/// @return the number of full buffers
+		std::size_t read(mpegts::PacketBuffer *buffers, std::size_t count);
+
+	private:
+
+		/// Get the number of mux packets that are due since the lock
+		uint64_t getDuePackets_L() const;
+
+		/// Get the PID of mux packet @p index
+		int getPIDOf_L(uint64_t index) const;
+
+		/// Write mux packet @p index to @p ts
+		void generatePacket_L(uint64_t index, unsigned char *ts);
+
+		/// Make the PAT, PMT and SDT packets for the tuned transponder
+		void generatePSI_L();
+
+		/// Split @p section into TS packets of @p pid and add them to the PSI
+		void addSectionPackets_L(int pid, const mpegts::TSData &section);
+
+		// =========================================================================
+		// -- Data members ---------------------------------------------------------
+		// =========================================================================
+	private:
+
+		using Clock = std::chrono::steady_clock;
+		using TSPacket = std::array<unsigned char, 188>;
+
+		base::Mutex _mutex;
+
+		unsigned int _bitrate;
+		unsigned int _tuneTime;
+		unsigned int _lockTime;
+		unsigned int _programs;
+
+		bool _tuned;
+		int _transportStreamID;
+		Clock::time_point _lockTimePoint;
+		uint64_t _muxIndex;
+		uint64_t _overflowPackets;
+		std::size_t _backlogPackets;
+
+		bool _demuxOpen;
+		bool _allPIDs;
+		std::vector<bool> _pids;
+		std::vector<uint8_t> _cc;
+		std::vector<TSPacket> _psi;
+		std::vector<int> _psiPID;
+		std::vector<TSPacket> _payload;
+};
+
+}
+
+#endif // INPUT_DVB_FRONTEND_SIMULATOR_H_INCLUDE
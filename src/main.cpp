@@ -22,6 +22,7 @@
 #include <StringConverter.h>
 #include <Utils.h>
 #include <base/ChildPIPEReader.h>
+#include <mpegts/CRC32.h>
 
 #include <atomic>
 #include <iostream>
@@ -200,6 +201,7 @@ namespace {
 			"\t--backtrace <file>            backtrace 'file'\r\n" \
 			"\t--ssdp-ttl <hops>             set the TTL that is used for SSDP server (1 - 15)\r\n" \
 			"\t--childpipe <number>          enabled number amount of Frontends 'Child PIPE - TS Reader' (0 - 25)\r\n" \
+			"\t--simulate-frontends <number> add number amount of simulated DVB Frontends, without hardware (0 - 64)\r\n" \
 			"\t--enable-unsecure-frontends   enable to use 'Child PIPE - TS Reader' in command directly\r\n" \
 			"\t--no-daemon                   do NOT daemonize\r\n" \
 			"\t--no-ssdp                     do NOT advertise server\r\n", prog_name);
@@ -252,6 +254,18 @@ int main(int argc, char *argv[]) {
 					printUsage(argv[0]);
 					return EXIT_FAILURE;
 				}
+			} else if (strcmp(argv[i], "--simulate-frontends") == 0) {
+				if (i + 1 < argc) {
+					++i;
+					params.numberOfSimulatedFrontends = std::stoi(argv[i]);
+					if (params.numberOfSimulatedFrontends < 0 || params.numberOfSimulatedFrontends > 64) {
+						printUsage(argv[0]);
+						return EXIT_FAILURE;
+					}
+				} else {
+					printUsage(argv[0]);
+					return EXIT_FAILURE;
+				}
 			} else if (strcmp(argv[i], "--enable-unsecure-frontends") == 0) {
 				params.enableUnsecureFrontends = true;
 			} else if (strcmp(argv[i], "--app-data-path") == 0) {
@@ -356,6 +370,8 @@ int main(int argc, char *argv[]) {
 	SI_LOG_INFO("--- Starting SatPI version: @#1 ---", satpi_version);
 	SI_LOG_INFO("Number of processors online: @#1", base::ThreadBase::getNumberOfProcessorsOnline());
 	SI_LOG_INFO("Default network buffer size: @#1 KBytes", InterfaceAttr::getNetworkUDPBufferSize() / 1024);
+	SI_LOG_INFO("PSI CRC32 implementation: @#1",
+		mpegts::CRC32::getImplementationName(mpegts::CRC32::getImplementation()));
 	do {
 		try {
 			restartApp = false;
@@ -0,0 +1,288 @@
+/* CRC32.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/CRC32.h>
+
+#include <array>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define CRC32_HAS_PCLMUL
+#elif defined(__aarch64__) && defined(__linux__)
+	#include <arm_neon.h>
+	#include <sys/auxv.h>
+	#include <asm/hwcap.h>
+	#define CRC32_HAS_PMULL
+#endif
+
+namespace mpegts {
+
+namespace {
+
+	constexpr uint32_t POLYNOMIAL = 0x04C11DB7;
+	constexpr uint32_t INIT = 0xFFFFFFFF;
+
+	/// Folding needs at least 4 blocks of 16 bytes
+	constexpr std::size_t FOLD_MIN_LEN = 64;
+
+	using CRC32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+	/// Table[0] is the normal byte table, Table[k] gives the CRC of a byte
+	/// followed by k zero bytes, so 8 bytes can be done at once
+	constexpr CRC32Tables makeTables() {
+		CRC32Tables tables{};
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i << 24;
+			for (int bit = 0; bit < 8; ++bit) {
+				crc = (crc & 0x80000000) ? ((crc << 1) ^ POLYNOMIAL) : (crc << 1);
+			}
+			tables[0][i] = crc;
+		}
+		for (std::size_t k = 1; k < tables.size(); ++k) {
+			for (std::size_t i = 0; i < 256; ++i) {
+				const uint32_t prev = tables[k - 1][i];
+				tables[k][i] = (prev << 8) ^ tables[0][prev >> 24];
+			}
+		}
+		return tables;
+	}
+
+	constexpr CRC32Tables globalCRC32Tables = makeTables();
+
+	uint32_t calculateBytewise(uint32_t crc, const unsigned char *data, std::size_t len) noexcept {
+		const auto &table = globalCRC32Tables[0];
+		for (std::size_t i = 0; i < len; ++i) {
+			crc = (crc << 8) ^ table[(crc >> 24) ^ data[i]];
+		}
+		return crc;
+	}
+
+	uint32_t calculateSlicingBy8(uint32_t crc, const unsigned char *data, std::size_t len) noexcept {
+		const auto &t = globalCRC32Tables;
+		for (; len >= 8; len -= 8, data += 8) {
+			crc ^= (uint32_t(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+			crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xFF] ^
+			      t[5][(crc >> 8) & 0xFF] ^ t[4][crc & 0xFF] ^
+			      t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+		}
+		return calculateBytewise(crc, data, len);
+	}
+
+#if defined(CRC32_HAS_PCLMUL) || defined(CRC32_HAS_PMULL)
+	/// Calculate x^n mod P, used as the folding constants
+	constexpr uint64_t xPowModP(const unsigned int n) {
+		uint32_t r = 1;
+		for (unsigned int i = 0; i < n; ++i) {
+			r = (r & 0x80000000) ? ((r << 1) ^ POLYNOMIAL) : (r << 1);
+		}
+		return r;
+	}
+
+	// Folding a 128 bit block A = Hi * x^64 + Lo over a distance of D bits:
+	// A * x^D mod P = Hi * (x^(D + 64) mod P) + Lo * (x^D mod P)
+	constexpr uint64_t K128_HI = xPowModP(128 + 64);
+	constexpr uint64_t K128_LO = xPowModP(128);
+	constexpr uint64_t K512_HI = xPowModP(512 + 64);
+	constexpr uint64_t K512_LO = xPowModP(512);
+#endif
+
+#ifdef CRC32_HAS_PCLMUL
+	__attribute__((target("ssse3")))
+	inline __m128i loadSwapped(const unsigned char *ptr) noexcept {
+		const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)), swap);
+	}
+
+	__attribute__((target("pclmul")))
+	inline __m128i fold(const __m128i a, const __m128i k, const __m128i b) noexcept {
+		return _mm_xor_si128(_mm_xor_si128(
+			_mm_clmulepi64_si128(a, k, 0x11), _mm_clmulepi64_si128(a, k, 0x00)), b);
+	}
+
+	// The blocks are byte swapped, so the first bit of the data is bit 127 and
+	// the carry-less multiply works on the normal (not reflected) polynomial.
+	// At the end the remaining 128 bits have the same CRC as the folded data,
+	// so the tables finish it together with the tail.
+	__attribute__((target("pclmul,ssse3")))
+	uint32_t calculatePCLMUL(const unsigned char *data, std::size_t len) noexcept {
+		if (len < FOLD_MIN_LEN) {
+			return calculateSlicingBy8(INIT, data, len);
+		}
+		const __m128i k128 = _mm_set_epi64x(K128_HI, K128_LO);
+		const __m128i k512 = _mm_set_epi64x(K512_HI, K512_LO);
+		// The initial value is the same as inverting the first 32 bits
+		__m128i x0 = _mm_xor_si128(loadSwapped(data), _mm_set_epi32(-1, 0, 0, 0));
+		__m128i x1 = loadSwapped(data + 16);
+		__m128i x2 = loadSwapped(data + 32);
+		__m128i x3 = loadSwapped(data + 48);
+		data += 64;
+		len  -= 64;
+		for (; len >= 64; len -= 64, data += 64) {
+			x0 = fold(x0, k512, loadSwapped(data));
+			x1 = fold(x1, k512, loadSwapped(data + 16));
+			x2 = fold(x2, k512, loadSwapped(data + 32));
+			x3 = fold(x3, k512, loadSwapped(data + 48));
+		}
+		x0 = fold(x0, k128, x1);
+		x0 = fold(x0, k128, x2);
+		x0 = fold(x0, k128, x3);
+		for (; len >= 16; len -= 16, data += 16) {
+			x0 = fold(x0, k128, loadSwapped(data));
+		}
+		// Swap back to memory order
+		alignas(16) unsigned char rest[16];
+		_mm_store_si128(reinterpret_cast<__m128i *>(rest), x0);
+		for (std::size_t i = 0; i < 8; ++i) {
+			std::swap(rest[i], rest[15 - i]);
+		}
+		const uint32_t crc = calculateSlicingBy8(0, rest, sizeof(rest));
+		return calculateSlicingBy8(crc, data, len);
+	}
+#endif
+
+#ifdef CRC32_HAS_PMULL
+	inline uint8x16_t swapBytes(const uint8x16_t v) noexcept {
+		const uint8x16_t r = vrev64q_u8(v);
+		return vextq_u8(r, r, 8);
+	}
+
+	inline uint64x2_t loadSwapped(const unsigned char *ptr) noexcept {
+		return vreinterpretq_u64_u8(swapBytes(vld1q_u8(ptr)));
+	}
+
+	__attribute__((target("+crypto")))
+	inline uint64x2_t fold(const uint64x2_t a, const uint64_t kHi, const uint64_t kLo, const uint64x2_t b) noexcept {
+		const poly128_t hi = vmull_p64(vgetq_lane_u64(a, 1), kHi);
+		const poly128_t lo = vmull_p64(vgetq_lane_u64(a, 0), kLo);
+		return veorq_u64(veorq_u64(vreinterpretq_u64_p128(hi), vreinterpretq_u64_p128(lo)), b);
+	}
+
+	// Same folding as the PCLMUL version, see there
+	__attribute__((target("+crypto")))
+	uint32_t calculatePMULL(const unsigned char *data, std::size_t len) noexcept {
+		if (len < FOLD_MIN_LEN) {
+			return calculateSlicingBy8(INIT, data, len);
+		}
+		// The initial value is the same as inverting the first 32 bits
+		const uint64x2_t init = vcombine_u64(vcreate_u64(0), vcreate_u64(0xFFFFFFFF00000000ULL));
+		uint64x2_t x0 = veorq_u64(loadSwapped(data), init);
+		uint64x2_t x1 = loadSwapped(data + 16);
+		uint64x2_t x2 = loadSwapped(data + 32);
+		uint64x2_t x3 = loadSwapped(data + 48);
+		data += 64;
+		len  -= 64;
+		for (; len >= 64; len -= 64, data += 64) {
+			x0 = fold(x0, K512_HI, K512_LO, loadSwapped(data));
+			x1 = fold(x1, K512_HI, K512_LO, loadSwapped(data + 16));
+			x2 = fold(x2, K512_HI, K512_LO, loadSwapped(data + 32));
+			x3 = fold(x3, K512_HI, K512_LO, loadSwapped(data + 48));
+		}
+		x0 = fold(x0, K128_HI, K128_LO, x1);
+		x0 = fold(x0, K128_HI, K128_LO, x2);
+		x0 = fold(x0, K128_HI, K128_LO, x3);
+		for (; len >= 16; len -= 16, data += 16) {
+			x0 = fold(x0, K128_HI, K128_LO, loadSwapped(data));
+		}
+		unsigned char rest[16];
+		vst1q_u8(rest, swapBytes(vreinterpretq_u8_u64(x0)));
+		const uint32_t crc = calculateSlicingBy8(0, rest, sizeof(rest));
+		return calculateSlicingBy8(crc, data, len);
+	}
+#endif
+
+	CRC32::Implementation selectImplementation() noexcept {
+		if (CRC32::isSupported(CRC32::Implementation::PCLMUL)) {
+			return CRC32::Implementation::PCLMUL;
+		} else if (CRC32::isSupported(CRC32::Implementation::PMULL)) {
+			return CRC32::Implementation::PMULL;
+		}
+		return CRC32::Implementation::SLICING_BY_8;
+	}
+
+	const CRC32::Implementation globalImplementation = selectImplementation();
+
+}
+
+// =============================================================================
+//  -- Static member functions -------------------------------------------------
+// =============================================================================
+
+uint32_t CRC32::calculate(const unsigned char *data, const std::size_t len) noexcept {
+	return calculate(globalImplementation, data, len);
+}
+
+uint32_t CRC32::calculate(const Implementation impl,
+		const unsigned char *data, const std::size_t len) noexcept {
+	switch (impl) {
+#ifdef CRC32_HAS_PCLMUL
+		case Implementation::PCLMUL:
+			return calculatePCLMUL(data, len);
+#endif
+#ifdef CRC32_HAS_PMULL
+		case Implementation::PMULL:
+			return calculatePMULL(data, len);
+#endif
+		case Implementation::BYTEWISE:
+			return calculateBytewise(INIT, data, len);
+		default:
+			return calculateSlicingBy8(INIT, data, len);
+	}
+}
+
+bool CRC32::isSupported(const Implementation impl) noexcept {
+	switch (impl) {
+		case Implementation::BYTEWISE:
+		case Implementation::SLICING_BY_8:
+			return true;
+#ifdef CRC32_HAS_PCLMUL
+		case Implementation::PCLMUL:
+			// Can be called before the static constructors of libgcc did run
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#endif
+#ifdef CRC32_HAS_PMULL
+		case Implementation::PMULL:
+			return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#endif
+		default:
+			return false;
+	}
+}
+
+CRC32::Implementation CRC32::getImplementation() noexcept {
+	return globalImplementation;
+}
+
+const char *CRC32::getImplementationName(const Implementation impl) noexcept {
+	switch (impl) {
+		case Implementation::BYTEWISE:
+			return "Bytewise";
+		case Implementation::SLICING_BY_8:
+			return "Slicing-by-8";
+		case Implementation::PCLMUL:
+			return "PCLMULQDQ";
+		case Implementation::PMULL:
+			return "PMULL";
+		default:
+			return "Unknown";
+	}
+}
+
+}
@@ -0,0 +1,77 @@
+/* CRC32.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_CRC32_H_INCLUDE
+#define MPEGTS_CRC32_H_INCLUDE MPEGTS_CRC32_H_INCLUDE
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mpegts {
+
+/// The class @c CRC32 calculates the MPEG-2 CRC32 (polynomial 0x04C11DB7,
+/// initial value 0xFFFFFFFF, not reflected and no final XOR) of PSI sections.
+/// The fastest implementation the CPU supports is picked once at startup.
+class CRC32 {
+		// =========================================================================
+		// -- Defines --------------------------------------------------------------
+		// =========================================================================
+	public:
+
+		enum class Implementation {
+			BYTEWISE,
+			SLICING_BY_8,
+			PCLMUL,
+			PMULL
+		};
+
+		// =========================================================================
+		// -- Constructors and destructor ------------------------------------------
+		// =========================================================================
+	public:
+
+		CRC32() = delete;
+
+		// =========================================================================
+		//  -- Static member functions ---------------------------------------------
+		// =========================================================================
+	public:
+
+		/// Calculate the CRC32 of @p data with the selected implementation
+		static uint32_t calculate(const unsigned char *data, std::size_t len) noexcept;
+
+		/// Calculate the CRC32 of @p data with the requested implementation,
+		/// which should be supported. Used for testing and benchmarking
+		static uint32_t calculate(Implementation impl,
+				const unsigned char *data, std::size_t len) noexcept;
+
+		/// Check if the requested implementation is supported by this CPU
+		static bool isSupported(Implementation impl) noexcept;
+
+		/// Get the implementation that is used by calculate()
+		static Implementation getImplementation() noexcept;
+
+		/// Get the name of the requested implementation
+		static const char *getImplementationName(Implementation impl) noexcept;
+
+};
+
+}
+
+#endif // MPEGTS_CRC32_H_INCLUDE
@@ -24,6 +24,10 @@
 #include <StringConverter.h>
 #include <mpegts/PacketBuffer.h>
 
+#ifdef LATENCY_HISTOGRAM
+	#include <base/LatencyHistogram.h>
+#endif
+
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -35,11 +39,12 @@ namespace mpegts {
 // -- Constructors and destructor ----------------------------------------------
 // =============================================================================
 
-Filter::Filter() {
-	_nit = std::make_shared<NIT>();
-	_pat = std::make_shared<PAT>();
+Filter::Filter() :
+	_sectionArena(SectionArena::makeSP()) {
+	_nit = makeTable_L<NIT>();
+	_pat = makeTable_L<PAT>();
 	_pcr = std::make_shared<PCR>();
-	_sdt = std::make_shared<SDT>();
+	_sdt = makeTable_L<SDT>();
 	_userPids = "0,1,16,17,18";
 }
 
@@ -50,6 +55,7 @@ Filter::Filter() {
 void Filter::doAddToXML(std::string &xml) const {
 	ADD_XML_ELEMENT(xml, "pidcsv", getPidCSV());
 	ADD_XML_ELEMENT(xml, "totalCCErrors", getTotalCCErrors());
+	ADD_XML_ELEMENT(xml, "psiChanges", getPSIChanges());
 	ADD_XML_CHECKBOX(xml, "filterPCR", (_filterPCR ? "true" : "false"));
 	ADD_XML_TEXT_INPUT(xml, "addUserPids", _userPids);
 
@@ -93,12 +99,13 @@ void Filter::doFromXML(const std::string &xml) {
 
 void Filter::clear() {
 	base::MutexLock lock(_mutex);
-	_nit = std::make_shared<NIT>();
-	_pat = std::make_shared<PAT>();
+	_nit = makeTable_L<NIT>();
+	_pat = makeTable_L<PAT>();
 	_pcr = std::make_shared<PCR>();
-	_sdt = std::make_shared<SDT>();
+	_sdt = makeTable_L<SDT>();
 	_pmtMap.clear();
 	_pidTable.clear();
+	_pmtPids.reset();
 }
 
 void Filter::parsePIDString(const FeID id, const std::string &reqPids, const bool add) {
@@ -135,121 +142,190 @@ void Filter::parsePIDString(const FeID id, const std::string &reqPids, const boo
 }
 
 void Filter::filterData(const FeID id, mpegts::PacketBuffer &buffer, const bool filter) {
+#ifdef LATENCY_HISTOGRAM
+	const uint64_t begin = _measureNext ? base::LatencyHistogram::now() : 0;
+#endif
 	base::MutexLock lock(_mutex);
+	filterData_L(id, buffer, filter);
+#ifdef LATENCY_HISTOGRAM
+	if (_measureNext) {
+		_measuredTime = base::LatencyHistogram::now() - begin;
+		_measureNext = false;
+	}
+#endif
+}
+
+void Filter::filterData(const FeID id, mpegts::PacketBuffer *buffers,
+		const std::size_t count, const bool filter) {
+#ifdef LATENCY_HISTOGRAM
+	const uint64_t begin = _measureNext ? base::LatencyHistogram::now() : 0;
+#endif
+	base::MutexLock lock(_mutex);
+	for (std::size_t i = 0; i < count; ++i) {
+		filterData_L(id, buffers[i], filter);
+	}
+#ifdef LATENCY_HISTOGRAM
+	if (_measureNext) {
+		_measuredTime = base::LatencyHistogram::now() - begin;
+		_measureNext = false;
+	}
+#endif
+}
+
+void Filter::filterData_L(const FeID id, mpegts::PacketBuffer &buffer, const bool filter) {
 	const std::size_t begin = buffer.getBeginOfUnFilteredPackets();
 	const std::size_t size = buffer.getNumberOfCompletedPackets();
+	const bool purge = filter && !_pidTable.isAllPID();
 
+	// Check all TS packets at once for the SYNC byte, no Transport error
+	// indicator and not a NULL packet
+	_classifier.classify(buffer, begin, size);
+	const uint32_t validMask = _classifier.getValidMask();
+	const uint32_t psiMask = _classifier.getPSIMask();
 	for (std::size_t i = begin; i < size; ++i) {
-		const unsigned char* ptr = buffer.getTSPacketPtr(i);
-		const uint16_t pid = ((ptr[1] & 0x1f) << 8) | ptr[2];
-		// Check is this the beginning of the TS and no Transport error indicator and not a NULL packet
-		if (ptr[0] != 0x47 || (ptr[1] & 0x80) == 0x80 || pid == 0x1FFF || !_pidTable.isPIDOpened(pid)) {
-			if (filter && !_pidTable.isAllPID()) {
+		const uint32_t bit = 1u << i;
+		const int pid = _classifier.getPID(i);
+		if ((validMask & bit) == 0 || !_pidTable.isPIDOpened(pid)) {
+			if (purge) {
 				buffer.markTSForPurging(i);
 			}
 			continue;
 		}
-		const uint8_t cc = ptr[3] & 0x0f;
+		const unsigned char* ptr = buffer.getTSPacketPtr(i);
 		_pidTable.addPIDData(pid, ptr[3]);
+		// Only the PSI/SI, PMT and PCR packets need more attention
+		if ((psiMask & bit) != 0 || _pmtPids[pid] ||
+				(_filterPCR && PCR::isPCRTableData(ptr))) {
+			handleTableData_L(id, pid, ptr);
+		}
+	}
+	if (filter) {
+		buffer.purge();
+	}
+}
 
-		switch (pid) {
-			case 0:
-				if (!_pat->isCollected()) {
-					// collect PAT data
-					_pat->collectData(id, TableData::PAT_ID, ptr, false);
-					// Did we finish collecting PAT
-					if (_pat->isCollected()) {
-						_pat->parse(id);
-					}
+void Filter::handleTableData_L(const FeID id, const int pid, const unsigned char *ptr) {
+	switch (pid) {
+		case 0:
+			renewTableOnChange_L(id, pid, ptr, "PAT", _pat);
+			if (!_pat->isCollected()) {
+				// collect PAT data
+				_pat->collectData(id, TableData::PAT_ID, ptr, false);
+				// Did we finish collecting PAT
+				if (_pat->isCollected()) {
+					_pat->parse(id);
+					updatePMTPids_L();
 				}
-				break;
-			case 1:
-				// Empty
-				break;
-			case 16:
-				if (!_nit->isCollected()) {
-					// collect NIT data
-					_nit->collectData(id, TableData::NIT_ID, ptr, false);
+			}
+			break;
+		case 1:
+			// Empty
+			break;
+		case 16:
+			renewTableOnChange_L(id, pid, ptr, "NIT", _nit);
+			if (!_nit->isCollected()) {
+				// collect NIT data
+				_nit->collectData(id, TableData::NIT_ID, ptr, false);
 
-					// Did we finish collecting SDT
-					if (_nit->isCollected()) {
-						_nit->parse(id);
-					}
+				// Did we finish collecting SDT
+				if (_nit->isCollected()) {
+					_nit->parse(id);
 				}
-				break;
-			case 17:
-				if (!_sdt->isCollected()) {
-					// collect SDT data
-					_sdt->collectData(id, TableData::SDT_ID, ptr, false);
-					// Did we finish collecting SDT
-					if (_sdt->isCollected()) {
-						_sdt->parse(id);
-					}
+			}
+			break;
+		case 17:
+			renewTableOnChange_L(id, pid, ptr, "SDT", _sdt);
+			if (!_sdt->isCollected()) {
+				// collect SDT data
+				_sdt->collectData(id, TableData::SDT_ID, ptr, false);
+				// Did we finish collecting SDT
+				if (_sdt->isCollected()) {
+					_sdt->parse(id);
 				}
-				break;
-			case 18:
-				// Empty
-				break;
-			case 20: {
-				const unsigned int tableID = ptr[5];
-				const unsigned int mjd = (ptr[8] << 8) | (ptr[9]);
-				const unsigned int y1 = static_cast<unsigned int>((mjd - 15078.2) / 365.25);
-				const unsigned int m1 = static_cast<unsigned int>((mjd - 14956.1 - static_cast<unsigned int>(y1 * 365.25)) / 30.6001);
-				const unsigned int d = static_cast<unsigned int>(mjd - 14956.0 - static_cast<unsigned int>(y1 * 365.25) - static_cast<unsigned int>(m1 * 30.6001 ));
-				const unsigned int k = (m1 == 14 || m1 ==15) ? 1 : 0;
-				const unsigned int y = y1 + k + 1900;
-				const unsigned int m = m1 - 1 - (k * 12);
-				const unsigned int h = ptr[10];
-				const unsigned int mi = ptr[11];
-				const unsigned int s = ptr[12];
+			}
+			break;
+		case 18:
+			// Empty
+			break;
+		case 20: {
+			const unsigned int tableID = ptr[5];
+			const unsigned int mjd = (ptr[8] << 8) | (ptr[9]);
+			const unsigned int y1 = static_cast<unsigned int>((mjd - 15078.2) / 365.25);
+			const unsigned int m1 = static_cast<unsigned int>((mjd - 14956.1 - static_cast<unsigned int>(y1 * 365.25)) / 30.6001);
+			const unsigned int d = static_cast<unsigned int>(mjd - 14956.0 - static_cast<unsigned int>(y1 * 365.25) - static_cast<unsigned int>(m1 * 30.6001 ));
+			const unsigned int k = (m1 == 14 || m1 ==15) ? 1 : 0;
+			const unsigned int y = y1 + k + 1900;
+			const unsigned int m = m1 - 1 - (k * 12);
+			const unsigned int h = ptr[10];
+			const unsigned int mi = ptr[11];
+			const unsigned int s = ptr[12];
 
-				SI_LOG_INFO("Frontend: @#1, TDT - Table ID: @#2  Date: @#3-@#4-@#5  Time: @#6:@#7.@#8  MJD: @#9",
-					id, HEX(tableID, 2), y, m, d, DIGIT(h, 2), DIGIT(mi, 2), DIGIT(s, 2), HEX(mjd, 4));
+			SI_LOG_INFO("Frontend: @#1, TDT - Table ID: @#2  Date: @#3-@#4-@#5  Time: @#6:@#7.@#8  MJD: @#9",
+				id, HEX(tableID, 2), y, m, d, DIGIT(h, 2), DIGIT(mi, 2), DIGIT(s, 2), HEX(mjd, 4));
 #ifdef ADDDVBCA
-				const char fileFIFO[] = "/tmp/fifo";
-				int fd = ::open(fileFIFO, O_WRONLY | O_NONBLOCK);
-				if (fd > 0) {
-					::write(fd, ptr, 188);
-					::close(fd);
-				}
+			const char fileFIFO[] = "/tmp/fifo";
+			int fd = ::open(fileFIFO, O_WRONLY | O_NONBLOCK);
+			if (fd > 0) {
+				::write(fd, ptr, 188);
+				::close(fd);
+			}
 #endif
+			}
+			break;
+		case 21:
+			// Empty
+			break;
+		default:
+			if (_pat->isMarkedAsPMT(pid)) {
+				// Did we finish collecting PMT, we always get a valid PMT (empty or filled)
+				auto it = _pmtMap.find(pid);
+				if (it == _pmtMap.end()) {
+					it = _pmtMap.emplace(pid, makeTable_L<PMT>()).first;
+				} else {
+					renewTableOnChange_L(id, pid, ptr, "PMT", it->second);
 				}
-				break;
-			case 21:
-				// Empty
-				break;
-			default:
-				if (_pat->isMarkedAsPMT(pid)) {
-					// Did we finish collecting PMT, we always get a valid PMT (empty or filled)
-					mpegts::SpPMT pmt = _pmtMap.try_emplace(pid, std::make_shared<PMT>()).first->second;
-					if (!pmt->isCollected()) {
-						// collect PMT data
-						pmt->collectData(id, TableData::PMT_ID, ptr, false);
-						if (pmt->isCollected()) {
-							pmt->parse(id);
-						}
+				const mpegts::SpPMT &pmt = it->second;
+				if (!pmt->isCollected()) {
+					// collect PMT data
+					pmt->collectData(id, TableData::PMT_ID, ptr, false);
+					if (pmt->isCollected()) {
+						pmt->parse(id);
+					}
 #ifdef ADDDVBCA
-						const char fileFIFO[] = "/tmp/fifo";
-						int fd = ::open(fileFIFO, O_WRONLY | O_NONBLOCK);
-						if (fd > 0) {
-							::write(fd, ptr, 188);
-							::close(fd);
-						}
-#endif
+					const char fileFIFO[] = "/tmp/fifo";
+					int fd = ::open(fileFIFO, O_WRONLY | O_NONBLOCK);
+					if (fd > 0) {
+						::write(fd, ptr, 188);
+						::close(fd);
 					}
-				} else if (_filterPCR && PCR::isPCRTableData(ptr)) {
-					for (const auto& [_, pmt] : _pmtMap) {
-						const int pcrPID = pmt->getPCRPid();
-						if (pid == pcrPID && _pidTable.isPIDOpened(pcrPID) && _pidTable.getPacketCounter(pcrPID) > 0) {
-							_pcr->collectData(id, ptr);
-						}
+#endif
+				}
+			} else if (_filterPCR && PCR::isPCRTableData(ptr)) {
+				for (const auto& [_, pmt] : _pmtMap) {
+					const int pcrPID = pmt->getPCRPid();
+					if (pid == pcrPID && _pidTable.isPIDOpened(pcrPID) && _pidTable.getPacketCounter(pcrPID) > 0) {
+						_pcr->collectData(id, ptr);
 					}
 				}
-				break;
+			}
+			break;
+	}
+}
+
+void Filter::updatePMTPids_L() {
+	_pmtPids.reset();
+	for (int pid = 0; pid < PidTable::ALL_PIDS; ++pid) {
+		if (_pat->isMarkedAsPMT(pid)) {
+			_pmtPids.set(pid);
 		}
 	}
-	if (filter) {
-		buffer.purge();
+	// A new PAT version may have removed programs
+	for (auto it = _pmtMap.begin(); it != _pmtMap.end(); ) {
+		if (_pmtPids[it->first]) {
+			++it;
+		} else {
+			it = _pmtMap.erase(it);
+		}
 	}
 }
 
@@ -26,12 +26,16 @@
 #include <base/Mutex.h>
 #include <base/XMLSupport.h>
 #include <mpegts/NIT.h>
+#include <mpegts/PacketClassifier.h>
 #include <mpegts/PAT.h>
 #include <mpegts/PCR.h>
 #include <mpegts/PidTable.h>
 #include <mpegts/PMT.h>
 #include <mpegts/SDT.h>
+#include <mpegts/SectionArena.h>
 
+#include <atomic>
+#include <bitset>
 #include <unordered_map>
 
 FW_DECL_NS1(mpegts, PacketBuffer);
@@ -82,6 +86,25 @@ class Filter :
 		/// @param filter enables the software pid filtering
 		void filterData(FeID id, mpegts::PacketBuffer &buffer, bool filter);
 
+		/// Same as @see filterData, but for @p count consecutive buffers
+		/// with only one lock
+		void filterData(FeID id, mpegts::PacketBuffer *buffers, std::size_t count, bool filter);
+
+#ifdef LATENCY_HISTOGRAM
+		/// Measure how long the next filterData call takes, only call this
+		/// from the thread that calls filterData
+		void measureNextFilterData() noexcept {
+			_measureNext = true;
+			_measuredTime = 0;
+		}
+
+		/// Get the time in ns the measured filterData call took, or 0 when
+		/// filterData was not called since @see measureNextFilterData
+		uint64_t getMeasuredFilterTime() const noexcept {
+			return _measuredTime;
+		}
+#endif
+
 		/// This will return true if the requested pid is the active/current one
 		/// accoording to the PCR that is open.
 		/// @param pid specifies the PID to check if it is the current one
@@ -144,9 +167,15 @@ class Filter :
 		// =========================================================================
 		// =========================================================================
 
-		/// Get the total amount of Continuity Counter Error
+		/// Get the amount of times a collected PAT, PMT, SDT or NIT changed
+		/// version, subscribers can compare it with the amount they have seen
+		uint32_t getPSIChanges() const {
+			return _psiChanges;
+		}
+
+		/// Get the total amount of Continuity Counter Error, without taking
+		/// the lock so it does not wait on filterData
 		uint32_t getTotalCCErrors() const {
-			base::MutexLock lock(_mutex);
 			return _pidTable.getTotalCCErrors();
 		}
 
@@ -156,6 +185,12 @@ class Filter :
 			return _pidTable.getPidCSV();
 		}
 
+		/// Get the CSV of the PIDs that are added to every request
+		std::string getUserPids() const {
+			base::MutexLock lock(_mutex);
+			return _userPids;
+		}
+
 		/// Set pid used or not
 		void setPID(int pid, bool val) {
 			base::MutexLock lock(_mutex);
@@ -202,6 +237,38 @@ class Filter :
 
 	private:
 
+		/// @see filterData
+		void filterData_L(FeID id, mpegts::PacketBuffer &buffer, bool filter);
+
+		/// Handle the PSI/SI, PMT and PCR TS packet @p ptr with @p pid
+		void handleTableData_L(FeID id, int pid, const unsigned char *ptr);
+
+		/// Mark the PMT PIDs of the PAT, so they are found without a map lookup
+		void updatePMTPids_L();
+
+		/// Make a new MPEG Table that assembles its sections in our arena
+		template<typename TABLE>
+		std::shared_ptr<TABLE> makeTable_L() const {
+			std::shared_ptr<TABLE> table = std::make_shared<TABLE>();
+			table->setSectionArena(_sectionArena);
+			return table;
+		}
+
+		/// Start collecting @p table again when @p ptr begins a new version of it
+		/// @return true if the table changed
+		template<typename TABLE>
+		bool renewTableOnChange_L(const FeID id, const int pid, const unsigned char *ptr,
+				const char *name, std::shared_ptr<TABLE> &table) {
+			if (!table->isSectionChanged(ptr)) {
+				return false;
+			}
+			SI_LOG_INFO("Frontend: @#1, @#2 - PID @#3: New version @#4, collecting it again",
+				id, name, PID(pid), (ptr[10] & 0x3E) >> 1);
+			table = makeTable_L<TABLE>();
+			++_psiChanges;
+			return true;
+		}
+
 		/// Open requesed PID filter
 		/// @param feID specifies the frontend ID
 		/// @param pid specifies the PID to open with openPid
@@ -238,9 +305,10 @@ class Filter :
 				_pidTable.setPIDClosed(pid);
 				// Need to clear the PID Tables as well?
 				if (pid == 0) {
-					_pat = std::make_shared<PAT>();
+					_pat = makeTable_L<PAT>();
+					_pmtPids.reset();
 				} else if (pid == 17) {
-					_sdt = std::make_shared<SDT>();
+					_sdt = makeTable_L<SDT>();
 				} else if (_pmtMap.find(pid) != _pmtMap.end()) {
 					_pmtMap.erase(pid);
 				} else {
@@ -274,8 +342,16 @@ class Filter :
 		mutable mpegts::SpPAT _pat;
 		mutable mpegts::SpPCR _pcr;
 		mutable mpegts::SpSDT _sdt;
+		SpSectionArena _sectionArena;
+		PacketClassifier _classifier;
+		std::bitset<PidTable::MAX_PIDS> _pmtPids;
+		std::atomic<uint32_t> _psiChanges{0};
 		bool _filterPCR = false;
 		std::string _userPids;
+#ifdef LATENCY_HISTOGRAM
+		bool _measureNext = false;
+		uint64_t _measuredTime = 0;
+#endif
 };
 
 }
@@ -180,8 +180,9 @@ void NIT::doFromXML(const std::string &UNUSED(xml)) {}
 
 void NIT::parse(const FeID id) {
 	for (std::size_t secNr = 0; secNr < _numberOfSections; ++secNr) {
-		TableData::Data tableData;
-		if (getDataForSectionNumber(secNr, tableData)) {
+		const TableData::Data *section = getDataForSectionNumber(secNr);
+		if (section != nullptr) {
+			const TableData::Data &tableData = *section;
 			const unsigned char* data = tableData.data.data();
 			size_t index = 8;
 			_nid =  getWord(index, data);
@@ -19,6 +19,7 @@
 */
 #include <mpegts/PAT.h>
 #include <Log.h>
+#include <mpegts/CRC32.h>
 #include <Unused.h>
 
 #include <array>
@@ -52,8 +53,9 @@ void PAT::doFromXML(const std::string &UNUSED(xml)) {}
 // =============================================================================
 
 void PAT::parse(const FeID id) {
-	Data tableData;
-	if (getDataForSectionNumber(0, tableData)) {
+	const Data *section = getDataForSectionNumber(0);
+	if (section != nullptr) {
+		const Data &tableData = *section;
 		const unsigned char* data = tableData.data.data();
 		_tid =  (data[8u] << 8) | data[9u];
 
@@ -145,7 +147,7 @@ mpegts::TSData PAT::generateFrom(
 	tmp[7]  = len & 0xFF;
 
 	// append calculated CRC
-	const uint32_t crc = mpegts::TableData::calculateCRC32(&tmp[5], len - 4 + 3);
+	const uint32_t crc = mpegts::CRC32::calculate(&tmp[5], len - 4 + 3);
 	tmp[index + 0] = ((crc >> 24) & 0xFF);
 	tmp[index + 1] = ((crc >> 16) & 0xFF);
 	tmp[index + 2] = ((crc >>  8) & 0xFF);
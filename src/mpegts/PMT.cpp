@@ -19,6 +19,7 @@
 */
 #include <mpegts/PMT.h>
 #include <Log.h>
+#include <mpegts/CRC32.h>
 
 namespace mpegts {
 
@@ -106,7 +107,7 @@ void PMT::cleanPI(unsigned char *data) {
 		pmt[7]  =  (newSectionLength & 0xFF);
 
 		// append calculated CRC
-		const uint32_t crc = mpegts::TableData::calculateCRC32(pmt.data() + 5, pmt.size() - 5);
+		const uint32_t crc = mpegts::CRC32::calculate(pmt.data() + 5, pmt.size() - 5);
 		pmt += ((crc >> 24) & 0xFF);
 		pmt += ((crc >> 16) & 0xFF);
 		pmt += ((crc >>  8) & 0xFF);
@@ -137,8 +138,9 @@ void PMT::cleanPI(unsigned char *data) {
 // =============================================================================
 
 int PMT::parsePCRPid() {
-	Data tableData;
-	if (getDataForSectionNumber(0, tableData)) {
+	const Data *section = getDataForSectionNumber(0);
+	if (section != nullptr) {
+		const Data &tableData = *section;
 		const unsigned char* const data = tableData.data.data();
 		_pcrPID = ((data[13u] & 0x1F) << 8) | data[14u];
 	}
@@ -146,8 +148,9 @@ int PMT::parsePCRPid() {
 }
 
 void PMT::parse(const FeID id) {
-	Data tableData;
-	if (getDataForSectionNumber(0, tableData)) {
+	const Data *section = getDataForSectionNumber(0);
+	if (section != nullptr) {
+		const Data &tableData = *section;
 		const unsigned char* const data = tableData.data.data();
 		_programNumber = ((data[ 8u]       ) << 8) | data[ 9u];
 		_pcrPID        = ((data[13u] & 0x1F) << 8) | data[14u];
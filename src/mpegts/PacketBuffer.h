@@ -20,6 +20,7 @@
 #ifndef MPEGTS_PACKET_BUFFER_H_INCLUDE
 #define MPEGTS_PACKET_BUFFER_H_INCLUDE MPEGTS_PACKET_BUFFER_H_INCLUDE
 
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 
@@ -59,7 +60,7 @@ class PacketBuffer {
 
 		/// Reset this TS buffer
 		void reset() noexcept {
-			_decryptPending = false;
+			_decryptPending.store(0, std::memory_order_relaxed);
 			_purgePending = 0;
 			_writeIndex = RTP_HEADER_LEN;
 			_processedIndex = RTP_HEADER_LEN;
@@ -146,29 +147,28 @@ class PacketBuffer {
 			return &_buffer[index];
 		}
 
-		/// Set the decrypt pending flag, so we should check scramble flag if this
-		/// buffer is ready for sending
+		/// Set the decrypt pending flag for one more decrypt batch that has
+		/// TS packets of this buffer, only called by the producer
 		void setDecryptPending() noexcept {
-			_decryptPending = true;
+			_decryptPending.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// Clear the decrypt pending flag for one decrypt batch that has
+		/// finished with the TS packets of this buffer, it may be called by
+		/// any (decrypt) thread
+		void clearDecryptPending() noexcept {
+			_decryptPending.fetch_sub(1, std::memory_order_release);
 		}
 
 		/// This function checks if this TS buffer is ready to be send.
 		/// There should be something in the buffer, in TS_PACKET_SIZE chunks.
-		/// When the pending decrypt flag was set, all scramble flags should
-		/// be cleared from all TS packets.
+		/// When the pending decrypt flag was set, all decrypt batches with
+		/// TS packets of this buffer should be finished.
 		bool isReadyToSend() const noexcept {
 			// ready to send, when there is something in the buffer in TS_PACKET_SIZE chunks
-			// and if all scramble flags are cleared
+			// and the decrypted data is visible to this thread
 //			bool ready = (getCurrentBufferSize() % TS_PACKET_SIZE) == 0;
-			bool ready = full();
-			if (_decryptPending && ready) {
-				const std::size_t size = getNumberOfCompletedPackets();
-				for (std::size_t i = 0; i < size; ++i) {
-					const unsigned char* ts = getTSPacketPtr(i);
-					ready &= ((ts[3] & 0x80) != 0x80);
-				}
-			}
-			return ready;
+			return full() && _decryptPending.load(std::memory_order_acquire) == 0;
 		}
 
 	protected:
@@ -197,7 +197,7 @@ class PacketBuffer {
 		unsigned char       _buffer[MTU];
 		std::size_t         _writeIndex = RTP_HEADER_LEN;
 		mutable std::size_t _processedIndex = RTP_HEADER_LEN;
-		bool                _decryptPending = false;
+		std::atomic<unsigned int> _decryptPending{0};
 		std::size_t         _purgePending = 0;
 
 };
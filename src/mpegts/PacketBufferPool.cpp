@@ -0,0 +1,121 @@
+/* PacketBufferPool.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/PacketBufferPool.h>
+
+#include <Log.h>
+
+#include <algorithm>
+
+namespace mpegts {
+
+// =============================================================================
+// -- Static const data --------------------------------------------------------
+// =============================================================================
+
+static constexpr std::size_t DEFAULT_MAX_IDLE_MB = 1;
+static constexpr std::size_t MAX_IDLE_MB         = 64;
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+PacketBufferPool::PacketBufferPool() :
+	_idleBuffers(0),
+	_inUseBuffers(0),
+	_maxIdleMB(DEFAULT_MAX_IDLE_MB) {}
+
+// =============================================================================
+//  -- base::XMLSupport --------------------------------------------------------
+// =============================================================================
+
+void PacketBufferPool::doAddToXML(std::string &xml) const {
+	base::MutexLock lock(_mutex);
+	ADD_XML_ELEMENT(xml, "poolBuffersInUse", _inUseBuffers);
+	ADD_XML_ELEMENT(xml, "poolBuffersIdle", _idleBuffers);
+	ADD_XML_ELEMENT(xml, "poolSlabsIdle", _idle.size());
+	ADD_XML_NUMBER_INPUT(xml, "poolMaxIdleMB", _maxIdleMB, 0, MAX_IDLE_MB);
+}
+
+void PacketBufferPool::doFromXML(const std::string &xml) {
+	base::MutexLock lock(_mutex);
+	std::string element;
+	if (findXMLElement(xml, "poolMaxIdleMB.value", element)) {
+		const std::size_t size = std::stoi(element);
+		_maxIdleMB = (size < MAX_IDLE_MB) ? size : MAX_IDLE_MB;
+		trim_L();
+	}
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+PacketBuffer* PacketBufferPool::acquire(const std::size_t count) {
+	base::MutexLock lock(_mutex);
+	// Find the smallest idle slab that fits, but do not waste more then half of it
+	auto best = _idle.end();
+	for (auto it = _idle.begin(); it != _idle.end(); ++it) {
+		if (it->count >= count && it->count <= count * 2 &&
+			(best == _idle.end() || it->count < best->count)) {
+			best = it;
+		}
+	}
+	Slab slab;
+	if (best != _idle.end()) {
+		slab = std::move(*best);
+		_idle.erase(best);
+		_idleBuffers -= slab.count;
+	} else {
+		slab.buffers.reset(new PacketBuffer[count]);
+		slab.count = count;
+	}
+	_inUseBuffers += slab.count;
+	PacketBuffer* buffers = slab.buffers.get();
+	_inUse.push_back(std::move(slab));
+	return buffers;
+}
+
+void PacketBufferPool::release(PacketBuffer* buffers) {
+	base::MutexLock lock(_mutex);
+	const auto it = std::find_if(_inUse.begin(), _inUse.end(),
+		[buffers](const Slab &slab) {
+			return slab.buffers.get() == buffers;
+		});
+	if (it == _inUse.end()) {
+		SI_LOG_ERROR("PacketBufferPool: Trying to release an unknown slab");
+		return;
+	}
+	_inUseBuffers -= it->count;
+	_idleBuffers += it->count;
+	_idle.push_back(std::move(*it));
+	_inUse.erase(it);
+	trim_L();
+}
+
+void PacketBufferPool::trim_L() {
+	const std::size_t maxIdleBuffers = (_maxIdleMB * 1024 * 1024) / sizeof(PacketBuffer);
+	while (_idleBuffers > maxIdleBuffers && !_idle.empty()) {
+		// Free the oldest slab first
+		_idleBuffers -= _idle.front().count;
+		_idle.erase(_idle.begin());
+	}
+}
+
+} // namespace mpegts
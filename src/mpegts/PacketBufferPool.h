@@ -0,0 +1,112 @@
+/* PacketBufferPool.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_PACKET_BUFFER_POOL_H_INCLUDE
+#define MPEGTS_PACKET_BUFFER_POOL_H_INCLUDE MPEGTS_PACKET_BUFFER_POOL_H_INCLUDE
+
+#include <FwDecl.h>
+#include <base/Mutex.h>
+#include <base/XMLSupport.h>
+#include <mpegts/PacketBuffer.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+FW_DECL_SP_NS1(mpegts, PacketBufferPool);
+
+namespace mpegts {
+
+/// The class @c PacketBufferPool hands out slabs of consecutive PacketBuffers
+/// to the Stream rings. Slabs that are given back are kept for reuse, up to
+/// a maximum amount of idle memory, so streams that are not in use do not pin
+/// memory and active streams can use deeper rings.
+class PacketBufferPool :
+	public base::XMLSupport {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		PacketBufferPool();
+
+		virtual ~PacketBufferPool() = default;
+
+		PacketBufferPool(const PacketBufferPool&) = delete;
+
+		PacketBufferPool& operator=(const PacketBufferPool&) = delete;
+
+		// =====================================================================
+		// -- static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		static SpPacketBufferPool makeSP() {
+			return std::make_shared<PacketBufferPool>();
+		}
+
+		// =====================================================================
+		// -- base::XMLSupport -------------------------------------------------
+		// =====================================================================
+	private:
+
+		/// @see XMLSupport
+		virtual void doAddToXML(std::string &xml) const final;
+
+		/// @see XMLSupport
+		virtual void doFromXML(const std::string &xml) final;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get a slab of @p count consecutive PacketBuffers
+		PacketBuffer* acquire(std::size_t count);
+
+		/// Give a slab, that was acquired before, back to the pool
+		void release(PacketBuffer* buffers);
+
+	private:
+
+		/// Free idle slabs until we are below the idle limit
+		void trim_L();
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		struct Slab {
+			std::unique_ptr<PacketBuffer[]> buffers;
+			std::size_t count;
+		};
+
+		base::Mutex _mutex;
+		std::vector<Slab> _idle;
+		std::vector<Slab> _inUse;
+		std::size_t _idleBuffers;
+		std::size_t _inUseBuffers;
+		std::size_t _maxIdleMB;
+};
+
+} // namespace mpegts
+
+#endif // MPEGTS_PACKET_BUFFER_POOL_H_INCLUDE
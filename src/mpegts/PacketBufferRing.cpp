@@ -0,0 +1,237 @@
+/* PacketBufferRing.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/PacketBufferRing.h>
+
+#include <Log.h>
+#include <mpegts/PacketBufferPool.h>
+
+#include <cerrno>
+#include <cstdint>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace mpegts {
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+PacketBufferRing::PacketBufferRing() :
+	_ring(nullptr),
+	_size(0),
+	_eventFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+	_writeIndex(0),
+	_preparedSlots(0),
+	_publishIndex(0),
+	_readIndex(0),
+	_releaseIndex(0),
+	_readSequence(0),
+	_releaseSequence(0),
+	_maxOccupancy(0),
+	_overruns(0) {
+	if (_eventFd == -1) {
+		SI_LOG_PERROR("PacketBufferRing: Unable to create eventfd");
+	}
+}
+
+PacketBufferRing::~PacketBufferRing() {
+	release();
+	if (_eventFd != -1) {
+		::close(_eventFd);
+	}
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void PacketBufferRing::allocate(SpPacketBufferPool pool, const std::size_t size) {
+	if (_ring != nullptr && _pool == pool && _size == size) {
+		return;
+	}
+	release();
+	_pool = pool;
+	_ring = _pool->acquire(size);
+	_size = size;
+	for (std::size_t i = 0; i < _size; ++i) {
+		_ring[i].initialize(0, 0);
+	}
+	reset();
+}
+
+void PacketBufferRing::release() {
+	if (_ring != nullptr) {
+		_pool->release(_ring);
+	}
+	_ring = nullptr;
+	_size = 0;
+	reset();
+}
+
+void PacketBufferRing::reset() noexcept {
+	_writeIndex = 0;
+	_preparedSlots = 0;
+	_publishIndex.store(0, std::memory_order_relaxed);
+	_readIndex.store(0, std::memory_order_relaxed);
+	_releaseIndex.store(0, std::memory_order_relaxed);
+	_readSequence = 0;
+	_releaseSequence = 0;
+	_maxOccupancy.store(0, std::memory_order_relaxed);
+	if (_ring != nullptr) {
+		_ring[0].reset();
+	}
+	// Drain any pending wakeup
+	uint64_t value;
+	while (::read(_eventFd, &value, sizeof(value)) > 0) {}
+}
+
+// =============================================================================
+//  -- Producer functions ------------------------------------------------------
+// =============================================================================
+
+std::size_t PacketBufferRing::prepareWriteSlots() noexcept {
+	const std::size_t size = _size;
+	if (size == 0) {
+		return 0;
+	}
+	// Slots that are read, but still pinned by the consumer, are in use as well
+	const std::size_t releaseIndex = _releaseIndex.load(std::memory_order_acquire);
+	const std::size_t used = (_writeIndex + size - releaseIndex) % size;
+	// Keep one slot between writer and reader, so a full ring is never mistaken
+	// for an empty one. Only count slots up to the end of the ring, so they are
+	// consecutive in memory.
+	const std::size_t freeSlots = size - 1 - used;
+	const std::size_t toEnd = size - _writeIndex;
+	_preparedSlots = (freeSlots < toEnd) ? freeSlots : toEnd;
+	for (std::size_t i = 1; i < _preparedSlots; ++i) {
+		_ring[_writeIndex + i].reset();
+	}
+	return _preparedSlots;
+}
+
+void PacketBufferRing::advanceWrite(const std::size_t count) noexcept {
+	if (count == 0) {
+		return;
+	}
+	_writeIndex = (_writeIndex + count) % _size;
+	// The new write slot may already contain a partial read, so only reset it
+	// when it was not prepared as part of this batch
+	if (count >= _preparedSlots) {
+		_ring[_writeIndex].reset();
+	}
+	_preparedSlots = 0;
+}
+
+void PacketBufferRing::publish() noexcept {
+	const std::size_t size = _size;
+	const std::size_t begin = _publishIndex.load(std::memory_order_relaxed);
+	std::size_t index = begin;
+	while (index != _writeIndex && _ring[index].isReadyToSend()) {
+		index = (index + 1) % size;
+	}
+	if (index == begin) {
+		return;
+	}
+	_publishIndex.store(index, std::memory_order_release);
+
+	const std::size_t occupancy = getOccupancy();
+	if (occupancy > _maxOccupancy.load(std::memory_order_relaxed)) {
+		_maxOccupancy.store(occupancy, std::memory_order_relaxed);
+	}
+	const uint64_t value = 1;
+	if (::write(_eventFd, &value, sizeof(value)) == -1) {
+		SI_LOG_PERROR("PacketBufferRing: Unable to signal eventfd");
+	}
+}
+
+// =============================================================================
+//  -- Consumer functions ------------------------------------------------------
+// =============================================================================
+
+bool PacketBufferRing::waitForData(const int timeoutMs) noexcept {
+	if (getReadableSlots() > 0) {
+		return true;
+	}
+	pollfd pfd;
+	pfd.fd = _eventFd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	const int pollRet = ::poll(&pfd, 1, timeoutMs);
+	if (pollRet > 0 && (pfd.revents & POLLIN) == POLLIN) {
+		uint64_t value;
+		if (::read(_eventFd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+			SI_LOG_PERROR("PacketBufferRing: Unable to read eventfd");
+		}
+	} else if (pollRet < 0 && errno != EINTR) {
+		SI_LOG_PERROR("PacketBufferRing: Error during polling eventfd");
+	}
+	return getReadableSlots() > 0;
+}
+
+std::size_t PacketBufferRing::getReadableSlots() const noexcept {
+	const std::size_t size = _size;
+	if (size == 0) {
+		return 0;
+	}
+	const std::size_t publishIndex = _publishIndex.load(std::memory_order_acquire);
+	return (publishIndex + size - _readIndex.load(std::memory_order_relaxed)) % size;
+}
+
+void PacketBufferRing::advanceRead(const std::size_t count) noexcept {
+	const std::size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+	_readIndex.store((readIndex + count) % _size, std::memory_order_relaxed);
+	_readSequence += count;
+}
+
+void PacketBufferRing::releaseUpTo(const uint64_t sequence) noexcept {
+	if (sequence <= _releaseSequence || _size == 0) {
+		return;
+	}
+	const uint64_t count = ((sequence < _readSequence) ? sequence : _readSequence) - _releaseSequence;
+	const std::size_t releaseIndex = _releaseIndex.load(std::memory_order_relaxed);
+	_releaseIndex.store((releaseIndex + count) % _size, std::memory_order_release);
+	_releaseSequence += count;
+}
+
+// =============================================================================
+//  -- Statistics --------------------------------------------------------------
+// =============================================================================
+
+std::size_t PacketBufferRing::getOccupancy() const noexcept {
+	const std::size_t size = _size;
+	if (size == 0) {
+		return 0;
+	}
+	const std::size_t publishIndex = _publishIndex.load(std::memory_order_relaxed);
+	return (publishIndex + size - _readIndex.load(std::memory_order_relaxed)) % size;
+}
+
+std::size_t PacketBufferRing::getPinned() const noexcept {
+	const std::size_t size = _size;
+	if (size == 0) {
+		return 0;
+	}
+	const std::size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+	return (readIndex + size - _releaseIndex.load(std::memory_order_relaxed)) % size;
+}
+
+} // namespace mpegts
@@ -0,0 +1,179 @@
+/* PacketBufferRing.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_PACKET_BUFFER_RING_H_INCLUDE
+#define MPEGTS_PACKET_BUFFER_RING_H_INCLUDE MPEGTS_PACKET_BUFFER_RING_H_INCLUDE
+
+#include <FwDecl.h>
+#include <mpegts/PacketBuffer.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+FW_DECL_SP_NS1(mpegts, PacketBufferPool);
+
+namespace mpegts {
+
+/// The class @c PacketBufferRing is a single-producer/single-consumer ring of
+/// PacketBuffers between the reader (producer) and writer (consumer) of a Stream.
+/// Filled slots are only published to the consumer when they are ready to send,
+/// so slots that are still waiting for decryption stay with the producer.
+/// The consumer is woken up with an eventfd. Read slots are only given back to
+/// the producer when the consumer releases them, so they can stay pinned while
+/// a zero-copy send is still using them. The slots are taken from a
+/// PacketBufferPool when streaming starts and given back when it stops.
+class PacketBufferRing {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		PacketBufferRing();
+
+		virtual ~PacketBufferRing();
+
+		PacketBufferRing(const PacketBufferRing&) = delete;
+
+		PacketBufferRing& operator=(const PacketBufferRing&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Take @p size slots from @p pool for this ring, only call this when
+		/// producer and consumer are idle
+		void allocate(SpPacketBufferPool pool, std::size_t size);
+
+		/// Give the slots back to the pool, only call this when producer and
+		/// consumer are idle
+		void release();
+
+		/// Empty the ring, only call this when producer and consumer are idle
+		void reset() noexcept;
+
+		/// Get the amount of slots in this ring
+		std::size_t size() const noexcept {
+			return _size;
+		}
+
+		// =====================================================================
+		// -- Producer functions -----------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get the amount of free slots that are consecutive in memory, beginning
+		/// at the current write slot, and prepare them for writing. The current
+		/// write slot is kept as it may still hold a partial read.
+		std::size_t prepareWriteSlots() noexcept;
+
+		/// Get the write slot at @p offset from the current write slot
+		PacketBuffer& getWriteSlot(std::size_t offset = 0) noexcept {
+			return _ring[(_writeIndex + offset) % _size];
+		}
+
+		/// Mark @p count slots, beginning at the current write slot, as filled
+		void advanceWrite(std::size_t count) noexcept;
+
+		/// Publish the filled slots that are ready to send to the consumer
+		/// and wake it up when there is something new
+		void publish() noexcept;
+
+		/// The producer had data, but there was no free slot available
+		void addOverrun() noexcept {
+			_overruns.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// =====================================================================
+		// -- Consumer functions -----------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Wait until there are published slots to read
+		/// @param timeoutMs the maximum time to wait in ms
+		/// @return true if there are slots to read
+		bool waitForData(int timeoutMs) noexcept;
+
+		/// Get the amount of published slots that can be read
+		std::size_t getReadableSlots() const noexcept;
+
+		/// Get the read slot at @p offset from the current read slot
+		PacketBuffer& getReadSlot(std::size_t offset = 0) noexcept {
+			return _ring[(_readIndex.load(std::memory_order_relaxed) + offset) % _size];
+		}
+
+		/// Mark @p count slots, beginning at the current read slot, as read.
+		/// They are given back to the producer with @see releaseUpTo
+		void advanceRead(std::size_t count) noexcept;
+
+		/// Get the sequence number of the current read slot, it counts all
+		/// the slots that were read since the last reset
+		uint64_t getReadSequence() const noexcept {
+			return _readSequence;
+		}
+
+		/// Give all read slots with a sequence number before @p sequence back
+		/// to the producer
+		void releaseUpTo(uint64_t sequence) noexcept;
+
+		// =====================================================================
+		// -- Statistics -------------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get the amount of published slots that are not yet read
+		std::size_t getOccupancy() const noexcept;
+
+		/// Get the highest amount of published slots seen since the last reset
+		std::size_t getMaxOccupancy() const noexcept {
+			return _maxOccupancy.load(std::memory_order_relaxed);
+		}
+
+		/// Get the amount of read slots that are not yet released
+		std::size_t getPinned() const noexcept;
+
+		/// Get the amount of times the producer found the ring full
+		unsigned long getOverruns() const noexcept {
+			return _overruns.load(std::memory_order_relaxed);
+		}
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	private:
+
+		SpPacketBufferPool _pool;
+		PacketBuffer* _ring;
+		std::size_t _size;
+		int _eventFd;
+		std::size_t _writeIndex;
+		std::size_t _preparedSlots;
+		std::atomic<std::size_t> _publishIndex;
+		std::atomic<std::size_t> _readIndex;
+		std::atomic<std::size_t> _releaseIndex;
+		uint64_t _readSequence;
+		uint64_t _releaseSequence;
+		std::atomic<std::size_t> _maxOccupancy;
+		std::atomic<unsigned long> _overruns;
+};
+
+} // namespace mpegts
+
+#endif // MPEGTS_PACKET_BUFFER_RING_H_INCLUDE
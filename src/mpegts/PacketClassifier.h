@@ -0,0 +1,191 @@
+/* PacketClassifier.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_PACKET_CLASSIFIER_H_INCLUDE
+#define MPEGTS_PACKET_CLASSIFIER_H_INCLUDE MPEGTS_PACKET_CLASSIFIER_H_INCLUDE
+
+#include <mpegts/PacketBuffer.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define MPEGTS_CLASSIFIER_NEON
+#endif
+
+namespace mpegts {
+
+/// The class @c PacketClassifier gathers the headers of the TS packets of one
+/// PacketBuffer and checks them all at once, with SSE2/AVX2 or NEON when
+/// available. A TS packet is valid when it has a SYNC byte, no Transport
+/// error indicator and is not a NULL packet. The PSI mask marks the valid
+/// packets with a PID below 32 (PAT, CAT, NIT, SDT, TDT etc.).
+class PacketClassifier {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		PacketClassifier() = default;
+
+		virtual ~PacketClassifier() = default;
+
+		// =====================================================================
+		// -- Other functions --------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Classify the TS packets from @p begin up until @p end of @p buffer
+		void classify(const PacketBuffer &buffer, std::size_t begin, std::size_t end) noexcept {
+			for (std::size_t i = 0; i < LANES; ++i) {
+				_header[i] = 0;
+			}
+			for (std::size_t i = begin; i < end; ++i) {
+				// Independent of the endianness of the CPU (MIPS)
+				const unsigned char *ts = buffer.getTSPacketPtr(i);
+				_header[i] = ts[0] | (ts[1] << 8) | (ts[2] << 16) | (uint32_t(ts[3]) << 24);
+			}
+			classify();
+		}
+
+		/// Get the PID of TS packet @p packetNumber
+		int getPID(const std::size_t packetNumber) const noexcept {
+			return static_cast<int>(_pid[packetNumber]);
+		}
+
+		/// Get a bit mask, bit N is set when TS packet N is valid
+		uint32_t getValidMask() const noexcept {
+			return _validMask;
+		}
+
+		/// Get a bit mask, bit N is set when TS packet N is a valid PSI/SI packet
+		uint32_t getPSIMask() const noexcept {
+			return _psiMask;
+		}
+
+	private:
+
+		/// The headers are stored as little endian 32 bit words, so byte 0 (SYNC)
+		/// are bits 0-7, byte 1 (TEI and PID high) bits 8-15 and byte 2
+		/// (PID low) are bits 16-23
+		void classify() noexcept {
+#if defined(__AVX2__)
+			const __m256i header = _mm256_load_si256(reinterpret_cast<const __m256i *>(_header.data()));
+			const __m256i pid = _mm256_or_si256(
+				_mm256_and_si256(header, _mm256_set1_epi32(0x1F00)),
+				_mm256_and_si256(_mm256_srli_epi32(header, 16), _mm256_set1_epi32(0xFF)));
+			_mm256_store_si256(reinterpret_cast<__m256i *>(_pid.data()), pid);
+			// SYNC byte and Transport error indicator in one compare
+			const __m256i sync = _mm256_cmpeq_epi32(
+				_mm256_and_si256(header, _mm256_set1_epi32(0x80FF)), _mm256_set1_epi32(0x47));
+			const __m256i valid = _mm256_andnot_si256(
+				_mm256_cmpeq_epi32(pid, _mm256_set1_epi32(0x1FFF)), sync);
+			const __m256i psi = _mm256_and_si256(valid,
+				_mm256_cmpgt_epi32(_mm256_set1_epi32(PSI_PID_LIMIT), pid));
+			_validMask = _mm256_movemask_ps(_mm256_castsi256_ps(valid));
+			_psiMask = _mm256_movemask_ps(_mm256_castsi256_ps(psi));
+#elif defined(__SSE2__)
+			_validMask = 0;
+			_psiMask = 0;
+			for (std::size_t i = 0; i < LANES; i += 4) {
+				const __m128i header = _mm_load_si128(reinterpret_cast<const __m128i *>(&_header[i]));
+				const __m128i pid = _mm_or_si128(
+					_mm_and_si128(header, _mm_set1_epi32(0x1F00)),
+					_mm_and_si128(_mm_srli_epi32(header, 16), _mm_set1_epi32(0xFF)));
+				_mm_store_si128(reinterpret_cast<__m128i *>(&_pid[i]), pid);
+				// SYNC byte and Transport error indicator in one compare
+				const __m128i sync = _mm_cmpeq_epi32(
+					_mm_and_si128(header, _mm_set1_epi32(0x80FF)), _mm_set1_epi32(0x47));
+				const __m128i valid = _mm_andnot_si128(
+					_mm_cmpeq_epi32(pid, _mm_set1_epi32(0x1FFF)), sync);
+				const __m128i psi = _mm_and_si128(valid,
+					_mm_cmplt_epi32(pid, _mm_set1_epi32(PSI_PID_LIMIT)));
+				_validMask |= _mm_movemask_ps(_mm_castsi128_ps(valid)) << i;
+				_psiMask |= _mm_movemask_ps(_mm_castsi128_ps(psi)) << i;
+			}
+#elif defined(MPEGTS_CLASSIFIER_NEON)
+			_validMask = 0;
+			_psiMask = 0;
+			for (std::size_t i = 0; i < LANES; i += 4) {
+				const uint32x4_t header = vld1q_u32(&_header[i]);
+				const uint32x4_t pid = vorrq_u32(
+					vandq_u32(header, vdupq_n_u32(0x1F00)),
+					vandq_u32(vshrq_n_u32(header, 16), vdupq_n_u32(0xFF)));
+				vst1q_u32(&_pid[i], pid);
+				// SYNC byte and Transport error indicator in one compare
+				const uint32x4_t sync = vceqq_u32(
+					vandq_u32(header, vdupq_n_u32(0x80FF)), vdupq_n_u32(0x47));
+				const uint32x4_t valid = vbicq_u32(sync, vceqq_u32(pid, vdupq_n_u32(0x1FFF)));
+				const uint32x4_t psi = vandq_u32(valid, vcltq_u32(pid, vdupq_n_u32(PSI_PID_LIMIT)));
+				_validMask |= moveMask(valid) << i;
+				_psiMask |= moveMask(psi) << i;
+			}
+#else
+			_validMask = 0;
+			_psiMask = 0;
+			for (std::size_t i = 0; i < LANES; ++i) {
+				const uint32_t header = _header[i];
+				const uint32_t pid = (header & 0x1F00) | ((header >> 16) & 0xFF);
+				_pid[i] = pid;
+				if ((header & 0x80FF) == 0x47 && pid != 0x1FFF) {
+					_validMask |= 1u << i;
+					if (pid < PSI_PID_LIMIT) {
+						_psiMask |= 1u << i;
+					}
+				}
+			}
+#endif
+		}
+
+#if defined(MPEGTS_CLASSIFIER_NEON)
+		/// Get the top bit of every lane as a 4 bit mask, like _mm_movemask_ps
+		static uint32_t moveMask(const uint32x4_t v) noexcept {
+			static const uint32_t bits[4] = { 1, 2, 4, 8 };
+			const uint32x4_t m = vandq_u32(v, vld1q_u32(bits));
+			uint32x2_t s = vadd_u32(vget_low_u32(m), vget_high_u32(m));
+			s = vpadd_u32(s, s);
+			return vget_lane_u32(s, 0);
+		}
+#endif
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		/// One lane for every TS packet of a PacketBuffer, rounded up
+		static constexpr std::size_t LANES = 8;
+		static constexpr int PSI_PID_LIMIT = 32;
+		static_assert(PacketBuffer::NUMBER_OF_TS_PACKETS <= LANES, "To many TS packets per PacketBuffer");
+
+		alignas(32) std::array<uint32_t, LANES> _header{};
+		alignas(32) std::array<uint32_t, LANES> _pid{};
+		uint32_t _validMask = 0;
+		uint32_t _psiMask = 0;
+};
+
+}
+
+#endif // MPEGTS_PACKET_CLASSIFIER_H_INCLUDE
@@ -0,0 +1,124 @@
+/* PacketView.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_PACKET_VIEW_H_INCLUDE
+#define MPEGTS_PACKET_VIEW_H_INCLUDE MPEGTS_PACKET_VIEW_H_INCLUDE
+
+#include <mpegts/PacketBuffer.h>
+#include <mpegts/PidMask.h>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include <sys/uio.h>
+
+namespace mpegts {
+
+/// The class @c PacketView selects, by index, the TS packets of a PacketBuffer
+/// that are requested by one StreamClient. So one PacketBuffer can be send
+/// differently filtered to several clients, without changing or copying it.
+class PacketView {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		PacketView() = default;
+
+		virtual ~PacketView() = default;
+
+		// =====================================================================
+		// -- Other functions --------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Select the TS packets from @p buffer with a PID that is set in @p mask
+		void select(const PacketBuffer &buffer, const PidMask &mask) noexcept {
+			_count = 0;
+			const std::size_t size = buffer.getNumberOfCompletedPackets();
+			for (std::size_t i = 0; i < size; ++i) {
+				const unsigned char *ts = buffer.getTSPacketPtr(i);
+				const int pid = ((ts[1] & 0x1F) << 8) | ts[2];
+				if (mask.isSet(pid)) {
+					_index[_count] = i;
+					++_count;
+				}
+			}
+		}
+
+		/// Check if no TS packets are selected
+		bool empty() const noexcept {
+			return _count == 0;
+		}
+
+		/// Get the amount of selected TS packets
+		std::size_t getNumberOfPackets() const noexcept {
+			return _count;
+		}
+
+		/// Get the size in bytes of the selected TS packets
+		std::size_t getTSSize() const noexcept {
+			return _count * PacketBuffer::TS_PACKET_SIZE;
+		}
+
+		/// Fill @p iov with the selected TS packets of @p buffer, neighbouring
+		/// packets are joined. There should be room for getMaxNumberOfIovec()
+		/// @return the amount of iovec used
+		std::size_t fillIovec(PacketBuffer &buffer, iovec *iov) const noexcept {
+			std::size_t cnt = 0;
+			for (std::size_t i = 0; i < _count; ++i) {
+				if (cnt > 0 && _index[i] == _index[i - 1] + 1) {
+					iov[cnt - 1].iov_len += PacketBuffer::TS_PACKET_SIZE;
+				} else {
+					iov[cnt].iov_base = buffer.getTSPacketPtr(_index[i]);
+					iov[cnt].iov_len = PacketBuffer::TS_PACKET_SIZE;
+					++cnt;
+				}
+			}
+			return cnt;
+		}
+
+		/// Copy the selected TS packets of @p buffer one after an other to @p dst
+		/// @return the amount of bytes copied
+		std::size_t copyTo(const PacketBuffer &buffer, unsigned char *dst) const noexcept {
+			for (std::size_t i = 0; i < _count; ++i) {
+				std::memcpy(dst + (i * PacketBuffer::TS_PACKET_SIZE),
+					buffer.getTSPacketPtr(_index[i]), PacketBuffer::TS_PACKET_SIZE);
+			}
+			return getTSSize();
+		}
+
+		/// Get the maximum amount of iovec that fillIovec can use
+		static constexpr std::size_t getMaxNumberOfIovec() noexcept {
+			return PacketBuffer::NUMBER_OF_TS_PACKETS;
+		}
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		std::array<std::size_t, PacketBuffer::NUMBER_OF_TS_PACKETS> _index{};
+		std::size_t _count = 0;
+};
+
+}
+
+#endif // MPEGTS_PACKET_VIEW_H_INCLUDE
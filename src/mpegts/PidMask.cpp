@@ -0,0 +1,110 @@
+/* PidMask.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/PidMask.h>
+
+#include <Log.h>
+#include <StringConverter.h>
+
+#include <stdexcept>
+
+namespace mpegts {
+
+// =============================================================================
+// -- Constructors and destructor ----------------------------------------------
+// =============================================================================
+
+PidMask::PidMask() noexcept {
+	clear();
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void PidMask::clear() noexcept {
+	for (std::atomic<uint64_t> &word : _mask) {
+		word.store(0, std::memory_order_relaxed);
+	}
+}
+
+void PidMask::assign(const PidMask &mask) noexcept {
+	for (std::size_t i = 0; i < WORDS; ++i) {
+		_mask[i].store(mask._mask[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void PidMask::merge(const PidMask &mask) noexcept {
+	for (std::size_t i = 0; i < WORDS; ++i) {
+		_mask[i].fetch_or(mask._mask[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void PidMask::parsePIDString(const std::string &reqPids, const bool add,
+		const std::string &userPids) {
+	if (reqPids.find("all") != std::string::npos ||
+		reqPids.find("none") != std::string::npos) {
+		// all/none pids requested then 'remove' all used PIDS first
+		clear();
+		if (reqPids.find("all") != std::string::npos) {
+			setPID(ALL_PIDS, add);
+		}
+		return;
+	}
+	const StringVector reqPidList = StringConverter::split(reqPids, ",");
+	for (const std::string& pid : reqPidList) {
+		try {
+			if (const auto p = std::stoi(pid); (p > 18 || add) && p >= 0 && p < ALL_PIDS) {
+				setPID(p, add);
+			}
+		} catch (const std::invalid_argument &) {
+			SI_LOG_ERROR("PidMask: Error, skipping PID: @#1", pid);
+		}
+	}
+	if (add) {
+		const StringVector userPidList = StringConverter::split(userPids, ",");
+		for (const std::string& pid : userPidList) {
+			try {
+				if (const auto p = std::stoi(pid); p >= 0 && p < ALL_PIDS) {
+					setPID(p, true);
+				}
+			} catch (const std::invalid_argument &) {
+				SI_LOG_ERROR("PidMask: Error, skipping PID: @#1", pid);
+			}
+		}
+	}
+}
+
+std::string PidMask::getPidCSV() const {
+	if (isAll()) {
+		return "all";
+	}
+	std::string csv;
+	for (int i = 0; i < ALL_PIDS; ++i) {
+		if (isSetInMask(i)) {
+			csv += StringConverter::stringFormat("@#1,", i);
+		}
+	}
+	if (csv.size() > 1) {
+		csv.erase(csv.end() - 1);
+	}
+	return csv;
+}
+
+}
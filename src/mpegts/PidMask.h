@@ -0,0 +1,114 @@
+/* PidMask.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_PID_MASK_H_INCLUDE
+#define MPEGTS_PID_MASK_H_INCLUDE MPEGTS_PID_MASK_H_INCLUDE
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mpegts {
+
+/// The class @c PidMask is a bitmap of the PIDs requested by one StreamClient.
+/// It is changed by the RTSP/HTTP thread and read by the Stream writer, so
+/// every word is a relaxed atomic.
+class PidMask {
+		// =========================================================================
+		//  -- Constructors and destructor -----------------------------------------
+		// =========================================================================
+	public:
+
+		PidMask() noexcept;
+
+		virtual ~PidMask() = default;
+
+		PidMask(const PidMask&) = delete;
+
+		PidMask& operator=(const PidMask&) = delete;
+
+		// =========================================================================
+		//  -- Other member functions ----------------------------------------------
+		// =========================================================================
+	public:
+
+		/// Remove all PIDs
+		void clear() noexcept;
+
+		/// Copy all PIDs from @p mask
+		void assign(const PidMask &mask) noexcept;
+
+		/// Add all PIDs from @p mask
+		void merge(const PidMask &mask) noexcept;
+
+		/// Parse the CSV PID string with requested PIDs like @see Filter does
+		/// @param reqPids specifies the requested PIDs
+		/// @param add specifies if true to add the PIDs or false to remove them
+		/// @param userPids specifies the CSV of PIDs that are always added
+		void parsePIDString(const std::string &reqPids, bool add, const std::string &userPids);
+
+		/// Set pid used or not
+		void setPID(int pid, bool use) noexcept {
+			const uint64_t bit = uint64_t(1) << (pid % 64);
+			if (use) {
+				_mask[pid / 64].fetch_or(bit, std::memory_order_relaxed);
+			} else {
+				_mask[pid / 64].fetch_and(~bit, std::memory_order_relaxed);
+			}
+		}
+
+		/// Check if this pid is set, or if all PIDs are requested
+		bool isSet(const int pid) const noexcept {
+			return isAll() || isSetInMask(pid);
+		}
+
+		/// Check if this pid is set in the mask self
+		bool isSetInMask(const int pid) const noexcept {
+			const uint64_t bit = uint64_t(1) << (pid % 64);
+			return (_mask[pid / 64].load(std::memory_order_relaxed) & bit) != 0;
+		}
+
+		/// Check if all PIDs (full Transport Stream) are requested
+		bool isAll() const noexcept {
+			return isSetInMask(ALL_PIDS);
+		}
+
+		/// Get the CSV of all the requested PID
+		std::string getPidCSV() const;
+
+		// =========================================================================
+		//  -- Data members --------------------------------------------------------
+		// =========================================================================
+	public:
+
+		static constexpr int MAX_PIDS = 8193;
+		static constexpr int ALL_PIDS = 8192;
+
+	private:
+
+		static constexpr std::size_t WORDS = (MAX_PIDS + 63) / 64;
+
+		std::array<std::atomic<uint64_t>, WORDS> _mask;
+};
+
+}
+
+#endif // MPEGTS_PID_MASK_H_INCLUDE
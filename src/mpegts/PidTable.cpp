@@ -29,12 +29,12 @@ namespace mpegts {
 // -- Constructors and destructor ----------------------------------------------
 // =============================================================================
 PidTable::PidTable() noexcept {
-	for (size_t i = 0; i < MAX_PIDS; ++i) {
-		resetPidData(i);
-	}
+	_opened.fill(0);
+	_statsIndex.fill(NO_STATS);
+	_state.fill(State::Closed);
 	_changed = false;
-	_totalCCErrors = 0;
-	_totalCCErrorsBegin = 0;
+	_totalCCErrors.store(0, std::memory_order_relaxed);
+	_totalCCErrorsBegin.store(0, std::memory_order_relaxed);
 	_totalCCErrorsBeginSet = false;
 }
 
@@ -43,12 +43,12 @@ PidTable::PidTable() noexcept {
 // =============================================================================
 void PidTable::clear() noexcept {
 	_changed = false;
-	_totalCCErrorsBegin = 0;
+	_totalCCErrorsBegin.store(0, std::memory_order_relaxed);
 	_totalCCErrorsBeginSet = false;
 	for (size_t i = 0; i < MAX_PIDS; ++i) {
 		// Check PID still open.
 		// Then set PID not used, to handle and close them later
-		if (_data[i].state != State::Closed && _data[i].state != State::ShouldOpen) {
+		if (_state[i] != State::Closed && _state[i] != State::ShouldOpen) {
 			setPID(i, false);
 		} else {
 			resetPidData(i);
@@ -57,19 +57,17 @@ void PidTable::clear() noexcept {
 }
 
 void PidTable::resetPidData(const int pid) noexcept {
-	_data[pid].state    = State::Closed;
-	_data[pid].cc       = 0x80;
-	_data[pid].cc_error = 0;
-	_data[pid].count    = 0;
+	setState(pid, State::Closed);
+	removeStats(pid);
 }
 
 std::string PidTable::getPidCSV() const {
-	if (_data[ALL_PIDS].state == State::Opened) {
+	if (isAllPID()) {
 		return "all";
 	}
 	std::string csv;
 	for (size_t i = 0; i < MAX_PIDS; ++i) {
-		if (_data[i].state == State::Opened) {
+		if (isPIDOpened(i)) {
 			csv += StringConverter::stringFormat("@#1,", i);
 		}
 	}
@@ -81,22 +79,22 @@ std::string PidTable::getPidCSV() const {
 }
 
 void PidTable::setPID(const int pid, const bool use) noexcept {
-	switch (_data[pid].state) {
+	switch (_state[pid]) {
 		case State::Closed:
 			if (use) {
-				_data[pid].state = State::ShouldOpen;
+				setState(pid, State::ShouldOpen);
 				_changed = true;
 			}
 			break;
 		case State::ShouldClose:
 			if (use) {
-				_data[pid].state = State::ShouldCloseReopen;
+				setState(pid, State::ShouldCloseReopen);
 				_changed = true;
 			}
 			break;
 		case State::Opened:
 			if (!use) {
-				_data[pid].state = State::ShouldClose;
+				setState(pid, State::ShouldClose);
 				_changed = true;
 			}
 			break;
@@ -107,18 +105,51 @@ void PidTable::setPID(const int pid, const bool use) noexcept {
 }
 
 void PidTable::setPIDClosed(const int pid) noexcept {
-	switch (_data[pid].state) {
+	switch (_state[pid]) {
 		case State::ShouldCloseReopen:
-			_data[pid].state = State::ShouldOpen;
+			setState(pid, State::ShouldOpen);
 			_changed = true;
 			break;
 		default:
-			_data[pid].state = State::Closed;
+			setState(pid, State::Closed);
 			break;
 	}
-	_data[pid].cc       = 0x80;
-	_data[pid].cc_error = 0;
-	_data[pid].count    = 0;
+	removeStats(pid);
+}
+
+void PidTable::setPIDOpened(const int pid) noexcept {
+	setState(pid, State::Opened);
+	addStats(pid);
+}
+
+void PidTable::setState(const int pid, const uint8_t state) noexcept {
+	_state[pid] = state;
+	const uint64_t bit = uint64_t(1) << (pid % 64);
+	if (state == State::Opened) {
+		_opened[pid / 64] |= bit;
+	} else {
+		_opened[pid / 64] &= ~bit;
+	}
+}
+
+void PidTable::addStats(const int pid) {
+	if (_statsIndex[pid] != NO_STATS) {
+		return;
+	}
+	_statsIndex[pid] = _stats.size();
+	_stats.push_back(PidStats{0, 0, static_cast<uint16_t>(pid), 0x80});
+}
+
+void PidTable::removeStats(const int pid) noexcept {
+	const uint16_t index = _statsIndex[pid];
+	if (index == NO_STATS) {
+		return;
+	}
+	// Move the last one into this place, so the array stays dense
+	_stats[index] = _stats.back();
+	_statsIndex[_stats[index].pid] = index;
+	_stats.pop_back();
+	_statsIndex[pid] = NO_STATS;
 }
 
 }
@@ -20,12 +20,18 @@
 #ifndef MPEGTS_PIDTABLE_H_INCLUDE
 #define MPEGTS_PIDTABLE_H_INCLUDE MPEGTS_PIDTABLE_H_INCLUDE
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace mpegts {
 
-/// The class @c PidTable carries all the PID and DMX information
+/// The class @c PidTable carries all the PID and DMX information.
+/// The filter decision of every TS packet only needs the bitmap of opened
+/// PIDs, and the statistics are kept in a dense array for the opened PIDs
+/// only. The PID states are only used when (un)setting PID filters.
 class PidTable {
 		// =========================================================================
 		//  -- Constructors and destructor -----------------------------------------
@@ -56,44 +62,53 @@ class PidTable {
 
 		/// Get the amount of packet that were received of this pid
 		uint32_t getPacketCounter(const int pid) const noexcept {
-			return _data[pid].count;
+			const uint16_t index = _statsIndex[pid];
+			return (index != NO_STATS) ? _stats[index].count : 0;
 		}
 
 		/// Get the amount Continuity Counter Error of this pid
 		uint32_t getCCErrors(const int pid) const noexcept {
-			return _data[pid].cc_error;
+			const uint16_t index = _statsIndex[pid];
+			return (index != NO_STATS) ? _stats[index].ccError : 0;
 		}
 
-		/// Get the total amount of Continuity Counter Error
+		/// Get the total amount of Continuity Counter Error, this may be
+		/// called without holding the lock of the owner
 		uint32_t getTotalCCErrors() const noexcept {
-			return _totalCCErrors - _totalCCErrorsBegin;
+			return _totalCCErrors.load(std::memory_order_relaxed) -
+				_totalCCErrorsBegin.load(std::memory_order_relaxed);
 		}
 
 		/// Get the CSV of all the requested PID
 		std::string getPidCSV() const;
 
-		/// Set the continuity counter for pid
+		/// Set the continuity counter for pid, should be an opened pid
 		void addPIDData(const int pid, const uint8_t ccByte) noexcept {
-			PidData &data = _data[pid];
-			++data.count;
+			const uint16_t index = _statsIndex[pid];
+			if (index == NO_STATS) {
+				return;
+			}
+			PidStats &stats = _stats[index];
+			++stats.count;
 			// Only if it has a Payload
 			if ((ccByte & 0x10) == 0x10) {
 				const uint8_t cc = ccByte & 0x0F;
-				if (data.cc == 0x80) {
-					data.cc = cc;
+				if (stats.cc == 0x80) {
+					stats.cc = cc;
 					if (!_totalCCErrorsBeginSet) {
-						_totalCCErrorsBegin = _totalCCErrors;
+						_totalCCErrorsBegin.store(_totalCCErrors.load(std::memory_order_relaxed),
+							std::memory_order_relaxed);
 						_totalCCErrorsBeginSet = true;
 					}
 					return;
 				}
-				++data.cc;
-				data.cc %= 0x10;
-				if (data.cc != cc) {
-					const uint8_t diff = (cc >= data.cc) ? (cc - data.cc) : ((0x10 - data.cc) + cc);
-					data.cc = cc;
-					data.cc_error += diff;
-					_totalCCErrors += diff;
+				++stats.cc;
+				stats.cc %= 0x10;
+				if (stats.cc != cc) {
+					const uint8_t diff = (cc >= stats.cc) ? (cc - stats.cc) : ((0x10 - stats.cc) + cc);
+					stats.cc = cc;
+					stats.ccError += diff;
+					_totalCCErrors.fetch_add(diff, std::memory_order_relaxed);
 				}
 			}
 		}
@@ -103,13 +118,13 @@ class PidTable {
 
 		/// Check if this pid is opened
 		bool isPIDOpened(const int pid) const noexcept {
-			return _data[pid].state == State::Opened;
+			return (_opened[pid / 64] >> (pid % 64)) & 1;
 		}
 
 		/// Check if this pid should be closed
 		bool shouldPIDClose(const int pid) const noexcept {
-			return _data[pid].state == State::ShouldClose ||
-				_data[pid].state == State::ShouldCloseReopen;
+			return _state[pid] == State::ShouldClose ||
+				_state[pid] == State::ShouldCloseReopen;
 		}
 
 		/// Set that this pid is closed
@@ -117,13 +132,11 @@ class PidTable {
 
 		/// Check if PID should be opened
 		bool shouldPIDOpen(const int pid) const noexcept {
-			return _data[pid].state == State::ShouldOpen;
+			return _state[pid] == State::ShouldOpen;
 		}
 
 		/// Set that this pid is opened
-		void setPIDOpened(const int pid) noexcept {
-			_data[pid].state = State::Opened;
-		}
+		void setPIDOpened(int pid) noexcept;
 
 		/// Set all PID
 		void setAllPID(const bool use) noexcept {
@@ -132,7 +145,7 @@ class PidTable {
 
 		/// Check if all PIDs (full Transport Stream) is on
 		bool isAllPID() const noexcept {
-			return _data[ALL_PIDS].state == State::Opened;
+			return isPIDOpened(ALL_PIDS);
 		}
 
 	protected:
@@ -140,6 +153,17 @@ class PidTable {
 		/// Reset the pid data like counters etc.
 		void resetPidData(int pid) noexcept;
 
+	private:
+
+		/// Set the state of @p pid and keep the opened bitmap in sync
+		void setState(int pid, uint8_t state) noexcept;
+
+		/// Give @p pid a place in the dense statistics array
+		void addStats(int pid);
+
+		/// Remove @p pid from the dense statistics array
+		void removeStats(int pid) noexcept;
+
 		// =========================================================================
 		//  -- Data members --------------------------------------------------------
 		// =========================================================================
@@ -152,26 +176,35 @@ class PidTable {
 
 	private:
 
-		enum class State {
-			ShouldOpen,
-			Opened,
-			ShouldClose,
-			ShouldCloseReopen,
-			Closed
+		/// PID State, as plain constants so the table is one byte per PID
+		struct State {
+			static constexpr uint8_t ShouldOpen        = 0;
+			static constexpr uint8_t Opened            = 1;
+			static constexpr uint8_t ShouldClose       = 2;
+			static constexpr uint8_t ShouldCloseReopen = 3;
+			static constexpr uint8_t Closed            = 4;
 		};
 
-		// PID State
-		struct PidData {
-			State state;
-			uint8_t cc;        /// continuity counter (0 - 15) of this PID
-			uint32_t cc_error; /// cc error count
+		// PID Statistics
+		struct PidStats {
 			uint32_t count;    /// the number of times this pid occurred
+			uint32_t ccError;  /// cc error count
+			uint16_t pid;      /// the pid of these statistics
+			uint8_t cc;        /// continuity counter (0 - 15) of this PID
 		};
-		uint32_t _totalCCErrors;
-		uint32_t _totalCCErrorsBegin;
+
+		static constexpr uint16_t NO_STATS = 0xFFFF;
+
+		std::atomic<uint32_t> _totalCCErrors;
+		std::atomic<uint32_t> _totalCCErrorsBegin;
 		bool _totalCCErrorsBeginSet;
 		bool _changed;
-		PidData _data[MAX_PIDS];
+		/// Bitmap of the opened PIDs, used for every TS packet
+		std::array<uint64_t, (MAX_PIDS + 63) / 64> _opened;
+		/// Index into @c _stats for the opened PIDs
+		std::array<uint16_t, MAX_PIDS> _statsIndex;
+		std::vector<PidStats> _stats;
+		std::array<uint8_t, MAX_PIDS> _state;
 };
 
 }
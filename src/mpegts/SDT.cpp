@@ -58,8 +58,9 @@ void SDT::doFromXML(const std::string &UNUSED(xml)) {}
 
 void SDT::parse(const FeID id) {
 	for (std::size_t secNr = 0; secNr < _numberOfSections; ++secNr) {
-		TableData::Data tableData;
-		if (getDataForSectionNumber(secNr, tableData)) {
+		const TableData::Data *section = getDataForSectionNumber(secNr);
+		if (section != nullptr) {
+			const TableData::Data &tableData = *section;
 			const unsigned char* data = tableData.data.data();
 			_transportStreamID = (data[ 8u] << 8u) | data[ 9u];
 			_networkID         = (data[13u] << 8u) | data[14u];
@@ -0,0 +1,52 @@
+/* SectionArena.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <mpegts/SectionArena.h>
+
+namespace mpegts {
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+unsigned char* SectionArena::acquire() {
+	base::MutexLock lock(_mutex);
+	if (_free.empty()) {
+		_blocks.emplace_back(new unsigned char[SLOT_SIZE * SLOTS_PER_BLOCK]);
+		unsigned char* block = _blocks.back().get();
+		for (std::size_t i = SLOTS_PER_BLOCK; i > 0; --i) {
+			_free.push_back(block + ((i - 1) * SLOT_SIZE));
+		}
+	}
+	unsigned char* slot = _free.back();
+	_free.pop_back();
+	++_inUse;
+	return slot;
+}
+
+void SectionArena::release(unsigned char* slot) {
+	if (slot == nullptr) {
+		return;
+	}
+	base::MutexLock lock(_mutex);
+	_free.push_back(slot);
+	--_inUse;
+}
+
+} // namespace mpegts
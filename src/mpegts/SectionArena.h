@@ -0,0 +1,103 @@
+/* SectionArena.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef MPEGTS_SECTION_ARENA_H_INCLUDE
+#define MPEGTS_SECTION_ARENA_H_INCLUDE MPEGTS_SECTION_ARENA_H_INCLUDE
+
+#include <FwDecl.h>
+#include <base/Mutex.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+FW_DECL_SP_NS1(mpegts, SectionArena);
+
+namespace mpegts {
+
+/// The class @c SectionArena hands out fixed size slots where TableData can
+/// assemble a section from TS packets. Slots that are given back are kept for
+/// reuse, so collecting PSI sections does not allocate on the reader thread
+/// once the arena has grown to the amount of sections in progress.
+class SectionArena {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		SectionArena() = default;
+
+		virtual ~SectionArena() = default;
+
+		SectionArena(const SectionArena&) = delete;
+
+		SectionArena& operator=(const SectionArena&) = delete;
+
+		// =====================================================================
+		// -- static member functions ------------------------------------------
+		// =====================================================================
+	public:
+
+		static SpSectionArena makeSP() {
+			return std::make_shared<SectionArena>();
+		}
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Get a slot of @c SLOT_SIZE bytes
+		unsigned char* acquire();
+
+		/// Give a slot, that was acquired before, back to the arena
+		void release(unsigned char* slot);
+
+		/// Get the amount of slots that are handed out
+		std::size_t getSlotsInUse() const {
+			base::MutexLock lock(_mutex);
+			return _inUse;
+		}
+
+		// =====================================================================
+		// -- Data members -----------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Largest (private) section including table ID and section length
+		static constexpr std::size_t MAX_SECTION_SIZE = 4096;
+
+		/// A slot holds the TS header and pointer field of the first packet,
+		/// the section and the stuffing of the last packet
+		static constexpr std::size_t SLOT_SIZE = MAX_SECTION_SIZE + 188 + 4;
+
+		/// The amount of slots that are allocated at once
+		static constexpr std::size_t SLOTS_PER_BLOCK = 8;
+
+	private:
+
+		base::Mutex _mutex;
+		std::vector<std::unique_ptr<unsigned char[]>> _blocks;
+		std::vector<unsigned char*> _free;
+		std::size_t _inUse = 0;
+};
+
+} // namespace mpegts
+
+#endif // MPEGTS_SECTION_ARENA_H_INCLUDE
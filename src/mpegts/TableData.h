@@ -21,14 +21,19 @@
 #define MPEGTS_TABLE_DATA_H_INCLUDE MPEGTS_TABLE_DATA_H_INCLUDE
 
 #include <Defs.h>
+#include <FwDecl.h>
 
 #include <cstdint>
 #include <string>
-#include <map>
+#include <string_view>
+#include <vector>
+
+FW_DECL_SP_NS1(mpegts, SectionArena);
 
 namespace mpegts {
 
 using TSData = std::basic_string<unsigned char>;
+using TSDataView = std::basic_string_view<unsigned char>;
 
 class TableData {
 		// =========================================================================
@@ -68,14 +73,11 @@ class TableData {
 
 		TableData() = default;
 
-		virtual ~TableData() = default;
+		virtual ~TableData();
 
-		// =========================================================================
-		//  -- Static member functions ---------------------------------------------
-		// =========================================================================
-	public:
+		TableData(const TableData&) = delete;
 
-		static uint32_t calculateCRC32(const unsigned char* data, std::size_t len) noexcept;
+		TableData& operator=(const TableData&) = delete;
 
 		// =========================================================================
 		//  -- Other member functions ----------------------------------------------
@@ -85,10 +87,15 @@ class TableData {
 		/// Clear the collected table and data
 		virtual void clear() noexcept;
 
-		/// Get an copy of the requested table data
+		/// Set the arena where the sections are assembled, when not set this
+		/// table will make its own arena when needed
+		void setSectionArena(SpSectionArena arena) noexcept;
+
+		/// Get the requested section, the data is a view into the arena and is
+		/// valid until this table is cleared or collects this section again
 		/// @param secNr
-		/// @param data
-		bool getDataForSectionNumber(size_t secNr, TableData::Data &data) const noexcept;
+		/// @return nullptr if this section is not (being) collected
+		const Data *getDataForSectionNumber(size_t secNr) const noexcept;
 
 		/// Collect Table data for tableID
 		void collectData(FeID id, int tableID, const unsigned char* data, bool trace) {
@@ -114,6 +121,12 @@ class TableData {
 		/// Get the associated PID of this table
 		int getAssociatedPID() const;
 
+		/// Check if the section that starts in TS packet @p data is a new
+		/// version of this collected table. Only the section header (and the
+		/// CRC of sections in one TS packet) is compared, so it is cheap
+		/// enough to call for every TS packet of the table PID
+		bool isSectionChanged(const unsigned char* data) const noexcept;
+
 	protected:
 
 		/// Add Table data that was collected
@@ -156,6 +169,13 @@ class TableData {
 		/// Collect Table data for tableID
 		void collectData(FeID id, int tableID, const unsigned char* data, bool trace, bool raw);
 
+		/// Get the section that is currently being collected
+		Data &getCurrentSection();
+
+		/// Give the arena slot of @p section back and reset it, so it will
+		/// be collected again
+		void resetSection(Data &section) noexcept;
+
 		/// Check if all sections are collected
 		bool checkAllCollected() const noexcept;
 
@@ -165,17 +185,19 @@ class TableData {
 	public:
 
 		struct Data {
-			int tableID;
-			std::size_t sectionLength;
-			int version;
-			int nextIndicator;
-			int secNr;
-			int lastSecNr;
-			uint32_t crc;
-			TSData data;
-			int cc;
-			int pid;
-			bool collected;
+			int tableID = 0;
+			std::size_t sectionLength = 0;
+			int version = 0;
+			int nextIndicator = 0;
+			int secNr = 0;
+			int lastSecNr = 0;
+			uint32_t crc = 0;
+			TSDataView data;
+			int cc = 0;
+			int pid = -1;
+			bool collected = false;
+			/// The arena slot @c data is pointing into
+			unsigned char *slot = nullptr;
 		};
 
 	protected:
@@ -186,7 +208,8 @@ class TableData {
 
 		std::size_t _currentSectionNumber = 0;
 		mutable bool _collectingFinished = false;
-		std::map<int, Data> _dataTable;
+		std::vector<Data> _dataTable;
+		SpSectionArena _arena;
 
 };
 
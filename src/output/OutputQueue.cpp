@@ -0,0 +1,195 @@
+/* OutputQueue.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <output/OutputQueue.h>
+
+#include <socket/SocketAttr.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+
+namespace output {
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+bool OutputQueue::write(SocketAttr &socket, const iovec *iov, const int iovcnt) {
+	base::MutexLock lock(_mutex);
+	if (!flush_L(socket)) {
+		return false;
+	}
+	std::size_t sent = 0;
+	if (_units.empty()) {
+		std::size_t total = 0;
+		for (int i = 0; i < iovcnt; ++i) {
+			total += iov[i].iov_len;
+		}
+		const ssize_t ret = socket.writeDataNonBlocking(iov, iovcnt);
+		if (ret == -1) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				return false;
+			}
+		} else {
+			sent = ret;
+		}
+		if (sent == total) {
+			return true;
+		}
+	}
+	queue_L(iov, iovcnt, sent);
+	return applyHighWaterMark_L();
+}
+
+bool OutputQueue::writeReply(SocketAttr &socket, const void *buf, const std::size_t len) {
+	base::MutexLock lock(_mutex);
+	if (_offset > 0) {
+		// Wait until the rest of the partly written unit is send
+		const std::vector<unsigned char> &unit = _units.front();
+		const std::size_t left = unit.size() - _offset;
+		if (!socket.sendData(unit.data() + _offset, left, MSG_NOSIGNAL)) {
+			return false;
+		}
+		_queued.fetch_sub(left, std::memory_order_relaxed);
+		popFront_L();
+	}
+	return socket.sendData(buf, len, MSG_NOSIGNAL);
+}
+
+bool OutputQueue::flush(SocketAttr &socket) {
+	base::MutexLock lock(_mutex);
+	return flush_L(socket);
+}
+
+void OutputQueue::clear() {
+	base::MutexLock lock(_mutex);
+	while (!_units.empty()) {
+		popFront_L();
+	}
+	_offset = 0;
+	_queued.store(0, std::memory_order_relaxed);
+}
+
+bool OutputQueue::flush_L(SocketAttr &socket) {
+	while (!_units.empty()) {
+		std::array<iovec, MAX_FLUSH_IOV> iov;
+		std::size_t iovcnt = 0;
+		std::size_t total = 0;
+		for (std::vector<unsigned char> &unit : _units) {
+			if (iovcnt == MAX_FLUSH_IOV) {
+				break;
+			}
+			const std::size_t skip = (iovcnt == 0) ? _offset : 0;
+			iov[iovcnt].iov_base = unit.data() + skip;
+			iov[iovcnt].iov_len = unit.size() - skip;
+			total += iov[iovcnt].iov_len;
+			++iovcnt;
+		}
+		const ssize_t ret = socket.writeDataNonBlocking(iov.data(), iovcnt);
+		if (ret == -1) {
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		std::size_t sent = ret;
+		_queued.fetch_sub(sent, std::memory_order_relaxed);
+		while (sent > 0) {
+			const std::size_t left = _units.front().size() - _offset;
+			if (sent < left) {
+				_offset += sent;
+				break;
+			}
+			sent -= left;
+			popFront_L();
+		}
+		if (static_cast<std::size_t>(ret) < total) {
+			// The Socket is full, try again later
+			break;
+		}
+	}
+	return true;
+}
+
+void OutputQueue::queue_L(const iovec *iov, const int iovcnt, std::size_t skip) {
+	// The memory of written units is used again, so this does not allocate
+	// once the queue is in use for a while
+	std::vector<unsigned char> unit;
+	if (!_spare.empty()) {
+		unit = std::move(_spare.back());
+		_spare.pop_back();
+	}
+	unit.clear();
+	std::size_t size = 0;
+	for (int i = 0; i < iovcnt; ++i) {
+		size += iov[i].iov_len;
+	}
+	unit.reserve(size);
+	for (int i = 0; i < iovcnt; ++i) {
+		const unsigned char *data = static_cast<const unsigned char *>(iov[i].iov_base);
+		unit.insert(unit.end(), data, data + iov[i].iov_len);
+	}
+	if (_units.empty()) {
+		// The unit was partly written already
+		_offset = skip;
+	}
+	_units.push_back(std::move(unit));
+	const std::size_t queued = _queued.fetch_add(size - skip, std::memory_order_relaxed) + (size - skip);
+	if (queued > _maxQueued.load(std::memory_order_relaxed)) {
+		_maxQueued.store(queued, std::memory_order_relaxed);
+	}
+}
+
+bool OutputQueue::applyHighWaterMark_L() {
+	const std::size_t highWaterMark = _highWaterMark.load(std::memory_order_relaxed);
+	while (_queued.load(std::memory_order_relaxed) > highWaterMark) {
+		if (_policy.load(std::memory_order_relaxed) == Policy::DISCONNECT) {
+			return false;
+		}
+		// A partly written unit should be completed, or the client gets
+		// a broken TS packet or RTP/TCP frame
+		auto unit = _units.begin();
+		if (_offset > 0) {
+			++unit;
+		}
+		if (unit == _units.end()) {
+			break;
+		}
+		_queued.fetch_sub(unit->size(), std::memory_order_relaxed);
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+		_droppedBytes.fetch_add(unit->size(), std::memory_order_relaxed);
+		recycle_L(*unit);
+		_units.erase(unit);
+	}
+	return true;
+}
+
+void OutputQueue::popFront_L() {
+	recycle_L(_units.front());
+	_units.pop_front();
+	_offset = 0;
+}
+
+void OutputQueue::recycle_L(std::vector<unsigned char> &unit) {
+	if (_spare.size() < MAX_SPARE_UNITS) {
+		_spare.push_back(std::move(unit));
+	}
+}
+
+}
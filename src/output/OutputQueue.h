@@ -0,0 +1,160 @@
+/* OutputQueue.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef OUTPUT_OUTPUT_QUEUE_H_INCLUDE
+#define OUTPUT_OUTPUT_QUEUE_H_INCLUDE OUTPUT_OUTPUT_QUEUE_H_INCLUDE
+
+#include <base/Mutex.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <sys/uio.h>
+
+class SocketAttr;
+
+namespace output {
+
+/// The class @c OutputQueue keeps the data of a TCP StreamClient (HTTP or
+/// RTP/TCP) that the Socket could not take yet, so writing never waits for a
+/// slow client. Every write is kept as one unit, so when the queue reaches
+/// its high-water mark whole units (TS buffers or RTP/TCP frames) are dropped,
+/// or the client is disconnected.
+class OutputQueue {
+	public:
+
+		/// What to do when the high-water mark is reached
+		enum class Policy {
+			DROP_OLDEST,
+			DISCONNECT
+		};
+
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		OutputQueue() = default;
+
+		virtual ~OutputQueue() = default;
+
+		OutputQueue(const OutputQueue&) = delete;
+
+		OutputQueue& operator=(const OutputQueue&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Set the high-water mark in bytes and what to do when it is reached
+		void setHighWaterMark(std::size_t bytes, Policy policy) noexcept {
+			_highWaterMark.store(bytes, std::memory_order_relaxed);
+			_policy.store(policy, std::memory_order_relaxed);
+		}
+
+		/// Write @p iov to @p socket without waiting, what does not fit is
+		/// queued after the data that is already waiting
+		/// @return false on a Socket error or when the client should be disconnected
+		bool write(SocketAttr &socket, const iovec *iov, int iovcnt);
+
+		/// Send @p buf (a reply to a request of the client) on the same Socket,
+		/// a partly written unit is completed first so the reply can not land
+		/// in the middle of it. The other waiting units are written after it
+		/// @return false on a Socket error
+		bool writeReply(SocketAttr &socket, const void *buf, std::size_t len);
+
+		/// Write as much of the queued data as the Socket takes now
+		/// @return false on a Socket error
+		bool flush(SocketAttr &socket);
+
+		/// Check if there is no data waiting
+		bool empty() const noexcept {
+			return _queued.load(std::memory_order_relaxed) == 0;
+		}
+
+		/// Drop all waiting data
+		void clear();
+
+		/// Get the amount of bytes waiting
+		std::size_t getQueued() const noexcept {
+			return _queued.load(std::memory_order_relaxed);
+		}
+
+		/// Get the highest amount of bytes that were waiting
+		std::size_t getMaxQueued() const noexcept {
+			return _maxQueued.load(std::memory_order_relaxed);
+		}
+
+		/// Get the amount of dropped units
+		unsigned long getDropped() const noexcept {
+			return _dropped.load(std::memory_order_relaxed);
+		}
+
+		/// Get the amount of bytes in the dropped units
+		unsigned long getDroppedBytes() const noexcept {
+			return _droppedBytes.load(std::memory_order_relaxed);
+		}
+
+	private:
+
+		/// @see flush
+		bool flush_L(SocketAttr &socket);
+
+		/// Queue @p iov, but without the first @p skip bytes that are written already
+		void queue_L(const iovec *iov, int iovcnt, std::size_t skip);
+
+		/// Drop units until the queue is below the high-water mark
+		/// @return false if the client should be disconnected
+		bool applyHighWaterMark_L();
+
+		/// Remove the front unit and keep its memory for later
+		void popFront_L();
+
+		/// Keep the memory of @p unit for a later unit
+		void recycle_L(std::vector<unsigned char> &unit);
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	private:
+
+		/// The most units that are written with one call
+		static constexpr std::size_t MAX_FLUSH_IOV = 64;
+
+		/// The most units that keep their memory for later
+		static constexpr std::size_t MAX_SPARE_UNITS = 64;
+
+		base::Mutex _mutex;
+		std::deque<std::vector<unsigned char>> _units;
+		std::vector<std::vector<unsigned char>> _spare;
+		std::size_t _offset = 0;
+		std::atomic<std::size_t> _queued{0};
+		std::atomic<std::size_t> _maxQueued{0};
+		std::atomic<unsigned long> _dropped{0};
+		std::atomic<unsigned long> _droppedBytes{0};
+		std::atomic<std::size_t> _highWaterMark{4 * 1024 * 1024};
+		std::atomic<Policy> _policy{Policy::DROP_OLDEST};
+};
+
+}
+
+#endif // OUTPUT_OUTPUT_QUEUE_H_INCLUDE
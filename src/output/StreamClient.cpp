@@ -19,6 +19,7 @@
 */
 #include <output/StreamClient.h>
 
+#include <base/Metrics.h>
 #include <base/TimeCounter.h>
 #include <Log.h>
 #include <socket/SocketClient.h>
@@ -47,7 +48,8 @@ StreamClient::StreamClient(FeID feID) :
 		_commandSeq(0),
 		_senderRtpPacketCnt(0),
 		_senderOctectPayloadCnt(0),
-		_payload(0.0) {
+		_payload(0.0),
+		_writeSequence(0) {
 	std::random_device rd;
 	std::mt19937 gen(rd());
 	std::normal_distribution<> dist(0xffff, 0xffff);
@@ -67,6 +69,11 @@ void StreamClient::doAddToXML(std::string &xml) const {
 	ADD_XML_ELEMENT(xml, "httpPort", (_socketClient == nullptr) ? 0 : _socketClient->getSocketPort());
 	ADD_XML_ELEMENT(xml, "spc", _senderRtpPacketCnt.load());
 	ADD_XML_ELEMENT(xml, "clientPayload", _payload.load() / (1024.0 * 1024.0));
+	ADD_XML_ELEMENT(xml, "clientPids", _pidMask.getPidCSV());
+	ADD_XML_ELEMENT(xml, "outputQueued", _outputQueue.getQueued());
+	ADD_XML_ELEMENT(xml, "outputMaxQueued", _outputQueue.getMaxQueued());
+	ADD_XML_ELEMENT(xml, "outputDropped", _outputQueue.getDropped());
+	doAddOutputToXML(xml);
 }
 
 void StreamClient::doFromXML(const std::string &UNUSED(xml)) {}
@@ -106,15 +113,83 @@ bool StreamClient::writeData(mpegts::PacketBuffer& buffer) {
 	const long timestamp = base::TimeCounter::getTicks() * 90;
 	const size_t dataSize = buffer.getCurrentBufferSize();
 
-	++_senderRtpPacketCnt;
-	_senderOctectPayloadCnt += dataSize;
-	_payload += dataSize;
+	const uint32_t cseq = _senderRtpPacketCnt.fetch_add(1, std::memory_order_relaxed) + 1;
+	_senderOctectPayloadCnt.fetch_add(dataSize, std::memory_order_relaxed);
+	_payload.fetch_add(dataSize, std::memory_order_relaxed);
 	_timestamp = timestamp;
-	buffer.tagRTPHeaderWith(_ssrc, _senderRtpPacketCnt, timestamp);
+	buffer.tagRTPHeaderWith(_ssrc, cseq, timestamp);
 
 	return doWriteData(buffer);
 }
 
+bool StreamClient::writeData(mpegts::PacketBuffer& buffer, const mpegts::PacketView& view) {
+	const long timestamp = base::TimeCounter::getTicks() * 90;
+	const size_t dataSize = view.getTSSize();
+
+	const uint32_t cseq = _senderRtpPacketCnt.fetch_add(1, std::memory_order_relaxed) + 1;
+	_senderOctectPayloadCnt.fetch_add(dataSize, std::memory_order_relaxed);
+	_payload.fetch_add(dataSize, std::memory_order_relaxed);
+	_timestamp = timestamp;
+	buffer.tagRTPHeaderWith(_ssrc, cseq, timestamp);
+
+	return doWriteData(buffer, view);
+}
+
+bool StreamClient::writeData(mpegts::PacketBuffer* const* buffers, const std::size_t count) {
+	const long timestamp = base::TimeCounter::getTicks() * 90;
+	for (std::size_t i = 0; i < count; ++i) {
+		const size_t dataSize = buffers[i]->getCurrentBufferSize();
+		const uint32_t cseq = _senderRtpPacketCnt.fetch_add(1, std::memory_order_relaxed) + 1;
+		_senderOctectPayloadCnt.fetch_add(dataSize, std::memory_order_relaxed);
+		_payload.fetch_add(dataSize, std::memory_order_relaxed);
+		buffers[i]->tagRTPHeaderWith(_ssrc, cseq, timestamp);
+	}
+	_timestamp = timestamp;
+
+	return doWriteData(buffers, count);
+}
+
+void StreamClient::addToMetrics(base::Metrics &metrics, const std::string &labels) const {
+	// The session makes the series unique for clients on the same host
+	const std::string clientLabels = labels + "," +
+		base::Metrics::makeLabel("client", _ipAddressOfStream) + "," +
+		base::Metrics::makeLabel("session", getSessionID());
+	const unsigned long payload = _payload.load(std::memory_order_relaxed);
+	const unsigned long sendCalls = _rtp.getSendCalls() + _rtcp.getSendCalls() +
+		((_socketClient == nullptr) ? 0 : _socketClient->getSendCalls());
+	metrics.add("satpi_client_bytes_sent_total", base::Metrics::Type::COUNTER,
+		"TS bytes written to the client", clientLabels, payload);
+	metrics.add("satpi_client_packets_sent_total", base::Metrics::Type::COUNTER,
+		"TS packets written to the client", clientLabels, payload / mpegts::PacketBuffer::TS_PACKET_SIZE);
+	metrics.add("satpi_client_send_calls_total", base::Metrics::Type::COUNTER,
+		"Send system calls done for the client", clientLabels, sendCalls);
+	metrics.add("satpi_client_output_queued_bytes", base::Metrics::Type::GAUGE,
+		"Bytes waiting in the output queue of the client", clientLabels, _outputQueue.getQueued());
+	metrics.add("satpi_client_output_dropped_bytes_total", base::Metrics::Type::COUNTER,
+		"Bytes dropped from the output queue of the client", clientLabels, _outputQueue.getDroppedBytes());
+}
+
+uint64_t StreamClient::getReleasedSequence(const uint64_t readSequence) {
+	if (!_streamActive) {
+		_coalescer.reset();
+	}
+	return _coalescer.empty() ? readSequence : _coalescer.getFirstSequence();
+}
+
+void StreamClient::flushData(const bool force) {
+	doFlushData(force);
+	if (_outputQueue.empty() || _socketClient == nullptr) {
+		return;
+	}
+	if (!_outputQueue.flush(*_socketClient)) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending queued Stream Data to @#2", _feID,
+				_ipAddressOfStream);
+			selfDestruct();
+		}
+	}
+}
+
 void StreamClient::writeRTCPData(const std::string& attributeDescribeString) {
 	const auto [sr, srlen]     = getSR();
 	const auto [sdes, sdeslen] = getSDES();
@@ -134,6 +209,9 @@ void StreamClient::teardown() {
 		_ipAddressOfStream = "0.0.0.0";
 		_userAgent = "None";
 		_sessionTimeoutCheck = SessionTimeoutCheck::WATCHDOG;
+		_pidMask.clear();
+		_coalescer.reset();
+		_outputQueue.clear();
 
 		// Do not delete
 		_socketClient = nullptr;
@@ -168,6 +246,16 @@ void StreamClient::setSocketClient(SocketClient &socket) {
 	_socketClient = &socket;
 }
 
+bool StreamClient::sendReply(SocketClient &socket, const std::string &reply) {
+	{
+		base::MutexLock lock(_mutex);
+		if (_socketClient != nullptr && _socketClient->getFD() == socket.getFD()) {
+			return _outputQueue.writeReply(*_socketClient, reply.data(), reply.size());
+		}
+	}
+	return socket.sendData(reply.data(), reply.size(), MSG_NOSIGNAL);
+}
+
 std::string StreamClient::getSetupMethodReply(const StreamID UNUSED(streamID)) {
 	static const char* RTSP_SETUP_REPLY =
 		"RTSP/1.0 461 Unsupported Transport\r\n" \
@@ -357,7 +445,29 @@ bool StreamClient::sendHttpData(const void *buf, std::size_t len, int flags) {
 
 bool StreamClient::writeHttpData(const struct iovec *iov, int iovcnt) {
 //	base::MutexLock lock(_mutex);
-	return (_socketClient == nullptr) ? false : _socketClient->writeData(iov, iovcnt);
+	return (_socketClient == nullptr) ? false : _outputQueue.write(*_socketClient, iov, iovcnt);
+}
+
+bool StreamClient::enableHttpZeroCopy() {
+	return (_socketClient == nullptr) ? false : _socketClient->enableZeroCopy();
+}
+
+ssize_t StreamClient::sendHttpZeroCopy(const struct iovec *iov, int iovcnt) {
+	return (_socketClient == nullptr) ? -1 : _socketClient->sendZeroCopy(iov, iovcnt);
+}
+
+bool StreamClient::readHttpZeroCopyCompletion(uint32_t &lo, uint32_t &hi, bool &copied) {
+	return (_socketClient == nullptr) ? false : _socketClient->readZeroCopyCompletion(lo, hi, copied);
+}
+
+bool StreamClient::isHttpSocketOpen() const {
+	return (_socketClient == nullptr) ? false : _socketClient->getFD() != -1;
+}
+
+void StreamClient::abortHttpConnection() {
+	if (_socketClient != nullptr) {
+		_socketClient->abortConnection();
+	}
 }
 
 int StreamClient::getHttpSocketPort() const {
@@ -26,6 +26,10 @@
 #include <base/Mutex.h>
 #include <base/XMLSupport.h>
 #include <mpegts/PacketBuffer.h>
+#include <mpegts/PacketView.h>
+#include <mpegts/PidMask.h>
+#include <output/OutputQueue.h>
+#include <output/WriteCoalescer.h>
 #include <socket/SocketAttr.h>
 #include <socket/SocketClient.h>
 #include <Stream.h>
@@ -34,6 +38,7 @@
 #include <ctime>
 #include <string>
 
+FW_DECL_NS1(base, Metrics);
 FW_DECL_SP_NS1(output, StreamClient);
 
 namespace output {
@@ -88,9 +93,52 @@ class StreamClient : public base::XMLSupport {
 		///
 		void startStreaming();
 
+		/// Check if this client has been started and is receiving data
+		bool isStreaming() const {
+			return _streamActive;
+		}
+
 		///
 		bool writeData(mpegts::PacketBuffer& buffer);
 
+		/// Write only the TS packets of @p buffer that are selected by @p view
+		bool writeData(mpegts::PacketBuffer& buffer, const mpegts::PacketView& view);
+
+		/// Write @p count PacketBuffers in one go, every buffer gets its own
+		/// RTP header. @p count should not be more then MAX_WRITE_BATCH
+		bool writeData(mpegts::PacketBuffer* const* buffers, std::size_t count);
+
+		/// Set the ring sequence number of the first buffer of the next write
+		void setWriteSequence(uint64_t sequence) {
+			_writeSequence = sequence;
+		}
+
+		/// Get the ring sequence number up to which this client does not
+		/// use the written buffers anymore. Coalesced and zero-copy writes keep them
+		/// @param readSequence specifies the sequence after the last written buffer
+		virtual uint64_t getReleasedSequence(uint64_t readSequence);
+
+		/// Set the budget for coalescing the written buffers into one write,
+		/// only used by the TCP outputs
+		/// @param maxBytes specifies the byte budget, 0 will turn it off
+		/// @param maxLatencyMs specifies the longest a buffer may wait
+		void setWriteCoalescing(std::size_t maxBytes, unsigned int maxLatencyMs) {
+			_coalescer.setBudget(maxBytes, maxLatencyMs);
+		}
+
+		/// Set the high-water mark of the queue that keeps the data the
+		/// TCP Socket could not take yet
+		/// @param bytes specifies the high-water mark in bytes
+		/// @param policy specifies what to do when it is reached
+		void setOutputQueue(std::size_t bytes, OutputQueue::Policy policy) {
+			_outputQueue.setHighWaterMark(bytes, policy);
+		}
+
+		/// Write the coalesced buffers if the latency budget is used up, and
+		/// write what is waiting in the output queue
+		/// @param force specifies if true to write the coalesced buffers anyway
+		void flushData(bool force);
+
 		///
 		void writeRTCPData(const std::string& attributeDescribeString);
 
@@ -103,6 +151,12 @@ class StreamClient : public base::XMLSupport {
 		/// Set the client that is sending data
 		void setSocketClient(SocketClient &socket);
 
+		/// Send the reply to a request of @p socket. When the Stream data goes
+		/// to the same connection (RTP/TCP), the reply goes through the output
+		/// queue, so it does not land in the middle of an interleaved frame
+		/// @return false on a Socket error
+		bool sendReply(SocketClient &socket, const std::string &reply);
+
 		/// Set the session ID for this client
 		/// @param specifies the the session ID to use
 		void setSessionID(const std::string& sessionID) {
@@ -116,6 +170,21 @@ class StreamClient : public base::XMLSupport {
 			return _sessionID;
 		}
 
+		/// Get the PIDs this client requested, used when the Stream is shared
+		mpegts::PidMask &getPidMask() {
+			return _pidMask;
+		}
+
+		/// Get the PIDs this client requested, used when the Stream is shared
+		const mpegts::PidMask &getPidMask() const {
+			return _pidMask;
+		}
+
+		/// Add the statistics of this client to @p metrics, only atomic
+		/// counters are read so it never waits on the data path
+		/// @param labels specifies the labels of the Stream of this client
+		void addToMetrics(base::Metrics &metrics, const std::string &labels) const;
+
 	protected:
 
 
@@ -159,6 +228,9 @@ class StreamClient : public base::XMLSupport {
 			return false;
 		}
 
+		/// Add the output specific data to XML
+		virtual void doAddOutputToXML(std::string& UNUSED(xml)) const {}
+
 		///
 		virtual void doStartStreaming() {}
 
@@ -170,6 +242,24 @@ class StreamClient : public base::XMLSupport {
 			return false;
 		}
 
+		///
+		virtual bool doWriteData(
+				mpegts::PacketBuffer& UNUSED(buffer),
+				const mpegts::PacketView& UNUSED(view)) {
+			return false;
+		}
+
+		/// Default is writing the buffers one by one
+		virtual bool doWriteData(mpegts::PacketBuffer* const* buffers, std::size_t count) {
+			for (std::size_t i = 0; i < count; ++i) {
+				doWriteData(*buffers[i]);
+			}
+			return true;
+		}
+
+		/// Specialization for @see flushData
+		virtual void doFlushData(bool UNUSED(force)) {}
+
 		///
 		virtual void doWriteRTCPData(
 				const PacketPtr& UNUSED(sr), int UNUSED(srlen),
@@ -199,9 +289,33 @@ class StreamClient : public base::XMLSupport {
 		/// Send HTTP/RTP_TCP data to connected client
 		bool sendHttpData(const void *buf, std::size_t len, int flags);
 
-		/// Send HTTP/RTP_TCP data to connected client
+		/// Send HTTP/RTP_TCP data to connected client, without waiting. What
+		/// the Socket does not take now is queued in the output queue
 		bool writeHttpData(const struct iovec *iov, int iovcnt);
 
+		/// Check if there is HTTP/RTP_TCP data waiting in the output queue
+		bool isHttpDataQueued() const {
+			return !_outputQueue.empty();
+		}
+
+		/// Enable MSG_ZEROCOPY on the HTTP/RTP_TCP Socket
+		bool enableHttpZeroCopy();
+
+		/// Send HTTP/RTP_TCP data to connected client with MSG_ZEROCOPY
+		/// @see SocketAttr::sendZeroCopy
+		ssize_t sendHttpZeroCopy(const struct iovec *iov, int iovcnt);
+
+		/// Read one MSG_ZEROCOPY completion of the HTTP/RTP_TCP Socket
+		/// @see SocketAttr::readZeroCopyCompletion
+		bool readHttpZeroCopyCompletion(uint32_t &lo, uint32_t &hi, bool &copied);
+
+		/// Check if the HTTP/RTP_TCP Socket is still open
+		bool isHttpSocketOpen() const;
+
+		/// Abort the connection of the HTTP/RTP_TCP Socket
+		/// @see SocketAttr::abortConnection
+		void abortHttpConnection();
+
 		/// Get the HTTP/RTP_TCP port of the connected client
 		int getHttpSocketPort() const;
 
@@ -214,11 +328,15 @@ class StreamClient : public base::XMLSupport {
 		// =========================================================================
 		// -- Data members ---------------------------------------------------------
 		// =========================================================================
+	public:
+
+		static constexpr std::size_t MAX_WRITE_BATCH = 32;
+
 	protected:
 
 		base::Mutex  _mutex;
 		FeID _feID;
-		bool _streamActive;
+		std::atomic_bool _streamActive;
 		SocketClient *_socketClient;
 		SessionTimeoutCheck _sessionTimeoutCheck;
 		std::string _ipAddressOfStream;
@@ -234,6 +352,10 @@ class StreamClient : public base::XMLSupport {
 		std::atomic<uint32_t> _senderOctectPayloadCnt;
 		std::atomic<long> _timestamp;
 		std::atomic<long> _payload;
+		mpegts::PidMask _pidMask;
+		uint64_t _writeSequence;
+		WriteCoalescer _coalescer;
+		OutputQueue _outputQueue;
 
 };
 
@@ -19,12 +19,60 @@
 */
 #include <output/StreamClientOutputHttp.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
 namespace output {
 
 // =============================================================================
 // -- StreamClient -------------------------------------------------------------
 // =============================================================================
 
+uint64_t StreamClientOutputHttp::getReleasedSequence(const uint64_t readSequence) {
+	// Coalesced buffers that are not written yet are also still in use
+	const uint64_t released = StreamClient::getReleasedSequence(readSequence);
+	if (_zeroCopyPending.empty()) {
+		return released;
+	}
+	if (!_streamActive || isSelfDestructing()) {
+		// No completions will arrive anymore, so do not hold the ring
+		_zeroCopyPending.clear();
+		return released;
+	}
+	uint32_t lo;
+	uint32_t hi;
+	bool copied;
+	while (readHttpZeroCopyCompletion(lo, hi, copied)) {
+		_zeroCopyCompletions += (hi - lo) + 1;
+		_zeroCopyOutstanding -= (hi - lo) + 1;
+		if (copied) {
+			++_zeroCopyCopied;
+		}
+		for (ZeroCopySend &send : _zeroCopyPending) {
+			if (static_cast<int32_t>(send.id - lo) >= 0 && static_cast<int32_t>(hi - send.id) >= 0) {
+				send.done = true;
+			}
+		}
+	}
+	while (!_zeroCopyPending.empty() && _zeroCopyPending.front().done) {
+		_zeroCopyPending.pop_front();
+	}
+	// Everything before the oldest pending send is not used anymore
+	return _zeroCopyPending.empty() ? released : std::min(released, _zeroCopyPending.front().sequence);
+}
+
+void StreamClientOutputHttp::doAddOutputToXML(std::string &xml) const {
+	ADD_XML_ELEMENT(xml, "zeroCopy", _zeroCopy ? "yes" : "no");
+	ADD_XML_ELEMENT(xml, "zeroCopySends", _zeroCopySends.load());
+	ADD_XML_ELEMENT(xml, "zeroCopyCompletions", _zeroCopyCompletions.load());
+	ADD_XML_ELEMENT(xml, "zeroCopyCopied", _zeroCopyCopied.load());
+	ADD_XML_ELEMENT(xml, "coalescedWrites", _coalescer.getWrites());
+	ADD_XML_ELEMENT(xml, "coalescedWriteSize", _coalescer.getAverageWriteSize());
+}
+
 bool StreamClientOutputHttp::doProcessStreamingRequest(const SocketClient& client) {
 	_sessionTimeoutCheck = StreamClient::SessionTimeoutCheck::FILE_DESCRIPTOR;
 	_ipAddressOfStream = client.getIPAddressOfSocket();
@@ -37,22 +85,52 @@ void StreamClientOutputHttp::doStartStreaming() {
 	setHttpNetworkSendBufferSize(bufferSize);
 	SI_LOG_INFO("Frontend: @#1, HTTP set network buffer size: @#2 KBytes", _feID,
 		bufferSize / 1024);
-	SI_LOG_INFO("Frontend: @#1, Start HTTP stream to @#2:@#3", _feID,
-		_ipAddressOfStream, getHttpSocketPort());
+	// The completion IDs start again with every new Socket
+	_zeroCopyPending.clear();
+	_zeroCopyNextID = 0;
+	_zeroCopyOutstanding = 0;
+	_zeroCopy = _zeroCopyRequested && enableHttpZeroCopy();
+	SI_LOG_INFO("Frontend: @#1, Start HTTP@#2 stream to @#3:@#4", _feID,
+		_zeroCopy ? " (zero-copy)" : "", _ipAddressOfStream, getHttpSocketPort());
 }
 
 void StreamClientOutputHttp::doTeardown() {
+	drainZeroCopySends();
 	SI_LOG_INFO("Frontend: @#1, Stop HTTP stream to @#2:@#3", _feID,
 		_ipAddressOfStream, getHttpSocketPort());
 }
 
 bool StreamClientOutputHttp::doWriteData(mpegts::PacketBuffer& buffer) {
+	if (_coalescer.isEnabled()) {
+		coalesceData(buffer, _writeSequence);
+		return true;
+	}
+	doFlushData(true);
 	const size_t dataSize = buffer.getCurrentBufferSize();
 	iovec iovHTTP[1];
 	iovHTTP[0].iov_base = buffer.getTSReadBufferPtr();
 	iovHTTP[0].iov_len = dataSize;
 	// send the HTTP packet
-	if (!writeHttpData(iovHTTP, 1)) {
+	if (!writeStreamData(iovHTTP, 1, _writeSequence)) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending HTTP Stream Data to @#2:@#3", _feID,
+				_ipAddressOfStream, getHttpSocketPort());
+			selfDestruct();
+		}
+	}
+	return true;
+}
+
+bool StreamClientOutputHttp::doWriteData(
+		mpegts::PacketBuffer& buffer,
+		const mpegts::PacketView& view) {
+	// Keep the order, so first write what is coalesced
+	doFlushData(true);
+	// Scatter the selected TS packets straight from the buffer
+	iovec iovHTTP[mpegts::PacketView::getMaxNumberOfIovec()];
+	const std::size_t iovcnt = view.fillIovec(buffer, iovHTTP);
+	// send the HTTP packet
+	if (!writeHttpData(iovHTTP, iovcnt)) {
 		if (!isSelfDestructing()) {
 			SI_LOG_ERROR("Frontend: @#1, Error sending HTTP Stream Data to @#2:@#3", _feID,
 				_ipAddressOfStream, getHttpSocketPort());
@@ -62,4 +140,129 @@ bool StreamClientOutputHttp::doWriteData(mpegts::PacketBuffer& buffer) {
 	return true;
 }
 
+bool StreamClientOutputHttp::doWriteData(mpegts::PacketBuffer* const* buffers, const std::size_t count) {
+	if (_coalescer.isEnabled()) {
+		for (std::size_t i = 0; i < count; ++i) {
+			coalesceData(*buffers[i], _writeSequence + i);
+		}
+		return true;
+	}
+	if (!_zeroCopy) {
+		for (std::size_t i = 0; i < count; ++i) {
+			doWriteData(*buffers[i]);
+		}
+		return true;
+	}
+	// Pin all the buffers with one zero-copy send
+	std::array<iovec, MAX_WRITE_BATCH> iovHTTP;
+	const std::size_t cnt = (count < MAX_WRITE_BATCH) ? count : MAX_WRITE_BATCH;
+	for (std::size_t i = 0; i < cnt; ++i) {
+		iovHTTP[i].iov_base = buffers[i]->getTSReadBufferPtr();
+		iovHTTP[i].iov_len = buffers[i]->getCurrentBufferSize();
+	}
+	doFlushData(true);
+	if (!writeStreamData(iovHTTP.data(), cnt, _writeSequence)) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending HTTP Stream Data to @#2:@#3", _feID,
+				_ipAddressOfStream, getHttpSocketPort());
+			selfDestruct();
+		}
+	}
+	return true;
+}
+
+void StreamClientOutputHttp::doFlushData(const bool force) {
+	if (!_coalescer.empty() && (force || _coalescer.isExpired())) {
+		writeCoalescedData();
+	}
+}
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void StreamClientOutputHttp::coalesceData(mpegts::PacketBuffer& buffer, const uint64_t sequence) {
+	_coalescer.add(buffer, sequence, false);
+	if (_coalescer.isFull()) {
+		writeCoalescedData();
+	}
+}
+
+void StreamClientOutputHttp::writeCoalescedData() {
+	if (!writeStreamData(_coalescer.getIovec(), _coalescer.getIovecCount(),
+			_coalescer.getFirstSequence())) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending HTTP Stream Data to @#2:@#3", _feID,
+				_ipAddressOfStream, getHttpSocketPort());
+			selfDestruct();
+		}
+	}
+	_coalescer.written();
+}
+
+bool StreamClientOutputHttp::writeStreamData(iovec *iov, const int iovcnt, const uint64_t sequence) {
+	// Queued data should go first, and it is copied anyway
+	if (!_zeroCopy || isHttpDataQueued()) {
+		return writeHttpData(iov, iovcnt);
+	}
+	std::size_t total = 0;
+	for (int i = 0; i < iovcnt; ++i) {
+		total += iov[i].iov_len;
+	}
+	const ssize_t sent = sendHttpZeroCopy(iov, iovcnt);
+	if (sent == -1) {
+		// Like EAGAIN when the Socket is full or ENOBUFS when there is to
+		// much memory pinned, then copy (queue) instead
+		return writeHttpData(iov, iovcnt);
+	}
+	// The buffers stay pinned until the completion of this send is read
+	_zeroCopyPending.push_back({_zeroCopyNextID, sequence, false});
+	++_zeroCopyNextID;
+	++_zeroCopyOutstanding;
+	++_zeroCopySends;
+	if (static_cast<std::size_t>(sent) == total) {
+		return true;
+	}
+	// Send (queue) the remaining part the normal way
+	std::size_t skip = sent;
+	int i = 0;
+	while (skip >= iov[i].iov_len) {
+		skip -= iov[i].iov_len;
+		++i;
+	}
+	iov[i].iov_base = static_cast<unsigned char *>(iov[i].iov_base) + skip;
+	iov[i].iov_len -= skip;
+	return writeHttpData(&iov[i], iovcnt - i);
+}
+
+void StreamClientOutputHttp::drainZeroCopySends() {
+	// No new zero-copy sends from here on
+	if (!_zeroCopy.exchange(false)) {
+		return;
+	}
+	uint32_t lo;
+	uint32_t hi;
+	bool copied;
+	for (int retry = 0; _zeroCopyOutstanding > 0; ++retry) {
+		while (readHttpZeroCopyCompletion(lo, hi, copied)) {
+			_zeroCopyCompletions += (hi - lo) + 1;
+			_zeroCopyOutstanding -= (hi - lo) + 1;
+		}
+		if (_zeroCopyOutstanding == 0 || !isHttpSocketOpen()) {
+			// Done, or a closed Socket that does not report completions anymore
+			break;
+		} else if (retry == 100) {
+			// Client does not read anymore, so drop what is still queued
+			SI_LOG_ERROR("Frontend: @#1, Abort HTTP stream to @#2, @#3 zero-copy sends still pending",
+				_feID, _ipAddressOfStream, _zeroCopyOutstanding.load());
+			abortHttpConnection();
+		} else if (retry == 200) {
+			SI_LOG_ERROR("Frontend: @#1, HTTP stream to @#2, @#3 zero-copy sends did not complete",
+				_feID, _ipAddressOfStream, _zeroCopyOutstanding.load());
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
 }
@@ -24,6 +24,10 @@
 #include <FwDecl.h>
 #include <output/StreamClient.h>
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
+
 FW_DECL_SP_NS1(output, StreamClientOutputHttp);
 
 namespace output {
@@ -37,7 +41,15 @@ class StreamClientOutputHttp : public output::StreamClient {
 		// =========================================================================
 	public:
 
-		StreamClientOutputHttp(FeID feID) : StreamClient(feID) {};
+		StreamClientOutputHttp(FeID feID, bool zeroCopy = false) :
+			StreamClient(feID),
+			_zeroCopyRequested(zeroCopy),
+			_zeroCopy(false),
+			_zeroCopyNextID(0),
+			_zeroCopyOutstanding(0),
+			_zeroCopySends(0),
+			_zeroCopyCompletions(0),
+			_zeroCopyCopied(0) {}
 
 		virtual ~StreamClientOutputHttp() = default;
 
@@ -55,8 +67,16 @@ class StreamClientOutputHttp : public output::StreamClient {
 		// =========================================================================
 		// -- StreamClient ---------------------------------------------------------
 		// =========================================================================
+	public:
+
+		/// @see StreamClient
+		virtual uint64_t getReleasedSequence(uint64_t readSequence) final;
+
 	private:
 
+		/// Specialization for @see addToXML
+		virtual void doAddOutputToXML(std::string& xml) const final;
+
 		/// Specialization for @see processStreamingRequest
 		virtual bool doProcessStreamingRequest(const SocketClient& client) final;
 
@@ -69,11 +89,57 @@ class StreamClientOutputHttp : public output::StreamClient {
 		/// Specialization for @see writeData
 		virtual bool doWriteData(mpegts::PacketBuffer& buffer) final;
 
+		/// Specialization for @see writeData
+		virtual bool doWriteData(
+				mpegts::PacketBuffer& buffer,
+				const mpegts::PacketView& view) final;
+
+		/// Specialization for @see writeData
+		virtual bool doWriteData(mpegts::PacketBuffer* const* buffers, std::size_t count) final;
+
+		/// Specialization for @see flushData
+		virtual void doFlushData(bool force) final;
+
+		// =========================================================================
+		//  -- Other member functions ----------------------------------------------
+		// =========================================================================
+	private:
+
+		/// Send the data with MSG_ZEROCOPY when enabled, or else copy it
+		/// @param sequence specifies the ring sequence number of the first buffer
+		bool writeStreamData(iovec *iov, int iovcnt, uint64_t sequence);
+
+		/// Wait (bounded) until the kernel is done with all zero-copy sends, so
+		/// the ring buffers can be released. If it takes to long the connection
+		/// is aborted, which drops the data that is still queued in the Socket
+		void drainZeroCopySends();
+
+		/// Add @p buffer to the coalesced write and write it when it is full
+		void coalesceData(mpegts::PacketBuffer& buffer, uint64_t sequence);
+
+		/// Write the coalesced buffers in one go
+		void writeCoalescedData();
+
 		// =========================================================================
 		// -- Data members ---------------------------------------------------------
 		// =========================================================================
 	private:
 
+		/// A zero-copy send that is waiting for its completion
+		struct ZeroCopySend {
+			uint32_t id;
+			uint64_t sequence;
+			bool done;
+		};
+
+		bool _zeroCopyRequested;
+		std::atomic_bool _zeroCopy;
+		std::deque<ZeroCopySend> _zeroCopyPending;
+		uint32_t _zeroCopyNextID;
+		std::atomic<uint32_t> _zeroCopyOutstanding;
+		std::atomic<unsigned long> _zeroCopySends;
+		std::atomic<unsigned long> _zeroCopyCompletions;
+		std::atomic<unsigned long> _zeroCopyCopied;
 };
 
 }
@@ -19,6 +19,8 @@
 */
 #include <output/StreamClientOutputRtp.h>
 
+#include <cerrno>
+
 extern const char* const satpi_version;
 
 namespace output {
@@ -133,8 +135,12 @@ void StreamClientOutputRtp::doStartStreaming() {
 	_rtp.setNetworkSendBufferSize(bufferSize);
 	SI_LOG_INFO("Frontend: @#1, RTP/UDP set network buffer size: @#2 KBytes", _feID,
 		bufferSize / 1024);
-	SI_LOG_INFO("Frontend: @#1, Start RTP/UDP stream to @#2:@#3", _feID,
-		_rtp.getIPAddressOfSocket(), _rtp.getSocketPort());
+	_udpGSO = _udpGSORequested && _rtp.isSegmentationOffloadSupported();
+	if (_udpGSORequested && !_udpGSO) {
+		SI_LOG_INFO("Frontend: @#1, RTP/UDP GSO not supported, using sendmmsg", _feID);
+	}
+	SI_LOG_INFO("Frontend: @#1, Start RTP/UDP@#2 stream to @#3:@#4", _feID,
+		_udpGSO ? " (GSO)" : "", _rtp.getIPAddressOfSocket(), _rtp.getSocketPort());
 	SI_LOG_INFO("Frontend: @#1, Start RTCP/UDP stream to @#2:@#3", _feID,
 		_rtcp.getIPAddressOfSocket(), _rtcp.getSocketPort());
 }
@@ -160,6 +166,56 @@ bool StreamClientOutputRtp::doWriteData(mpegts::PacketBuffer& buffer) {
 	return true;
 }
 
+bool StreamClientOutputRtp::doWriteData(
+		mpegts::PacketBuffer& buffer,
+		const mpegts::PacketView& view) {
+	// Repack the RTP header and the selected TS packets into one datagram
+	constexpr std::size_t rtpHeaderLen = mpegts::PacketBuffer::RTP_HEADER_LEN;
+	std::memcpy(_repack.data(), buffer.getReadBufferPtr(), rtpHeaderLen);
+	const size_t lenRTP = view.copyTo(buffer, _repack.data() + rtpHeaderLen) + rtpHeaderLen;
+	if (!_rtp.sendDataTo(_repack.data(), lenRTP, MSG_DONTWAIT)) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending RTP/UDP data to @#2:@#3", _feID,
+				_rtp.getIPAddressOfSocket(), _rtp.getSocketPort());
+			selfDestruct();
+		}
+	}
+	return true;
+}
+
+bool StreamClientOutputRtp::doWriteData(mpegts::PacketBuffer* const* buffers, const std::size_t count) {
+	// One datagram per buffer, but send them all with sendmmsg
+	std::array<iovec, MAX_WRITE_BATCH> iov;
+	const std::size_t cnt = (count < MAX_WRITE_BATCH) ? count : MAX_WRITE_BATCH;
+	bool sameSize = true;
+	for (std::size_t i = 0; i < cnt; ++i) {
+		iov[i].iov_base = buffers[i]->getReadBufferPtr();
+		iov[i].iov_len = buffers[i]->getCurrentBufferSize() + mpegts::PacketBuffer::RTP_HEADER_LEN;
+		sameSize &= (i + 1 == cnt) ? iov[i].iov_len <= iov[0].iov_len : iov[i].iov_len == iov[0].iov_len;
+	}
+	// With UDP GSO the kernel sees the buffers as one, and cuts it into
+	// datagrams of the first buffer size, so only the last may be shorter
+	bool sent;
+	if (_udpGSO && sameSize) {
+		sent = _rtp.sendSegmentedDataTo(iov.data(), cnt, iov[0].iov_len, MSG_DONTWAIT);
+		if (!sent && errno != EAGAIN && errno != EWOULDBLOCK) {
+			SI_LOG_INFO("Frontend: @#1, RTP/UDP GSO failed, fallback to sendmmsg", _feID);
+			_udpGSO = false;
+			sent = _rtp.sendMultipleDataTo(iov.data(), cnt, MSG_DONTWAIT);
+		}
+	} else {
+		sent = _rtp.sendMultipleDataTo(iov.data(), cnt, MSG_DONTWAIT);
+	}
+	if (!sent) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending RTP/UDP data to @#2:@#3", _feID,
+				_rtp.getIPAddressOfSocket(), _rtp.getSocketPort());
+			selfDestruct();
+		}
+	}
+	return true;
+}
+
 void StreamClientOutputRtp::doWriteRTCPData(
 		const PacketPtr& sr, const int srlen,
 		const PacketPtr& sdes, const int sdeslen,
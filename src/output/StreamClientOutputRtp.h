@@ -24,6 +24,8 @@
 #include <FwDecl.h>
 #include <output/StreamClient.h>
 
+#include <array>
+
 FW_DECL_SP_NS1(output, StreamClientOutputRtp);
 
 namespace output {
@@ -37,7 +39,11 @@ class StreamClientOutputRtp : public output::StreamClient {
 		// =========================================================================
 	public:
 
-		StreamClientOutputRtp(FeID feID, bool multicast) : StreamClient(feID), _multicast(multicast) {}
+		StreamClientOutputRtp(FeID feID, bool multicast, bool udpGSO = false) :
+			StreamClient(feID),
+			_multicast(multicast),
+			_udpGSORequested(udpGSO),
+			_udpGSO(false) {}
 
 		virtual ~StreamClientOutputRtp() = default;
 
@@ -79,6 +85,14 @@ class StreamClientOutputRtp : public output::StreamClient {
 		/// Specialization for @see writeData
 		virtual bool doWriteData(mpegts::PacketBuffer& buffer) final;
 
+		/// Specialization for @see writeData
+		virtual bool doWriteData(
+				mpegts::PacketBuffer& buffer,
+				const mpegts::PacketView& view) final;
+
+		/// Specialization for @see writeData
+		virtual bool doWriteData(mpegts::PacketBuffer* const* buffers, std::size_t count) final;
+
 		/// Specialization for @see writeRTCPData
 		virtual void doWriteRTCPData(
 				const PacketPtr& sr, int srlen,
@@ -91,6 +105,9 @@ class StreamClientOutputRtp : public output::StreamClient {
 	private:
 
 		bool _multicast;
+		bool _udpGSORequested;
+		bool _udpGSO;
+		std::array<unsigned char, mpegts::PacketBuffer::MTU> _repack;
 
 };
 
@@ -45,6 +45,11 @@ std::string StreamClientOutputRtpTcp::getSetupMethodReply(const StreamID streamI
 		streamID.getID());
 }
 
+void StreamClientOutputRtpTcp::doAddOutputToXML(std::string &xml) const {
+	ADD_XML_ELEMENT(xml, "coalescedWrites", _coalescer.getWrites());
+	ADD_XML_ELEMENT(xml, "coalescedWriteSize", _coalescer.getAverageWriteSize());
+}
+
 bool StreamClientOutputRtpTcp::doProcessStreamingRequest(const SocketClient& client) {
 	// Split message into Headers
 	HeaderVector headers = client.getHeaders();
@@ -78,6 +83,11 @@ void StreamClientOutputRtpTcp::doTeardown() {
 }
 
 bool StreamClientOutputRtpTcp::doWriteData(mpegts::PacketBuffer& buffer) {
+	if (_coalescer.isEnabled()) {
+		coalesceData(buffer, _writeSequence);
+		return true;
+	}
+	doFlushData(true);
 	const size_t dataSize = buffer.getCurrentBufferSize();
 	const size_t lenRTP = dataSize + mpegts::PacketBuffer::RTP_HEADER_LEN;
 
@@ -104,6 +114,57 @@ bool StreamClientOutputRtpTcp::doWriteData(mpegts::PacketBuffer& buffer) {
 	return true;
 }
 
+bool StreamClientOutputRtpTcp::doWriteData(
+		mpegts::PacketBuffer& buffer,
+		const mpegts::PacketView& view) {
+	// Keep the order, so first write what is coalesced
+	doFlushData(true);
+	const size_t lenRTP = view.getTSSize() + mpegts::PacketBuffer::RTP_HEADER_LEN;
+
+	unsigned char header[4];
+	header[0] = 0x24;
+	header[1] = 0x00;
+	header[2] = (lenRTP >> 8) & 0xFF;
+	header[3] = (lenRTP >> 0) & 0xFF;
+
+	// Interleaved header, RTP header and then the selected TS packets
+	iovec iov[2 + mpegts::PacketView::getMaxNumberOfIovec()];
+	iov[0].iov_base = header;
+	iov[0].iov_len = 4;
+	iov[1].iov_base = buffer.getReadBufferPtr();
+	iov[1].iov_len = mpegts::PacketBuffer::RTP_HEADER_LEN;
+	const std::size_t iovcnt = 2 + view.fillIovec(buffer, &iov[2]);
+
+	// send the RTP/TCP packet
+	if (!writeHttpData(iov, iovcnt)) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending RTP/TCP Stream Data to @#2:@#3", _feID,
+				_ipAddressOfStream, getHttpSocketPort());
+			selfDestruct();
+		}
+	}
+	return true;
+}
+
+bool StreamClientOutputRtpTcp::doWriteData(mpegts::PacketBuffer* const* buffers, const std::size_t count) {
+	if (_coalescer.isEnabled()) {
+		for (std::size_t i = 0; i < count; ++i) {
+			coalesceData(*buffers[i], _writeSequence + i);
+		}
+		return true;
+	}
+	for (std::size_t i = 0; i < count; ++i) {
+		doWriteData(*buffers[i]);
+	}
+	return true;
+}
+
+void StreamClientOutputRtpTcp::doFlushData(const bool force) {
+	if (!_coalescer.empty() && (force || _coalescer.isExpired())) {
+		writeCoalescedData();
+	}
+}
+
 void StreamClientOutputRtpTcp::doWriteRTCPData(
 		const PacketPtr& sr, const int srlen,
 		const PacketPtr& sdes, const int sdeslen,
@@ -133,5 +194,27 @@ void StreamClientOutputRtpTcp::doWriteRTCPData(
 	}
 }
 
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void StreamClientOutputRtpTcp::coalesceData(mpegts::PacketBuffer& buffer, const uint64_t sequence) {
+	// Every buffer keeps its own interleaved and RTP header
+	_coalescer.add(buffer, sequence, true);
+	if (_coalescer.isFull()) {
+		writeCoalescedData();
+	}
 }
 
+void StreamClientOutputRtpTcp::writeCoalescedData() {
+	if (!writeHttpData(_coalescer.getIovec(), _coalescer.getIovecCount())) {
+		if (!isSelfDestructing()) {
+			SI_LOG_ERROR("Frontend: @#1, Error sending RTP/TCP Stream Data to @#2:@#3", _feID,
+				_ipAddressOfStream, getHttpSocketPort());
+			selfDestruct();
+		}
+	}
+	_coalescer.written();
+}
+
+}
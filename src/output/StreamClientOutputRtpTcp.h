@@ -61,6 +61,9 @@ class StreamClientOutputRtpTcp : public output::StreamClient {
 
 	private:
 
+		/// Specialization for @see addToXML
+		virtual void doAddOutputToXML(std::string& xml) const final;
+
 		/// Specialization for @see processStreamingRequest
 		virtual bool doProcessStreamingRequest(const SocketClient& client) final;
 
@@ -73,12 +76,34 @@ class StreamClientOutputRtpTcp : public output::StreamClient {
 		/// Specialization for @see writeData
 		virtual bool doWriteData(mpegts::PacketBuffer& buffer) final;
 
+		/// Specialization for @see writeData
+		virtual bool doWriteData(
+				mpegts::PacketBuffer& buffer,
+				const mpegts::PacketView& view) final;
+
+		/// Specialization for @see writeData
+		virtual bool doWriteData(mpegts::PacketBuffer* const* buffers, std::size_t count) final;
+
+		/// Specialization for @see flushData
+		virtual void doFlushData(bool force) final;
+
 		/// Specialization for @see writeRTCPData
 		virtual void doWriteRTCPData(
 				const PacketPtr& sr, int srlen,
 				const PacketPtr& sdes, int sdeslen,
 				const PacketPtr& app, int applen);
 
+		// =========================================================================
+		//  -- Other member functions ----------------------------------------------
+		// =========================================================================
+	private:
+
+		/// Add @p buffer to the coalesced write and write it when it is full
+		void coalesceData(mpegts::PacketBuffer& buffer, uint64_t sequence);
+
+		/// Write the coalesced buffers in one go
+		void writeCoalescedData();
+
 		// =========================================================================
 		// -- Data members ---------------------------------------------------------
 		// =========================================================================
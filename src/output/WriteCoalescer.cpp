@@ -0,0 +1,66 @@
+/* WriteCoalescer.cpp
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#include <output/WriteCoalescer.h>
+
+#include <cstring>
+
+namespace output {
+
+// =============================================================================
+//  -- Other member functions --------------------------------------------------
+// =============================================================================
+
+void WriteCoalescer::add(mpegts::PacketBuffer &buffer, const uint64_t sequence,
+		const bool interleaved) noexcept {
+	checkReset();
+	if (_count == 0) {
+		_first = std::chrono::steady_clock::now();
+		_firstSequence = sequence;
+	}
+	const std::size_t dataSize = buffer.getCurrentBufferSize();
+	if (interleaved) {
+		const std::size_t lenRTP = dataSize + mpegts::PacketBuffer::RTP_HEADER_LEN;
+		unsigned char *header = _header[_count].data();
+		header[0] = 0x24;
+		header[1] = 0x00;
+		header[2] = (lenRTP >> 8) & 0xFF;
+		header[3] = (lenRTP >> 0) & 0xFF;
+		std::memcpy(header + 4, buffer.getReadBufferPtr(), mpegts::PacketBuffer::RTP_HEADER_LEN);
+		_iov[_iovcnt].iov_base = header;
+		_iov[_iovcnt].iov_len = HEADER_LEN;
+		_bytes += HEADER_LEN;
+		++_iovcnt;
+	}
+	_iov[_iovcnt].iov_base = buffer.getTSReadBufferPtr();
+	_iov[_iovcnt].iov_len = dataSize;
+	_bytes += dataSize;
+	++_iovcnt;
+	++_count;
+}
+
+void WriteCoalescer::written() noexcept {
+	_writes.fetch_add(1, std::memory_order_relaxed);
+	_writtenBytes.fetch_add(_bytes, std::memory_order_relaxed);
+	_count = 0;
+	_iovcnt = 0;
+	_bytes = 0;
+}
+
+}
@@ -0,0 +1,167 @@
+/* WriteCoalescer.h
+
+   Copyright (C) 2014 - 2023 Marc Postema (mpostema09 -at- gmail.com)
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+   Or, point your browser to http://www.gnu.org/copyleft/gpl.html
+*/
+#ifndef OUTPUT_WRITE_COALESCER_H_INCLUDE
+#define OUTPUT_WRITE_COALESCER_H_INCLUDE OUTPUT_WRITE_COALESCER_H_INCLUDE
+
+#include <mpegts/PacketBuffer.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/uio.h>
+
+namespace output {
+
+/// The class @c WriteCoalescer gathers the ring buffers of a TCP StreamClient
+/// (HTTP or RTP/TCP) into one writev, until the byte or latency budget is
+/// reached. The buffers are not copied, so they stay pinned in the ring until
+/// they are written. Only use it from the Stream writer thread, except for
+/// @see reset and the statistics.
+class WriteCoalescer {
+		// =====================================================================
+		// -- Constructors and destructor --------------------------------------
+		// =====================================================================
+	public:
+
+		WriteCoalescer() = default;
+
+		virtual ~WriteCoalescer() = default;
+
+		WriteCoalescer(const WriteCoalescer&) = delete;
+
+		WriteCoalescer& operator=(const WriteCoalescer&) = delete;
+
+		// =====================================================================
+		// -- Other member functions -------------------------------------------
+		// =====================================================================
+	public:
+
+		/// Set the budget, @p maxBytes of 0 turns coalescing off
+		void setBudget(std::size_t maxBytes, unsigned int maxLatencyMs) noexcept {
+			_maxBytes = maxBytes;
+			_maxLatency = std::chrono::milliseconds(maxLatencyMs);
+		}
+
+		/// Check if coalescing is turned on
+		bool isEnabled() const noexcept {
+			return _maxBytes > 0;
+		}
+
+		/// Drop all gathered buffers, can be called from any thread. It is
+		/// done by the writer thread on the next use
+		void reset() noexcept {
+			_resetRequested.store(true, std::memory_order_release);
+		}
+
+		/// Add the TS payload of @p buffer, with an RTP/TCP interleaved and RTP
+		/// header in front of it when @p interleaved is true. The RTP header
+		/// is copied, because a shared buffer is tagged again by other clients
+		/// @param sequence specifies the ring sequence number of @p buffer
+		void add(mpegts::PacketBuffer &buffer, uint64_t sequence, bool interleaved) noexcept;
+
+		/// Check if nothing is gathered
+		bool empty() noexcept {
+			checkReset();
+			return _count == 0;
+		}
+
+		/// Check if the byte budget is used up
+		bool isFull() const noexcept {
+			return _bytes >= _maxBytes || _count == MAX_BUFFERS;
+		}
+
+		/// Check if the oldest gathered buffer waited longer then the latency budget
+		bool isExpired() const noexcept {
+			return _count > 0 && (std::chrono::steady_clock::now() - _first) >= _maxLatency;
+		}
+
+		/// Get the ring sequence number of the oldest gathered buffer
+		uint64_t getFirstSequence() const noexcept {
+			return _firstSequence;
+		}
+
+		/// Get the gathered iovec, it may be changed by the caller
+		iovec *getIovec() noexcept {
+			return _iov.data();
+		}
+
+		/// Get the amount of gathered iovec
+		int getIovecCount() const noexcept {
+			return static_cast<int>(_iovcnt);
+		}
+
+		/// Mark the gathered buffers as written and start over
+		void written() noexcept;
+
+		/// Get the amount of coalesced writes
+		unsigned long getWrites() const noexcept {
+			return _writes.load(std::memory_order_relaxed);
+		}
+
+		/// Get the average amount of bytes per coalesced write
+		unsigned long getAverageWriteSize() const noexcept {
+			const unsigned long writes = getWrites();
+			return (writes == 0) ? 0 : _writtenBytes.load(std::memory_order_relaxed) / writes;
+		}
+
+	private:
+
+		/// Drop the gathered buffers when a reset was requested
+		void checkReset() noexcept {
+			if (_resetRequested.load(std::memory_order_relaxed) &&
+					_resetRequested.exchange(false, std::memory_order_acquire)) {
+				_count = 0;
+				_iovcnt = 0;
+				_bytes = 0;
+			}
+		}
+
+		// =====================================================================
+		//  -- Data members ----------------------------------------------------
+		// =====================================================================
+	public:
+
+		/// The most buffers that can be gathered, each needs up to 2 iovec
+		static constexpr std::size_t MAX_BUFFERS = 64;
+
+	private:
+
+		static constexpr std::size_t HEADER_LEN = 4 + mpegts::PacketBuffer::RTP_HEADER_LEN;
+
+		std::array<iovec, MAX_BUFFERS * 2> _iov;
+		std::array<std::array<unsigned char, HEADER_LEN>, MAX_BUFFERS> _header;
+		std::size_t _count = 0;
+		std::size_t _iovcnt = 0;
+		std::size_t _bytes = 0;
+		std::size_t _maxBytes = 0;
+		std::chrono::milliseconds _maxLatency{0};
+		std::chrono::steady_clock::time_point _first;
+		uint64_t _firstSequence = 0;
+		std::atomic_bool _resetRequested{false};
+		std::atomic<unsigned long> _writes{0};
+		std::atomic<unsigned long> _writtenBytes{0};
+};
+
+}
+
+#endif // OUTPUT_WRITE_COALESCER_H_INCLUDE
@@ -23,23 +23,46 @@
 #include <StringConverter.h>
 #include <socket/SocketClient.h>
 
+#include <array>
 #include <chrono>
 #include <cstring>
 #include <string>
 #include <thread>
 
 #include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <netinet/udp.h>
 #include <sys/uio.h>
 #include <sys/socket.h>
 #include <sys/select.h>
 
+#ifndef SOL_UDP
+	#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+	#define UDP_SEGMENT 103
+#endif
+#ifndef SO_ZEROCOPY
+	#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+	#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+	#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+	#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
 	// ===================================================================
 	//  -- Constructors and destructor -----------------------------------
 	// ===================================================================
 	SocketAttr::SocketAttr() :
 		_fd(-1),
 		_ipAddr("0.0.0.0"),
-		_ttl(0) {
+		_ttl(0),
+		_sendCalls(0) {
 		std::memset(&_addr, 0, sizeof(_addr));
 	}
 
@@ -52,6 +75,11 @@
 	// ===================================================================
 
 	void SocketAttr::closeFD() {
+		{
+			// The completion IDs start again with every new Socket
+			base::MutexLock lock(_mutex);
+			_zeroCopyCompletions.clear();
+		}
 		CLOSE_FD(_fd);
 		_ipAddr = "0.0.0.0";
 		_addr.sin_port = 0;
@@ -166,6 +194,7 @@
 
 	bool SocketAttr::sendData(const void *buf, std::size_t len, int flags) {
 		base::MutexLock lock(_mutex);
+		_sendCalls.fetch_add(1, std::memory_order_relaxed);
 		if (::send(_fd, buf, len, flags) == -1) {
 			SI_LOG_PERROR("send");
 			return false;
@@ -179,18 +208,21 @@
 		}
 		{
 			base::MutexLock lock(_mutex);
+			_sendCalls.fetch_add(1, std::memory_order_relaxed);
 			if (::writev(_fd, iov, iovcnt) != -1) {
 				return true;
 			}
 		}
 		if (errno != EBADF) {
+			// Wait until there is room to write again
 			timeval tv{};
 			fd_set fds{};
 			tv.tv_sec = 5;
 			FD_ZERO(&fds);
 			FD_SET(_fd, &fds);
-			if (select(1, &fds, nullptr, nullptr, &tv) != -1) {
+			if (select(_fd + 1, nullptr, &fds, nullptr, &tv) > 0) {
 				base::MutexLock lock(_mutex);
+				_sendCalls.fetch_add(1, std::memory_order_relaxed);
 				if (::writev(_fd, iov, iovcnt) != -1) {
 					return true;
 				}
@@ -200,7 +232,21 @@
 		return false;
 	}
 
+	ssize_t SocketAttr::writeDataNonBlocking(const iovec *iov, const int iovcnt) {
+		if (_fd == -1) {
+			errno = EBADF;
+			return -1;
+		}
+		msghdr msg{};
+		msg.msg_iov = const_cast<iovec *>(iov);
+		msg.msg_iovlen = iovcnt;
+		base::MutexLock lock(_mutex);
+		_sendCalls.fetch_add(1, std::memory_order_relaxed);
+		return ::sendmsg(_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+	}
+
 	bool SocketAttr::sendDataTo(const void *buf, std::size_t len, int flags) {
+		_sendCalls.fetch_add(1, std::memory_order_relaxed);
 		if (::sendto(_fd, buf, len, flags, reinterpret_cast<sockaddr *>(&_addr),
 				   sizeof(_addr)) == -1) {
 			SI_LOG_PERROR("sendto (fd: @#1)", _fd);
@@ -209,6 +255,155 @@
 		return true;
 	}
 
+	bool SocketAttr::sendMultipleDataTo(const iovec *iov, const std::size_t count, const int flags) {
+		static constexpr std::size_t MAX_MMSG_BATCH = 32;
+		std::array<mmsghdr, MAX_MMSG_BATCH> msgs;
+		std::size_t sent = 0;
+		while (sent < count) {
+			const std::size_t left = count - sent;
+			const std::size_t n = (left < MAX_MMSG_BATCH) ? left : MAX_MMSG_BATCH;
+			for (std::size_t i = 0; i < n; ++i) {
+				std::memset(&msgs[i], 0, sizeof(mmsghdr));
+				msgs[i].msg_hdr.msg_name = &_addr;
+				msgs[i].msg_hdr.msg_namelen = sizeof(_addr);
+				msgs[i].msg_hdr.msg_iov = const_cast<iovec *>(&iov[sent + i]);
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
+			// sendmmsg may send less datagrams then requested, so continue
+			// with the remaining ones
+			_sendCalls.fetch_add(1, std::memory_order_relaxed);
+			const int ret = ::sendmmsg(_fd, msgs.data(), n, flags);
+			if (ret == -1) {
+				SI_LOG_PERROR("sendmmsg (fd: @#1)", _fd);
+				return false;
+			}
+			sent += ret;
+		}
+		return true;
+	}
+
+	bool SocketAttr::sendSegmentedDataTo(const iovec *iov, const std::size_t count,
+			const uint16_t segmentSize, const int flags) {
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+		msghdr msg{};
+		msg.msg_name = &_addr;
+		msg.msg_namelen = sizeof(_addr);
+		msg.msg_iov = const_cast<iovec *>(iov);
+		msg.msg_iovlen = count;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_UDP;
+		cmsg->cmsg_type = UDP_SEGMENT;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+		std::memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof(segmentSize));
+		_sendCalls.fetch_add(1, std::memory_order_relaxed);
+		if (::sendmsg(_fd, &msg, flags) == -1) {
+			const int err = errno;
+			SI_LOG_PERROR("sendmsg UDP_SEGMENT (fd: @#1)", _fd);
+			errno = err;
+			return false;
+		}
+		return true;
+	}
+
+	bool SocketAttr::isSegmentationOffloadSupported() const {
+		// Kernels without UDP GSO do not know this socket option
+		int size = 0;
+		socklen_t len = sizeof(size);
+		return ::getsockopt(_fd, SOL_UDP, UDP_SEGMENT, &size, &len) == 0;
+	}
+
+	bool SocketAttr::enableZeroCopy() {
+		const int one = 1;
+		if (::setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == -1) {
+			SI_LOG_PERROR("setsockopt SO_ZEROCOPY (fd: @#1)", _fd);
+			return false;
+		}
+		return true;
+	}
+
+	ssize_t SocketAttr::sendZeroCopy(const iovec *iov, const int iovcnt) {
+		if (_fd == -1) {
+			errno = EBADF;
+			return -1;
+		}
+		msghdr msg{};
+		msg.msg_iov = const_cast<iovec *>(iov);
+		msg.msg_iovlen = iovcnt;
+		base::MutexLock lock(_mutex);
+		_sendCalls.fetch_add(1, std::memory_order_relaxed);
+		return ::sendmsg(_fd, &msg, MSG_ZEROCOPY | MSG_DONTWAIT | MSG_NOSIGNAL);
+	}
+
+	bool SocketAttr::readZeroCopyCompletion(uint32_t &lo, uint32_t &hi, bool &copied) {
+		{
+			base::MutexLock lock(_mutex);
+			if (!_zeroCopyCompletions.empty()) {
+				const ZeroCopyCompletion &completion = _zeroCopyCompletions.back();
+				lo = completion.lo;
+				hi = completion.hi;
+				copied = completion.copied;
+				_zeroCopyCompletions.pop_back();
+				return true;
+			}
+		}
+		return receiveZeroCopyCompletion(lo, hi, copied);
+	}
+
+	void SocketAttr::takeZeroCopyCompletions() {
+		uint32_t lo;
+		uint32_t hi;
+		bool copied;
+		base::MutexLock lock(_mutex);
+		while (receiveZeroCopyCompletion(lo, hi, copied)) {
+			_zeroCopyCompletions.push_back({lo, hi, copied});
+		}
+	}
+
+	void SocketAttr::abortConnection() {
+		if (_fd == -1) {
+			return;
+		}
+		// Connecting to AF_UNSPEC disconnects and purges the send queue
+		sockaddr addr{};
+		addr.sa_family = AF_UNSPEC;
+		if (::connect(_fd, &addr, sizeof(addr)) == -1) {
+			SI_LOG_PERROR("connect AF_UNSPEC (fd: @#1)", _fd);
+		}
+	}
+
+	bool SocketAttr::receiveZeroCopyCompletion(uint32_t &lo, uint32_t &hi, bool &copied) {
+		if (_fd == -1) {
+			return false;
+		}
+		alignas(cmsghdr) char control[128];
+		msghdr msg{};
+		// Other errors in the queue are skipped, so it can get empty
+		for (;;) {
+			msg.msg_control = control;
+			msg.msg_controllen = sizeof(control);
+			if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+				return false;
+			}
+			for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+				if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+					  (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) {
+					continue;
+				}
+				sock_extended_err serr;
+				std::memcpy(&serr, CMSG_DATA(cmsg), sizeof(serr));
+				if (serr.ee_errno != 0 || serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+					continue;
+				}
+				lo = serr.ee_info;
+				hi = serr.ee_data;
+				copied = (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+				return true;
+			}
+		}
+	}
+
 	ssize_t SocketAttr::recvDatafrom(void *buf, std::size_t len, int flags) {
 		struct sockaddr_in si_other;
 		socklen_t addrlen = sizeof(si_other);
@@ -23,8 +23,11 @@
 #include <FwDecl.h>
 #include <base/Mutex.h>
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <netinet/in.h>
 
@@ -77,6 +80,10 @@ class SocketAttr {
 		///
 		bool writeData(const struct iovec* iov, int iovcnt);
 
+		/// Write @p iov without waiting when the Socket is full
+		/// @return the amount of bytes written or -1 on error (errno is kept)
+		ssize_t writeDataNonBlocking(const struct iovec* iov, int iovcnt);
+
 		/// Use this function when the socket is in connected state
 		bool sendData(const void* buf, std::size_t len, int flags);
 
@@ -84,6 +91,43 @@ class SocketAttr {
 		/// connection-mode (SOCK_STREAM)
 		bool sendDataTo(const void* buf, std::size_t len, int flags);
 
+		/// Send @p count datagrams with as few sendmmsg calls as possible,
+		/// every iovec in @p iov is one datagram
+		bool sendMultipleDataTo(const struct iovec* iov, std::size_t count, int flags);
+
+		/// Send the data of @p iov as one buffer that the kernel splits into
+		/// datagrams of @p segmentSize (UDP GSO). On failure errno is kept
+		bool sendSegmentedDataTo(const struct iovec* iov, std::size_t count,
+				uint16_t segmentSize, int flags);
+
+		/// Check if this UDP Socket supports segmentation offload (UDP GSO)
+		bool isSegmentationOffloadSupported() const;
+
+		/// Enable MSG_ZEROCOPY sending on this Socket
+		bool enableZeroCopy();
+
+		/// Send @p iov with MSG_ZEROCOPY without waiting, the data should not be
+		/// changed until a completion for this send is read with @see readZeroCopyCompletion
+		/// @return the amount of bytes send or -1 on error (errno is kept)
+		ssize_t sendZeroCopy(const struct iovec* iov, int iovcnt);
+
+		/// Read one MSG_ZEROCOPY completion, first the ones taken out by
+		/// @see takeZeroCopyCompletions and then from the error queue, without waiting
+		/// @param lo specifies the first completed send
+		/// @param hi specifies the last completed send
+		/// @param copied is set when the kernel did copy the data anyway
+		/// @return true if a completion was read
+		bool readZeroCopyCompletion(uint32_t &lo, uint32_t &hi, bool &copied);
+
+		/// Take all MSG_ZEROCOPY completions out of the error queue and keep
+		/// them for @see readZeroCopyCompletion. The error queue raises POLLERR
+		/// for as long as it is not empty
+		void takeZeroCopyCompletions();
+
+		/// Abort the connection of this TCP Socket. This drops the data that is
+		/// still queued, so also the pages pinned by MSG_ZEROCOPY are released
+		void abortConnection();
+
 		/// Get the port of this Socket
 		int getSocketPort() const;
 
@@ -107,6 +151,11 @@ class SocketAttr {
 		/// Get the file descriptor of this Socket
 		int getFD() const;
 
+		/// Get the amount of send system calls done on this Socket
+		unsigned long getSendCalls() const noexcept {
+			return _sendCalls.load(std::memory_order_relaxed);
+		}
+
 		///
 		ssize_t recvDatafrom(void* buf, std::size_t len, int flags);
 
@@ -134,6 +183,11 @@ class SocketAttr {
 		///
 		void setKeepAlive();
 
+	private:
+
+		/// Receive one MSG_ZEROCOPY completion from the error queue
+		bool receiveZeroCopyCompletion(uint32_t &lo, uint32_t &hi, bool &copied);
+
 		// ===================================================================
 		//  -- Data members --------------------------------------------------
 		// ===================================================================
@@ -145,6 +199,16 @@ class SocketAttr {
 		struct sockaddr_in _addr;
 		std::string _ipAddr;
 		int _ttl;
+		std::atomic<unsigned long> _sendCalls;
+
+	private:
+
+		struct ZeroCopyCompletion {
+			uint32_t lo;
+			uint32_t hi;
+			bool copied;
+		};
+		std::vector<ZeroCopyCompletion> _zeroCopyCompletions;
 
 };
 
@@ -92,6 +92,18 @@ int TcpSocket::poll(int timeout) {
 					}
 				}
 			} else {
+				if (_pfd[i].revents == POLLERR) {
+					// With MSG_ZEROCOPY the completions also raise POLLERR, but
+					// that is no connection error. Take them out of the error
+					// queue else poll keeps waking up, the Stream writer reads
+					// them from the Socket later
+					int error = 0;
+					socklen_t len = sizeof(error);
+					if (::getsockopt(_pfd[i].fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+						_client[i - 1].takeZeroCopyCompletions();
+						continue;
+					}
+				}
 				// receive httpc messages
 				const auto dataSize = recvHttpcMessage(_client[i-1], MSG_DONTWAIT);
 				if (dataSize > 0) {